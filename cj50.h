@@ -49,7 +49,27 @@
 #include <cj50/instantiations/Vec_char.h>
 #include <cj50/instantiations/Result_Unit__String.h>
 #include <cj50/os_thread.h>
+#include <cj50/threadpool.h>
+#include <cj50/instantiations/parallel_Vec2_float.h>
+#include <cj50/instantiations/parallel_double.h>
 #include <cj50/gen/Mutex.h>
+#include <cj50/Condvar.h>
+#include <cj50/gen/RwLock.h>
+#include <cj50/gen/AdaptiveMutex.h>
+#include <cj50/gen/Atomic.h>
+#include <cj50/Counter.h>
+#include <cj50/gen/Channel.h>
+#include <cj50/hash.h>
+#include <cj50/gen/HashMap.h>
+#include <cj50/gen/HashSet.h>
+#include <cj50/Interner.h>
+#include <cj50/Arena.h>
+#include <cj50/gen/ArenaVec.h>
+#include <cj50/ArenaString.h>
+#include <cj50/instantiations/ArenaVec_Vec2_float.h>
+#include <cj50/gen/VecDeque.h>
+#include <cj50/gen/BinaryHeap.h>
+#include <cj50/gen/SmallVec.h>
 #include <cj50/instantiations/Vec_int.h>
 #include <cj50/instantiations/Vec_Vec2_int.h>
 #include <cj50/instantiations/Vec_Vec2_float.h>
@@ -58,6 +78,11 @@
 #include <cj50/instantiations/Vec_float.h>
 #include <cj50/instantiations/Vec2_u32.h>
 #include <cj50/instantiations/Vec3_u32.h>
+#include <cj50/instantiations/sort_int.h>
+#include <cj50/instantiations/sort_u32.h>
+#include <cj50/instantiations/sort_u64.h>
+#include <cj50/instantiations/sort_float.h>
+#include <cj50/instantiations/sort_double.h>
 
 
 // Read a CStr from `inp`, terminated by a newline (the newline is
@@ -338,7 +363,7 @@ void drop_strings_slice(cstr* ary, size_t len) {
     for (size_t i = 0; i < len; i++) {
         cstr s = ary[i];
         if (s) {
-            free((char*)s); /* todo: don't hack, don't use `cstr` */
+            xfree((char*)s); /* todo: don't hack, don't use `cstr` */
         }
     }
 }
@@ -346,7 +371,7 @@ void drop_strings_slice(cstr* ary, size_t len) {
 static UNUSED
 void drop_cstrs(cstr* ary, size_t len) {
     drop_strings_slice(ary, len); /* todo: stop doing that, borrowed */
-    free(ary);
+    xfree(ary);
 }
 
 static
@@ -359,7 +384,7 @@ void drop_Option_Strings_slice(Option(String)* ary, size_t len) {
 static UNUSED
 void drop_Option_Strings(Option(String)* ary, size_t len) {
     drop_Option_Strings_slice(ary, len);
-    free(ary);
+    xfree(ary);
 }
 
 
@@ -471,6 +496,9 @@ int print_debug_floats(const float* ary, size_t len) {
              , String*: print_String                    \
              , const String*: print_String              \
              , String: print_move_String                \
+             , strslice*: print_strslice                \
+             , const strslice*: print_strslice          \
+             , strslice: print_move_strslice            \
              , utf8char*: print_utf8char                \
              , const utf8char*: print_utf8char          \
              , utf8char: print_move_utf8char            \
@@ -768,6 +796,14 @@ GENERATE_PRINTLN(ucodepoint);
              , VecError: drop_VecError                           \
              , UnicodeError: drop_UnicodeError                   \
              , CFile: drop_CFile                                 \
+             , MappedFile: drop_MappedFile                       \
+             , ThreadPool: drop_ThreadPool                       \
+             , BufReader: drop_BufReader                         \
+             , Interner: drop_Interner                           \
+             , Arena: drop_Arena                                 \
+             , Counter: drop_Counter                             \
+             , Condvar: drop_Condvar                             \
+             , ArenaString: drop_ArenaString                     \
              , const char*: drop_cstr                            \
              , char*: drop_cstr                                  \
              , int*: free                                        \
@@ -818,7 +854,7 @@ GENERATE_PRINTLN(ucodepoint);
 #define RESIZE_ARRAY_free(ary, oldlen, newlen)          \
     if (newlen < oldlen) {                              \
         for (size_t i = newlen; i < oldlen; i++) {      \
-            if (ary[i]) { free((void*)ary[i]); } /* todo don't hack, don't use `cstr` */ \
+            if (ary[i]) { xfree((void*)ary[i]); } /* todo don't hack, don't use `cstr` */ \
         }                                               \
     }
 #define RESIZE_ARRAY_drop(ary, oldlen, newlen)          \
@@ -987,6 +1023,25 @@ float* resize_floats(float* ary, size_t oldlen, size_t newlen) {
              , const Vec(double)*: equal_Vec_double                         \
         )((a), (b))
 
+/// Returns a `u64` calculated from the value that `v` points to, the
+/// same for all `equal` values, as used by `HashMap` (see
+/// `cj50/hash.h`).
+#define hash(v)                                         \
+    _Generic((v)                                        \
+             , int*: hash_int                           \
+             , const int*: hash_int                     \
+             , u64*: hash_u64                           \
+             , const u64*: hash_u64                     \
+             , cstr*: hash_cstr                         \
+             , const cstr*: hash_cstr                   \
+             , strslice*: hash_strslice                 \
+             , const strslice*: hash_strslice           \
+             , String*: hash_String                     \
+             , const String*: hash_String               \
+             , Vec2(int)*: hash_Vec2_int                \
+             , const Vec2(int)*: hash_Vec2_int          \
+        )(v)
+
 /* /// Call `equal(&a, &b)` but works even if `a` or `b` are expressions */
 /* /// that are not variables or data structure slots. */
 /* #define EQUAL(a, b)                                             \ */
@@ -1069,6 +1124,7 @@ float* resize_floats(float* ary, size_t oldlen, size_t newlen) {
              , Result(Unit, UnicodeError): unwrap_Result_Unit__UnicodeError \
              , Result(ucodepoint, UnicodeError): unwrap_Result_ucodepoint__UnicodeError \
              , Result(size_t, UnicodeError): unwrap_Result_size_t__UnicodeError \
+             , Result(size_t, size_t): unwrap_Result_size_t__size_t \
              , Result(Vec(utf8char), UnicodeError): unwrap_Result_Vec_utf8char__UnicodeError \
              , Result(Vec(ucodepoint), UnicodeError): unwrap_Result_Vec_ucodepoint__UnicodeError \
              , Result(String, UnicodeError): unwrap_Result_String__UnicodeError \
@@ -1110,6 +1166,7 @@ float* resize_floats(float* ary, size_t oldlen, size_t newlen) {
              , Result(Unit, UnicodeError): unwrap_or_Result_Unit__UnicodeError \
              , Result(ucodepoint, UnicodeError): unwrap_or_Result_ucodepoint__UnicodeError \
              , Result(size_t, UnicodeError): unwrap_or_Result_size_t__UnicodeError \
+             , Result(size_t, size_t): unwrap_or_Result_size_t__size_t \
              , Result(Vec(utf8char), UnicodeError): unwrap_or_Result_Vec_utf8char__UnicodeError \
              , Result(Vec(ucodepoint), UnicodeError): unwrap_or_Result_Vec_ucodepoint__UnicodeError \
              , Result(String, UnicodeError): unwrap_or_Result_String__UnicodeError \
@@ -1128,11 +1185,13 @@ float* resize_floats(float* ary, size_t oldlen, size_t newlen) {
 #define deref(v)                                                        \
     _Generic((v)                                                        \
              , CStr*: deref_CStr                                        \
+             , MappedFile*: deref_MappedFile                            \
              , Vec(Vec2(int))*: deref_Vec_Vec2_int                  \
              , Vec(Vec3(int))*: deref_Vec_Vec3_int                  \
              , Vec(Vec2(float))*: deref_Vec_Vec2_float                  \
              , Vec(Rect2(float))*: deref_Vec_Rect2_float                  \
              , Vec(Vec2(double))*: deref_Vec_Vec2_double                  \
+             , Vec(double)*: deref_Vec_double                           \
         )(v)
 
 
@@ -1375,6 +1434,46 @@ cleanup:
         )(coll1, coll2)
 
 
+/// Append copies of the items in the slice `sl` onto the end of
+/// `coll`, with at most one reallocation. For Vec. The items are
+/// copied bitwise, see `extend_from_slice_Vec_int` for the caveat.
+#define extend_from_slice(coll, sl)                     \
+    _Generic((coll)                                     \
+             , Vec(cstr)*: extend_from_slice_Vec_cstr   \
+             , Vec(ucodepoint)*: extend_from_slice_Vec_ucodepoint \
+             , Vec(utf8char)*: extend_from_slice_Vec_utf8char \
+             , Vec(char)*: extend_from_slice_Vec_char   \
+             , Vec(int)*: extend_from_slice_Vec_int     \
+             , Vec(Vec2(int))*: extend_from_slice_Vec_Vec2_int \
+             , Vec(Vec3(int))*: extend_from_slice_Vec_Vec3_int \
+             , Vec(Vec2(float))*: extend_from_slice_Vec_Vec2_float \
+             , Vec(Rect2(float))*: extend_from_slice_Vec_Rect2_float \
+             , Vec(Vec2(double))*: extend_from_slice_Vec_Vec2_double \
+             , Vec(float)*: extend_from_slice_Vec_float \
+             , Vec(double)*: extend_from_slice_Vec_double \
+        )(coll, sl)
+
+/// Make sure that `coll` has capacity for at least `additional` more
+/// items than it currently holds, growing it geometrically if
+/// needed. For Vec.
+#define reserve(coll, additional)                       \
+    _Generic((coll)                                     \
+             , Vec(cstr)*: reserve_Vec_cstr             \
+             , Vec(CStr)*: reserve_Vec_CStr             \
+             , Vec(ucodepoint)*: reserve_Vec_ucodepoint \
+             , Vec(utf8char)*: reserve_Vec_utf8char     \
+             , Vec(char)*: reserve_Vec_char             \
+             , Vec(int)*: reserve_Vec_int               \
+             , Vec(Vec2(int))*: reserve_Vec_Vec2_int    \
+             , Vec(Vec3(int))*: reserve_Vec_Vec3_int    \
+             , Vec(Vec2(float))*: reserve_Vec_Vec2_float \
+             , Vec(Rect2(float))*: reserve_Vec_Rect2_float \
+             , Vec(Vec2(double))*: reserve_Vec_Vec2_double \
+             , Vec(float)*: reserve_Vec_float           \
+             , Vec(double)*: reserve_Vec_double         \
+        )(coll, additional)
+
+
 /// Give the length of a given collection. It always reports the
 /// number of identically-sized storage locations, which means that
 /// for String, it reports the number of bytes (C char), not the
@@ -1494,19 +1593,112 @@ cleanup:
              , String*: clear_String                            \
         )(s)
 
+/// Sort the items of the Vec (pass a pointer) or mutslice in
+/// ascending order. Equal items may end up in any order. See
+/// `cj50/gen/sort.h`.
+#define sort(coll)                                      \
+    _Generic((coll)                                     \
+             , Vec(int)*: sort_Vec_int                  \
+             , Vec(u32)*: sort_Vec_u32                  \
+             , Vec(u64)*: sort_Vec_u64                  \
+             , Vec(float)*: sort_Vec_float              \
+             , Vec(double)*: sort_Vec_double            \
+             , mutslice(int): sort_mutslice_int         \
+             , mutslice(u32): sort_mutslice_u32         \
+             , mutslice(u64): sort_mutslice_u64         \
+             , mutslice(float): sort_mutslice_float     \
+             , mutslice(double): sort_mutslice_double   \
+        )(coll)
+
+/// Like `sort`, but keeps equal items in their original order.
+#define sort_stable(coll)                                       \
+    _Generic((coll)                                             \
+             , Vec(int)*: sort_stable_Vec_int                   \
+             , Vec(u32)*: sort_stable_Vec_u32                   \
+             , Vec(u64)*: sort_stable_Vec_u64                   \
+             , Vec(float)*: sort_stable_Vec_float               \
+             , Vec(double)*: sort_stable_Vec_double             \
+             , mutslice(int): sort_stable_mutslice_int          \
+             , mutslice(u32): sort_stable_mutslice_u32          \
+             , mutslice(u64): sort_stable_mutslice_u64          \
+             , mutslice(float): sort_stable_mutslice_float      \
+             , mutslice(double): sort_stable_mutslice_double    \
+        )(coll)
+
+/// Search the sorted Vec (pass a pointer) or slice for the item `*x`:
+/// returns `Ok(index)` if found, `Err(index)` with the position where
+/// it could be inserted otherwise.
+#define binary_search(coll, x)                                  \
+    _Generic((coll)                                             \
+             , Vec(int)*: binary_search_Vec_int                 \
+             , const Vec(int)*: binary_search_Vec_int           \
+             , Vec(u32)*: binary_search_Vec_u32                 \
+             , const Vec(u32)*: binary_search_Vec_u32           \
+             , Vec(u64)*: binary_search_Vec_u64                 \
+             , const Vec(u64)*: binary_search_Vec_u64           \
+             , Vec(float)*: binary_search_Vec_float             \
+             , const Vec(float)*: binary_search_Vec_float       \
+             , Vec(double)*: binary_search_Vec_double           \
+             , const Vec(double)*: binary_search_Vec_double     \
+             , slice(int): binary_search_slice_int              \
+             , slice(u32): binary_search_slice_u32              \
+             , slice(u64): binary_search_slice_u64              \
+             , slice(float): binary_search_slice_float          \
+             , slice(double): binary_search_slice_double        \
+        )(coll, x)
+
+/// Call `f(&item, ctx)` for every item in the slice or mutslice
+/// `items`, in parallel on `pool`. See `cj50/gen/parallel.h`.
+
+#define parallel_for(pool, items, f, ctx)                               \
+    _Generic((items)                                                    \
+             , slice(Vec2(float)): parallel_for_slice_Vec2_float        \
+             , mutslice(Vec2(float)): parallel_for_mutslice_Vec2_float  \
+             , slice(double): parallel_for_slice_double                 \
+             , mutslice(double): parallel_for_mutslice_double           \
+        )((pool), (items), (f), (ctx))
+
+/// A new Vec with `f(&item, ctx)` for every item in the slice
+/// `items`, computed in parallel on `pool`. See `cj50/gen/parallel.h`.
+
+#define parallel_map(pool, items, f, ctx)                               \
+    _Generic((items)                                                    \
+             , slice(Vec2(float)): parallel_map_slice_Vec2_float        \
+             , slice(double): parallel_map_slice_double                 \
+        )((pool), (items), (f), (ctx))
+
+/// Combine all items in the slice `items` using `combine`, in
+/// parallel on `pool`. See `cj50/gen/parallel.h`.
+
+#define parallel_reduce(pool, items, init, combine, ctx)                \
+    _Generic((items)                                                    \
+             , slice(Vec2(float)): parallel_reduce_slice_Vec2_float     \
+             , slice(double): parallel_reduce_slice_double              \
+        )((pool), (items), (init), (combine), (ctx))
+
 /// Read items into buf until the delimiter or EOF is reached.
 
-#define read_until(in, delimiter, buf, strip_delimiter, max_len) \
-    _Generic((buf),                                              \
-             , Vec(ucodepoint)*: read_until_Vec_ucodepoint       \
+#define read_until(in, delimiter, buf, strip_delimiter, max_len)        \
+    _Generic((in)                                                       \
+             , CFile*: _Generic((buf)                                   \
+                                , Vec(ucodepoint)*: read_until_Vec_ucodepoint \
+                 )                                                      \
+             , BufReader*: _Generic((buf)                               \
+                                    , Vec(ucodepoint)*: read_until_Vec_ucodepoint_BufReader \
+                 )                                                      \
         )((in), (delimiter), (buf), (strip_delimiter), (max_len))
 
 /// Read items into buf until a newline character (`'\n'`) or EOF is
 /// reached.
 
-#define read_line(in, buf, strip_delimiter, max_len)             \
-    _Generic((buf),                                              \
-             , Vec(ucodepoint)*: read_line_Vec_ucodepoint        \
+#define read_line(in, buf, strip_delimiter, max_len)                    \
+    _Generic((in)                                                       \
+             , CFile*: _Generic((buf)                                   \
+                                , Vec(ucodepoint)*: read_line_Vec_ucodepoint \
+                 )                                                      \
+             , BufReader*: _Generic((buf)                               \
+                                    , Vec(ucodepoint)*: read_line_Vec_ucodepoint_BufReader \
+                 )                                                      \
         )((in), (buf), (strip_delimiter), (max_len))
 
 
@@ -1516,6 +1708,7 @@ cleanup:
     _Generic((in)                                                       \
              , CFile*: get_ucodepoint_unlocked_CFile                    \
              , SliceIterator(char)*: get_ucodepoint_unlocked_SliceIterator_char \
+             , BufReader*: get_ucodepoint_unlocked_BufReader            \
         )(in)
 
 /// Create a String from various types. (Ideally the same as
@@ -1786,6 +1979,10 @@ bool env_is_true(cstr varname) {
 /// `MAIN` defines the function `main` (hence `mainfunction` cannot be
 /// called `main`).
 
+/// `MAIN` also picks up the `CJ50_DEBUG` (see `Mutex`),
+/// `CJ50_SEED` (see `seed_random_from_env`) and `CJ50_XMEM_STATS`
+/// (see `cj50/xmem.h`) environment variables.
+
 /// ```C
 /// Result(Unit, UnicodeError) run(slice(cstr) argv) {
 ///     ...
@@ -1797,6 +1994,10 @@ bool env_is_true(cstr varname) {
 #define MAIN(mainfunction)                                              \
     int main(int argc, const char**argv) {                              \
         __CJ50_Mutex_debug = env_is_true("CJ50_DEBUG");                 \
+        if (env_is_true("CJ50_XMEM_STATS")) {                           \
+            enable_xmem_stats(true);                                    \
+        }                                                               \
+        seed_random_from_env("CJ50_SEED");                              \
         if_let_Ok(UNUSED _, (mainfunction)(new_slice_cstr(argv, argc))) { \
             return 0;                                                   \
         } else_Err(e) {                                                 \
@@ -0,0 +1,267 @@
+#pragma once
+
+//! An `Arena` is an allocator for many small pieces of memory that
+//! all have the same lifetime: allocating is just advancing an offset
+//! in a large chunk of memory (getting a new chunk when the current
+//! one is full), and instead of freeing the pieces individually,
+//! they are all freed at once, by dropping the arena, or by
+//! `reset_Arena`, which makes the memory available for reuse.
+
+//! This makes a lot of allocations very cheap, and is a good fit for
+//! data that is built up and thrown away regularly, e.g. temporary
+//! data needed to draw one frame of an animation: create an arena
+//! once, allocate from it while drawing a frame, and reset it at the
+//! start of the next frame. After the first few frames, the arena
+//! has enough memory to satisfy all allocations of a frame without
+//! calling `malloc` at all.
+
+//! Memory allocated from an arena must not be used after the arena
+//! is reset or dropped. The values stored in it are not dropped
+//! either, so it should only be used for values that don't own any
+//! resources (like numbers, or `Vec2(float)`s; not `String`s).
+
+//! `ArenaVec(T)` (see [`cj50/gen/ArenaVec.h`](gen/ArenaVec.h.md))
+//! and `ArenaString` (see [`cj50/ArenaString.h`](ArenaString.h.md))
+//! are vectors and strings that store their items in an arena.
+
+//! Example:
+
+/// ```C
+/// Arena arena = new_Arena();
+/// while (running) {
+///     reset_Arena(&arena);
+///     Vec2(float) *points = ARENA_ALLOC(&arena, Vec2(float), n);
+///     // ... fill and use `points`, no need to free it
+/// }
+/// drop(arena);
+/// ```
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <cj50/basic-util.h>
+#include <cj50/xmem.h>
+#include <cj50/resret.h>
+
+
+/// The default size of the chunks an `Arena` gets from `malloc`
+/// (larger allocations get a chunk of their own).
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+// A piece of memory allocated from; the chunks form a list, newest
+// first.
+typedef struct _ArenaChunk {
+    struct _ArenaChunk *prev;
+    size_t cap;
+    size_t used;
+    _Alignas(max_align_t) char data[];
+} _ArenaChunk;
+
+typedef struct Arena {
+    _ArenaChunk *chunk;
+    size_t chunk_size;
+    // The number of bytes allocated in earlier chunks, for
+    // statistics and for sizing the chunk after a reset
+    size_t used_before;
+    size_t cap_before;
+} Arena;
+
+
+/// Create a new, empty `Arena` (it does not allocate any memory until
+/// it is used).
+
+static UNUSED
+Arena new_Arena() {
+    return (Arena) {
+        .chunk = NULL,
+        .chunk_size = ARENA_CHUNK_SIZE,
+        .used_before = 0,
+        .cap_before = 0
+    };
+}
+
+/// Create a new, empty `Arena` that gets memory in chunks of
+/// `chunk_size` bytes. Useful if it's known how much memory will be
+/// needed.
+
+static UNUSED
+Arena with_chunk_size_Arena(size_t chunk_size) {
+    Arena self = new_Arena();
+    self.chunk_size = chunk_size ? chunk_size : 1;
+    return self;
+}
+
+// Free the given chunk list.
+static
+void _free_chunks_Arena(_ArenaChunk *chunk) {
+    while (chunk) {
+        _ArenaChunk *prev = chunk->prev;
+        xfree(chunk);
+        chunk = prev;
+    }
+}
+
+/// Free all memory of the arena.
+
+static UNUSED
+void drop_Arena(Arena self) {
+    _free_chunks_Arena(self.chunk);
+}
+
+/// The number of bytes handed out since the arena was created or last
+/// reset (including padding for alignment).
+
+static UNUSED
+size_t used_Arena(const Arena *self) {
+    return self->used_before + (self->chunk ? self->chunk->used : 0);
+}
+
+/// The number of bytes of memory the arena is holding.
+
+static UNUSED
+size_t capacity_Arena(const Arena *self) {
+    return self->cap_before + (self->chunk ? self->chunk->cap : 0);
+}
+
+// Get a new chunk with room for at least `size` bytes at alignment
+// `align`.
+static
+void _new_chunk_Arena(Arena *self, size_t size, size_t align) {
+    size_t cap = self->chunk_size;
+    if (size > SIZE_MAX - align) {
+        die_outofmemory();
+    }
+    if (cap < size + align) {
+        cap = size + align;
+    }
+    if (cap > SIZE_MAX - sizeof(_ArenaChunk)) {
+        die_outofmemory();
+    }
+    _ArenaChunk *chunk = xmalloc(sizeof(_ArenaChunk) + cap);
+    chunk->prev = self->chunk;
+    chunk->cap = cap;
+    chunk->used = 0;
+    if (self->chunk) {
+        self->used_before += self->chunk->used;
+        self->cap_before += self->chunk->cap;
+    }
+    self->chunk = chunk;
+}
+
+// The offset in `chunk->data` from where `size` bytes at alignment
+// `align` fit, or SIZE_MAX if they don't.
+static inline
+size_t _fit_ArenaChunk(const _ArenaChunk *chunk, size_t size, size_t align) {
+    uintptr_t base = (uintptr_t)chunk->data;
+    uintptr_t p = (base + chunk->used + align - 1) & ~(uintptr_t)(align - 1);
+    size_t start = p - base;
+    if ((start <= chunk->cap) && (chunk->cap - start >= size)) {
+        return start;
+    }
+    return SIZE_MAX;
+}
+
+/// Allocate `size` bytes at the given alignment (which must be a
+/// power of 2) from the arena. Never returns NULL (aborts if out of
+/// memory). The memory is not initialized.
+
+static UNUSED
+void *alloc_Arena(Arena *self, size_t size, size_t align) {
+    assert(align && !(align & (align - 1)));
+    size_t start = self->chunk
+        ? _fit_ArenaChunk(self->chunk, size, align)
+        : SIZE_MAX;
+    if (start == SIZE_MAX) {
+        _new_chunk_Arena(self, size, align);
+        start = _fit_ArenaChunk(self->chunk, size, align);
+        assert(start != SIZE_MAX);
+    }
+    self->chunk->used = start + size;
+    return &self->chunk->data[start];
+}
+
+/// Allocate room for `nmemb` items of `size` bytes each at the given
+/// alignment, see `alloc_Arena`.
+
+static UNUSED
+void *alloc_array_Arena(Arena *self, size_t nmemb, size_t size,
+                        size_t align) {
+    size_t bytes = nmemb * size;
+    if (size && (bytes / size != nmemb)) {
+        die_outofmemory();
+    }
+    return alloc_Arena(self, bytes, align);
+}
+
+/// Allocate room for `n` items of type `T` from the arena, returning
+/// a `T*`.
+
+#define ARENA_ALLOC(arena, T, n)                                \
+    ((T*)alloc_array_Arena((arena), (n), sizeof(T), _Alignof(T)))
+
+/// Change the size of the allocation at `ptr`, which has `old_size`
+/// bytes and was allocated from the arena with the given alignment,
+/// to `new_size` bytes. If it was the most recent allocation and
+/// there is room, it is grown in place, otherwise the contents are
+/// copied to a new allocation (the old memory is not reused until
+/// the arena is reset). `ptr` may be NULL if `old_size` is 0.
+
+static UNUSED
+void *realloc_Arena(Arena *self, void *ptr, size_t old_size,
+                    size_t new_size, size_t align) {
+    _ArenaChunk *chunk = self->chunk;
+    if (ptr && chunk) {
+        uintptr_t base = (uintptr_t)chunk->data;
+        uintptr_t p = (uintptr_t)ptr;
+        // The most recent allocation in the current chunk?
+        if ((p >= base) && (p - base + old_size == chunk->used)) {
+            size_t start = p - base;
+            if (chunk->cap - start >= new_size) {
+                chunk->used = start + new_size;
+                return ptr;
+            }
+        }
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+    void *p = alloc_Arena(self, new_size, align);
+    if (old_size) {
+        memcpy(p, ptr, old_size);
+    }
+    return p;
+}
+
+/// Make all memory of the arena available for reuse, invalidating
+/// all previous allocations from it. If the arena had to get more
+/// than one chunk since the last reset, those are replaced with a
+/// single chunk large enough for all of them, so that from then on
+/// resetting costs O(1) and allocating doesn't need `malloc`.
+
+static UNUSED
+void reset_Arena(Arena *self) {
+    _ArenaChunk *chunk = self->chunk;
+    if (!chunk) {
+        return;
+    }
+    if (chunk->prev) {
+        size_t cap = self->cap_before + chunk->cap;
+        _free_chunks_Arena(chunk);
+        self->chunk = NULL;
+        self->cap_before = 0;
+        _new_chunk_Arena(self, cap, 1);
+    } else {
+        chunk->used = 0;
+    }
+    self->used_before = 0;
+}
+
+static UNUSED
+int print_debug_Arena(const Arena *self) {
+    INIT_RESRET;
+    RESRET(printf("Arena(used %zu of %zu bytes)",
+                  used_Arena(self), capacity_Arena(self)));
+cleanup:
+    return ret;
+}
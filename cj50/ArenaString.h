@@ -0,0 +1,149 @@
+#pragma once
+
+//! `ArenaString` is like `String`, but stores its text in an
+//! [`Arena`](Arena.h.md), which makes it cheap to build up temporary
+//! text (e.g. labels drawn in every frame) and throw it away again by
+//! resetting the arena.
+
+//! Example:
+
+/// ```C
+/// Arena arena = new_Arena();
+/// ArenaString s = new_ArenaString(&arena);
+/// push_fmt_ArenaString(&s, "%i fps", fps);
+/// print_ArenaString(&s);
+/// reset_Arena(&arena); // `s` is gone now
+/// ```
+
+#include <stdarg.h>
+#include <cj50/Arena.h>
+#include <cj50/String.h>
+#include <cj50/instantiations/ArenaVec_char.h>
+
+
+/// An `ArenaVec(char)` that holds text in UTF-8 encoding.
+
+typedef struct ArenaString {
+    ArenaVec(char) vec;
+} ArenaString;
+
+
+/// Create a new empty string storing its text in `arena`, which must
+/// live longer than the string.
+
+static UNUSED
+ArenaString new_ArenaString(Arena *arena) {
+    return (ArenaString) { .vec = new_ArenaVec_char(arena) };
+}
+
+/// Create a new empty string with room for `capacity` bytes, see
+/// `new_ArenaString`.
+
+static UNUSED
+ArenaString with_capacity_ArenaString(Arena *arena, size_t capacity) {
+    return (ArenaString) {
+        .vec = with_capacity_ArenaVec_char(arena, capacity)
+    };
+}
+
+/// Does nothing, the text belongs to the arena.
+
+static UNUSED
+void drop_ArenaString(UNUSED ArenaString self) {}
+
+/// The length in *bytes*, not characters.
+
+static UNUSED
+size_t len_ArenaString(const ArenaString *self) {
+    return self->vec.len;
+}
+
+/// Get the string slice of the whole string.
+
+static UNUSED
+strslice deref_ArenaString(const ArenaString *self) {
+    return new_strslice(self->vec.ptr, self->vec.len);
+}
+
+/// Clear the string, keeping its capacity.
+
+static UNUSED
+void clear_ArenaString(ArenaString *self) {
+    clear_ArenaVec_char(&self->vec);
+}
+
+/// Appends the given char to the end of the string.
+
+static UNUSED
+void push_ArenaString(ArenaString *self, char c) {
+    push_ArenaVec_char(&self->vec, c);
+}
+
+/// Appends a copy of the text `s` to the end of the string.
+
+static UNUSED
+void push_str_ArenaString(ArenaString *self, strslice s) {
+    extend_from_slice_ArenaVec_char(&self->vec, s.slice);
+}
+
+/// Appends text formatted like with `printf` to the end of the
+/// string.
+
+static UNUSED
+__attribute__ ((format (printf, 2, 3)))
+void push_fmt_ArenaString(ArenaString *self, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    va_list ap2;
+    va_copy(ap2, ap);
+    int n = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        DIE_("push_fmt_ArenaString: invalid format string '%s'", fmt);
+    }
+    // Room for the '\0' that vsnprintf writes, which is then dropped
+    // from the length again
+    reserve_ArenaVec_char(&self->vec, n + 1);
+    vsnprintf(&self->vec.ptr[self->vec.len], n + 1, fmt, ap2);
+    va_end(ap2);
+    self->vec.len += n;
+}
+
+/// Get the string as a C string, if possible--it's only possible if
+/// there are no embedded `'\0'` characters. The returned `cstr` is
+/// borrowed and shares storage with the string, so the string may
+/// not be mutated while the `cstr` is in use.
+
+static UNUSED
+Option(cstr) cstr_ArenaString(ArenaString *self) {
+    size_t len = self->vec.len;
+    if (len && memchr(self->vec.ptr, 0, len)) {
+        return none_cstr();
+    }
+    reserve_ArenaVec_char(&self->vec, 1);
+    self->vec.ptr[len] = '\0';
+    return some_cstr(self->vec.ptr);
+}
+
+/// Copy the text into a new `String`, which, unlike the
+/// `ArenaString`, can live on after the arena is reset.
+
+static UNUSED
+String to_String_ArenaString(const ArenaString *self) {
+    return new_String_from_strslice(deref_ArenaString(self));
+}
+
+static UNUSED
+bool equal_ArenaString(const ArenaString *a, const ArenaString *b) {
+    return equal_ArenaVec_char(&a->vec, &b->vec);
+}
+
+static UNUSED
+int print_ArenaString(const ArenaString *self) {
+    return print_move_strslice(deref_ArenaString(self));
+}
+
+static UNUSED
+int print_debug_ArenaString(const ArenaString *self) {
+    return print_debug_move_strslice(deref_ArenaString(self));
+}
@@ -130,7 +130,7 @@ CStr cStr_from_cstr_unsafe(char *v) {
 /// Remove from existence.
 static UNUSED
 void drop_CStr(CStr s) {
-    free(s.cstr);
+    xfree(s.cstr);
 }
 
 /// Check equivalence.
@@ -0,0 +1,125 @@
+#pragma once
+
+//! A `Condvar` ("condition variable") lets threads sleep until
+//! another thread changes data protected by a `Mutex` and tells them
+//! about it via `notify_one_Condvar` or `notify_all_Condvar`,
+//! instead of repeatedly locking the mutex to check (which wastes CPU
+//! time when checking often, and makes the thread react late when
+//! checking rarely).
+
+//! Waiting is done with `wait_Condvar_MutexGuard_T` (generated for
+//! every `Mutex(T)`): it unlocks the mutex while sleeping, and locks
+//! it again before returning. Threads can wake up without having
+//! been notified, thus always check the condition in a loop (or use
+//! `wait_while_Condvar_MutexGuard_T`):
+
+/// ```C
+/// MutexGuard(Jobs) g = lock_Mutex_Jobs(&jobs);
+/// while (deref_MutexGuard_Jobs(&g)->len == 0) {
+///     g = wait_Condvar_MutexGuard_Jobs(&jobs_available, g);
+/// }
+/// // take a job
+/// drop_MutexGuard_Jobs(g);
+/// ```
+
+//! The thread changing the data notifies after making the change:
+
+/// ```C
+/// MutexGuard(Jobs) g = lock_Mutex_Jobs(&jobs);
+/// // add a job
+/// drop_MutexGuard_Jobs(g);
+/// notify_one_Condvar(&jobs_available);
+/// ```
+
+//! A `Condvar` should always be used with the same `Mutex`. If the
+//! mutex was instantiated with `MUTEX_RECURSIVE`, it must be locked
+//! only once by the waiting thread, as waiting only releases one
+//! level of locking.
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <cj50/basic-util.h>
+
+
+typedef struct Condvar {
+    pthread_cond_t __private_sys_cond;
+} Condvar;
+
+/// Create a new condition variable. It must not be moved once
+/// threads are using it.
+
+static UNUSED
+Condvar new_Condvar() {
+    Condvar self;
+    pthread_condattr_t att;
+    pthread_condattr_init(&att);
+    // Timeouts should not be affected by changes of the wall clock
+    pthread_condattr_setclock(&att, CLOCK_MONOTONIC);
+    int err = pthread_cond_init(&self.__private_sys_cond, &att);
+    if (err) {
+        DIE_("pthread_cond_init: %s", strerror(err));
+    }
+    pthread_condattr_destroy(&att);
+    return self;
+}
+
+static UNUSED
+void drop_Condvar(Condvar self) {
+    pthread_cond_destroy(&self.__private_sys_cond);
+}
+
+/// Wake up one of the threads waiting on the condition variable (if
+/// there are any).
+
+static UNUSED
+void notify_one_Condvar(Condvar *self) {
+    pthread_cond_signal(&self->__private_sys_cond);
+}
+
+/// Wake up all threads waiting on the condition variable.
+
+static UNUSED
+void notify_all_Condvar(Condvar *self) {
+    pthread_cond_broadcast(&self->__private_sys_cond);
+}
+
+// Wait on `self`, with `mutex` locked by the caller.
+static UNUSED
+void _wait_Condvar(Condvar *self, pthread_mutex_t *mutex) {
+    int err = pthread_cond_wait(&self->__private_sys_cond, mutex);
+    if (err) {
+        DIE_("pthread_cond_wait: %s", strerror(err));
+    }
+}
+
+// The point in time (on CLOCK_MONOTONIC) `timeout` from now.
+static UNUSED
+struct timespec _deadline_Condvar(struct timespec timeout) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_sec += timeout.tv_sec + timeout.tv_nsec / 1000000000;
+    t.tv_nsec += timeout.tv_nsec % 1000000000;
+    if (t.tv_nsec >= 1000000000) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000;
+    }
+    return t;
+}
+
+// Wait on `self`, with `mutex` locked by the caller, until at most
+// `deadline`. Returns false if the deadline passed.
+static UNUSED
+bool _wait_until_Condvar(Condvar *self, pthread_mutex_t *mutex,
+                         const struct timespec *deadline) {
+    int err = pthread_cond_timedwait(&self->__private_sys_cond, mutex,
+                                     deadline);
+    if (err == ETIMEDOUT) {
+        return false;
+    }
+    if (err) {
+        DIE_("pthread_cond_timedwait: %s", strerror(err));
+    }
+    return true;
+}
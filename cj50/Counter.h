@@ -0,0 +1,104 @@
+#pragma once
+
+//! A `Counter` is a number that many threads increase at the same
+//! time, e.g. to count events for statistics. A single `Atomic(u64)`
+//! would do, but when threads on different CPU cores update it
+//! often, the cores have to pass the memory holding it back and
+//! forth between them, which is slow. A `Counter` instead keeps
+//! several atomic numbers ("shards"), each in its own cache line;
+//! each thread only adds to one of them, and `get_Counter` sums them
+//! all up. This makes adding fast, in exchange for reading being
+//! slower, thus it fits values that are updated more often than read.
+
+//! Example:
+
+/// ```C
+/// Counter requests = new_Counter();
+/// // in any thread:
+/// add_Counter(&requests, 1);
+/// // anywhere:
+/// printf("%lu\n", get_Counter(&requests));
+/// ```
+
+#include <cj50/basic-util.h>
+#include <cj50/resret.h>
+#include <cj50/instantiations/Atomic_u64.h>
+#include <cj50/instantiations/Atomic_size_t.h>
+
+
+/// The number of shards in a `Counter`; threads are assigned to them
+/// in turn.
+
+#define COUNTER_SHARDS 16
+
+// Padded so that no two shards' values can be in the same cache line
+// (aligning them would change how a `Counter` is passed by value)
+typedef struct _CounterShard {
+    Atomic(u64) value;
+    char _pad[CACHE_LINE_SIZE - sizeof(Atomic(u64))];
+} _CounterShard;
+
+typedef struct Counter {
+    _CounterShard shards[COUNTER_SHARDS];
+} Counter;
+
+// The shard index + 1 of the current thread, 0 if not assigned yet.
+static __thread size_t _counter_shard = 0;
+static Atomic(size_t) _counter_next_shard;
+
+
+/// Create a new counter, at 0.
+
+static UNUSED
+Counter new_Counter() {
+    Counter self;
+    for (size_t i = 0; i < COUNTER_SHARDS; i++) {
+        self.shards[i].value = new_Atomic_u64(0);
+    }
+    return self;
+}
+
+static UNUSED
+void drop_Counter(UNUSED Counter self) {}
+
+// The shard that the current thread adds to.
+static inline
+size_t _shard_Counter() {
+    size_t s = _counter_shard;
+    if (s == 0) {
+        s = fetch_add_Atomic_size_t(&_counter_next_shard, 1,
+                                    memory_order_relaxed)
+            % COUNTER_SHARDS + 1;
+        _counter_shard = s;
+    }
+    return s - 1;
+}
+
+/// Add `n` to the counter.
+
+static UNUSED
+void add_Counter(Counter *self, u64 n) {
+    fetch_add_Atomic_u64(&self->shards[_shard_Counter()].value, n,
+                         memory_order_relaxed);
+}
+
+/// Get the current total. Additions happening at the same time may or
+/// may not be included (once all threads that add have been joined,
+/// it's exact).
+
+static UNUSED
+u64 get_Counter(const Counter *self) {
+    u64 sum = 0;
+    for (size_t i = 0; i < COUNTER_SHARDS; i++) {
+        sum += load_Atomic_u64(&self->shards[i].value, memory_order_relaxed);
+    }
+    return sum;
+}
+
+static UNUSED
+int print_debug_Counter(const Counter *self) {
+    INIT_RESRET;
+    RESRET(printf("Counter(%lu)", get_Counter(self)));
+cleanup:
+    return ret;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+//! An `Interner` gives each distinct string that it is handed a small
+//! number, its "symbol": the same text always gets the same number,
+//! and the text can be retrieved from the number. Storing and
+//! comparing symbols instead of `String`s saves memory and time when
+//! the same strings (e.g. words of a text) occur many times.
+
+//! The text of the strings is copied into an `Arena` owned by the
+//! `Interner` (not one allocation per string), which never moves it,
+//! so the `strslice`s that `resolve_Interner` returns stay valid as
+//! long as the `Interner` exists. Looking up a string
+//! that was interned before does not allocate.
+
+//! Example:
+
+/// ```C
+/// Interner in = new_Interner();
+/// u32 a = intern_Interner(&in, new_strslice("hello", 5));
+/// u32 b = intern_Interner(&in, new_strslice("world", 5));
+/// assert(intern_Interner(&in, new_strslice("hello", 5)) == a);
+/// assert(a != b);
+/// strslice s = resolve_Interner(&in, b);
+/// print_strslice(&s); // world
+/// drop(in);
+/// ```
+
+#include <cj50/basic-util.h>
+#include <cj50/xmem.h>
+#include <cj50/u32.h>
+#include <cj50/String.h>
+#include <cj50/hash.h>
+#include <cj50/Arena.h>
+#include <cj50/gen/Vec.h>
+#include <cj50/gen/HashMap.h>
+
+
+// The text of an interned string. (`strslice` can't be used as the
+// item of a `Vec` or key of a `HashMap`, as its length is read-only.)
+typedef struct _InternedText {
+    const char *ptr;
+    size_t len;
+} _InternedText;
+
+static UNUSED
+void drop__InternedText(UNUSED _InternedText self) {}
+
+static UNUSED
+bool equal__InternedText(const _InternedText *a, const _InternedText *b) {
+    // (ptr may be NULL if len is 0)
+    return (a->len == b->len) &&
+        ((a->len == 0) || (memcmp(a->ptr, b->ptr, a->len) == 0));
+}
+
+static UNUSED
+u64 hash__InternedText(const _InternedText *self) {
+    return hash_bytes(self->ptr, self->len);
+}
+
+static UNUSED
+int print_debug__InternedText(const _InternedText *self) {
+    return print_debug_move_strslice(new_strslice(self->ptr, self->len));
+}
+
+GENERATE_Option(_InternedText);
+GENERATE_ref(_InternedText);
+GENERATE_Option(ref(_InternedText));
+
+#define T _InternedText
+#include <cj50/gen/template/Vec.h>
+#undef T
+
+#define K _InternedText
+#define V u32
+#include <cj50/gen/template/HashMap.h>
+#undef V
+#undef K
+
+
+/// The size of the chunks that the text of interned strings is
+/// stored in (longer strings get a chunk of their own).
+
+#define INTERNER_CHUNK_SIZE (64 * 1024)
+
+typedef struct Interner {
+    // The keys point into `arena`
+    HashMap(_InternedText, u32) symbols;
+    // Indexed by symbol
+    Vec(_InternedText) texts;
+    Arena arena;
+} Interner;
+
+
+/// Create a new, empty `Interner`.
+
+static UNUSED
+Interner new_Interner() {
+    return (Interner) {
+        .symbols = new_HashMap__InternedText__u32(),
+        .texts = new_Vec__InternedText(),
+        .arena = with_chunk_size_Arena(INTERNER_CHUNK_SIZE)
+    };
+}
+
+static UNUSED
+void drop_Interner(Interner self) {
+    drop_HashMap__InternedText__u32(self.symbols);
+    drop_Vec__InternedText(self.texts);
+    drop_Arena(self.arena);
+}
+
+/// The number of distinct strings interned so far. The symbols
+/// handed out are `0` up to this number (exclusive).
+
+static UNUSED
+size_t len_Interner(const Interner *self) {
+    return self->texts.len;
+}
+
+// Copy `s` into the arena.
+static
+_InternedText _store_Interner(Interner *self, strslice s) {
+    size_t len = s.slice.len;
+    char *ptr = alloc_Arena(&self->arena, len, 1);
+    if (len) {
+        memcpy(ptr, s.slice.ptr, len);
+    }
+    return (_InternedText) { .ptr = ptr, .len = len };
+}
+
+/// Get the symbol for the text `s`, which is borrowed. If the same
+/// text was interned before, returns the same symbol as back then,
+/// otherwise a copy of the text is stored under the next unused
+/// symbol.
+
+static UNUSED
+u32 intern_Interner(Interner *self, strslice s) {
+    _InternedText text = { .ptr = s.slice.ptr, .len = s.slice.len };
+    if_let_Some(sym, get_HashMap__InternedText__u32(&self->symbols, &text)) {
+        return *sym;
+    } else_None {}
+    size_t n = self->texts.len;
+    if (n > UINT32_MAX) {
+        DIE("Interner: too many strings");
+    }
+    u32 sym = n;
+    _InternedText stored = _store_Interner(self, s);
+    push_Vec__InternedText(&self->texts, stored);
+    drop_Option_u32(insert_HashMap__InternedText__u32(&self->symbols, stored, sym));
+    return sym;
+}
+
+/// Get the symbol for the text `s` if it was interned before, without
+/// interning it otherwise.
+
+static UNUSED
+Option(u32) get_Interner(const Interner *self, strslice s) {
+    _InternedText text = { .ptr = s.slice.ptr, .len = s.slice.len };
+    if_let_Some(sym, get_HashMap__InternedText__u32(&self->symbols, &text)) {
+        return some_u32(*sym);
+    } else_None {
+        return none_u32();
+    }
+}
+
+/// Get the text for the symbol `sym`, which must have been returned
+/// by `intern_Interner` on the same `Interner`. The result is valid
+/// as long as the `Interner` exists.
+
+static UNUSED
+strslice resolve_Interner(const Interner *self, u32 sym) {
+    const _InternedText *text = at_Vec__InternedText(&self->texts, sym);
+    return new_strslice(text->ptr, text->len);
+}
+
+static UNUSED
+bool equal_Interner(const Interner *a, const Interner *b) {
+    return equal_Vec__InternedText(&a->texts, &b->texts);
+}
+
+static UNUSED
+int print_debug_Interner(const Interner *self) {
+    INIT_RESRET;
+    RESRET(print_move_cstr("Interner("));
+    RESRET(print_debug_Vec__InternedText(&self->texts));
+    RESRET(print_move_cstr(")"));
+cleanup:
+    return ret;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <limits.h>
 #include <cj50/gen/Option.h>
+#include <cj50/xmem.h>
 #include <cj50/CStr.h>
 #include <cj50/char.h>
 #include <cj50/instantiations/Vec_char.h>
@@ -17,13 +19,59 @@ GENERATE_Option(slice(char));
 /// characters. It automatically resizes itself as needed to accept
 /// additional text that is added.
 
-/// It is implemented as a wrapper around `Vec(char)`. It adds the
-/// guarantee that the contents are in correct UTF-8 encoding.
+/// It holds the same guarantee as `strslice` (see below) that the
+/// contents are in correct UTF-8 encoding.
+
+/// Strings of up to `STRING_INLINE_CAP` bytes are stored inside the
+/// `String` value itself, so creating them does not allocate memory;
+/// longer strings are stored in memory from `xmalloc`. Never access
+/// the fields directly, use the functions instead (e.g. `deref_String`
+/// to get the contents).
+
+/// This means that a `strslice` or `cstr` borrowed from a short
+/// `String` points into the `String` value itself: it becomes invalid
+/// not only when the `String` is mutated or dropped, but also when the
+/// `String` is moved, e.g. passed by value, pushed onto a
+/// `Vec(String)`, or moved around when such a `Vec` or a `HashMap`
+/// grows. Borrow from the `String` at its final place, or copy the
+/// text.
+
+#define STRING_INLINE_CAP 22
+
+// The tag in the last byte of a String, which for strings stored
+// inline holds their length, and for spilled ones is
+// _STRING_SPILLED.
+#define _STRING_SPILLED 0xFF
+
+// The representation of strings that have spilled to the heap. The
+// bit-fields place `tag` in the last byte on both little and big
+// endian machines (GCC allocates bit-fields starting from the least
+// significant bits on the former and from the most significant bits
+// on the latter).
+typedef struct _StringHeap {
+    char *ptr;
+    size_t len;
+    size_t cap : sizeof(size_t) * CHAR_BIT - 8;
+    size_t tag : 8;
+} _StringHeap;
+
+// The representation of short strings; one more byte than
+// `STRING_INLINE_CAP` so that `cstr_String` can append a '\0'.
+typedef struct _StringInline {
+    char bytes[STRING_INLINE_CAP + 1];
+    unsigned char len;
+} _StringInline;
 
 typedef struct String {
-    Vec(char) vec;
+    union {
+        _StringHeap heap;
+        _StringInline inline_;
+    } repr;
 } String;
 
+_Static_assert(sizeof(_StringInline) == sizeof(_StringHeap),
+               "String representations must have the same size");
+
 /// `strslice` is a borrowed, immutable type that, just like `String`,
 /// holds a string of characters, more precisely, an array of bytes,
 /// that represents a text in UTF-8 encoding.
@@ -41,19 +89,51 @@ typedef struct strslice {
      })
 
 
+// Whether the text is stored in memory from the heap.
+static inline
+bool _is_spilled_String(const String *s) {
+    return s->repr.inline_.len == _STRING_SPILLED;
+}
+
+static inline
+char *_ptr_String(String *s) {
+    return _is_spilled_String(s) ? s->repr.heap.ptr : s->repr.inline_.bytes;
+}
+
+static inline
+const char *_const_ptr_String(const String *s) {
+    return _is_spilled_String(s) ? s->repr.heap.ptr : s->repr.inline_.bytes;
+}
+
+// Must be at most the capacity.
+static inline
+void _set_len_String(String *s, size_t len) {
+    if (_is_spilled_String(s)) {
+        s->repr.heap.len = len;
+    } else {
+        s->repr.inline_.len = len;
+    }
+}
+
 static UNUSED
 void drop_String(String s) {
-    drop_Vec_char(s.vec);
+    if (_is_spilled_String(&s)) {
+        xfree(s.repr.heap.ptr);
+    }
 }
 
 static UNUSED
 void drop_strslice(UNUSED strslice s) {}
 
 
-/// Get the string slice of the whole String.
+/// Get the string slice of the whole String. The slice is only valid
+/// as long as `s` is neither mutated nor moved (short strings are
+/// stored inside the `String` value, see above).
 static UNUSED
 strslice deref_String(const String *s) {
-    return new_strslice(s->vec.ptr, s->vec.len);
+    return _is_spilled_String(s)
+        ? new_strslice(s->repr.heap.ptr, s->repr.heap.len)
+        : new_strslice(s->repr.inline_.bytes, s->repr.inline_.len);
 }
 
 
@@ -64,12 +144,14 @@ strslice deref_String(const String *s) {
 
 static UNUSED
 void clear_String(String *s) {
-    clear_Vec_char(&s->vec);
+    _set_len_String(s, 0);
 }
 
 static UNUSED
 bool equal_String(const String *a, const String *b) {
-    return equal_Vec_char(&a->vec, &b->vec);
+    strslice sa = deref_String(a);
+    strslice sb = deref_String(b);
+    return equal_slice_char(&sa.slice, &sb.slice);
 }
 
 static UNUSED
@@ -160,21 +242,60 @@ int print_debug_move_String(String s) {
 }
 
 
-/// Create a new empty String.
+/// Create a new empty String (does not allocate).
 
 static UNUSED
 String new_String() {
     return (String) {
-        .vec = new_Vec_char()       
+        .repr.inline_ = { .len = 0 }
     };
 }
 
+/// The number of bytes the String can hold without allocating (more)
+/// memory.
+
+static UNUSED
+size_t capacity_String(const String *s) {
+    return _is_spilled_String(s) ? s->repr.heap.cap : STRING_INLINE_CAP;
+}
+
+/// Make sure that there is room for at least `additional` more bytes
+/// in the String.
+
+static UNUSED
+void reserve_String(String *s, size_t additional) {
+    strslice old = deref_String(s);
+    size_t len = old.slice.len;
+    size_t cap = capacity_String(s);
+    if (cap - len >= additional) {
+        return;
+    }
+    // (The limit of the `cap` bit-field is far beyond what malloc can
+    // give.)
+    if (additional > (SIZE_MAX >> 9) - len) {
+        die_outofmemory();
+    }
+    size_t newcap = MAX(cap * 2, len + additional);
+    if (_is_spilled_String(s)) {
+        s->repr.heap.ptr = xreallocarray(s->repr.heap.ptr, newcap, 1);
+    } else {
+        char *ptr = xmalloc(newcap);
+        memcpy(ptr, old.slice.ptr, len);
+        s->repr.heap = (_StringHeap) {
+            .ptr = ptr,
+            .len = len,
+            .tag = _STRING_SPILLED
+        };
+    }
+    s->repr.heap.cap = newcap;
+}
+
 /// Create a String with the given `capacity` (but 0 current length).
 static UNUSED
 String with_capacity_String(size_t capacity) {
-    return (String) {
-        .vec = with_capacity_Vec_char(capacity)
-    };
+    String s = new_String();
+    reserve_String(&s, capacity);
+    return s;
 }
 
 /// The length in *bytes*, not characters. This operation is fast (has
@@ -190,14 +311,32 @@ size_t len_strslice(const strslice *s) {
 
 static UNUSED
 size_t len_String(const String *s) {
-    return s->vec.len;
+    return _is_spilled_String(s) ? s->repr.heap.len : s->repr.inline_.len;
 }
 
 
 /// Appends the given char to the end of this String.
 static UNUSED
 void push_String(String *s, char c) {
-    push_Vec_char(&s->vec, c);
+    size_t len = len_String(s);
+    if (len == capacity_String(s)) {
+        reserve_String(s, 1);
+    }
+    _ptr_String(s)[len] = c;
+    _set_len_String(s, len + 1);
+}
+
+/// Appends a copy of the text `str` to the end of this String.
+static UNUSED
+void push_str_String(String *s, strslice str) {
+    size_t n = str.slice.len;
+    if (n == 0) {
+        return;
+    }
+    reserve_String(s, n);
+    size_t len = len_String(s);
+    memcpy(&_ptr_String(s)[len], str.slice.ptr, n);
+    _set_len_String(s, len + n);
 }
 
 
@@ -205,14 +344,15 @@ void push_String(String *s, char c) {
 /// `b`.
 static UNUSED
 void append_String_String(String *a, String *b) {
-    append_Vec_char(&a->vec, &b->vec);
+    push_str_String(a, deref_String(b));
+    clear_String(b);
 }
 
 /// Appends the given String `b` to the end of String `a`, consuming
 /// `b`.
 static UNUSED
 void append_move_String_String(String *a, String b) {
-    append_Vec_char(&a->vec, &b.vec);
+    push_str_String(a, deref_String(&b));
     drop_String(b);
 }
 
@@ -225,20 +365,23 @@ void append_move_String_String(String *a, String b) {
 /// are no embedded `'\0'` characters.
 
 /// The returned `cstr` is borrowed and shares storage with `s`, so
-/// `s` may not be mutated while the `cstr` is in use.
+/// `s` may not be mutated, moved or dropped while the `cstr` is in
+/// use. (For short strings, the storage is the `String` value itself,
+/// thus e.g. pushing `s` onto a `Vec(String)` invalidates the
+/// `cstr`.)
 static UNUSED
 Option(cstr) cstr_String(String *s) {
-    size_t cap = s->vec.cap;
-    size_t len = s->vec.len;
+    size_t len = len_String(s);
     // Do we have embedded `'\0'`s?
-    if (memchr(s->vec.ptr, 0, len)) {
+    if (memchr(_ptr_String(s), 0, len)) {
         return none_cstr();
     }
-    // Make sure we have a `'\0'` terminator
-    if (!(cap > len)) {
-        reserve_Vec_char(&s->vec, len);
+    // Make sure we have a `'\0'` terminator (inline strings always
+    // have room for it)
+    if (_is_spilled_String(s) && !(s->repr.heap.cap > len)) {
+        reserve_String(s, 1);
     }
-    char *ptr = s->vec.ptr; // get fresh, after reserve_Vec_char!
+    char *ptr = _ptr_String(s); // get fresh, after reserve_String!
     ptr[len] = '\0';
     return some_cstr(ptr);
 }
@@ -255,12 +398,23 @@ GENERATE_Option(strslice);
 
 static UNUSED
 strslice unsafe_slice_of_String(const String *s, Range range) {
+    strslice all = deref_String(s);
     return (strslice) {
-        .slice = slice_of_Vec_char(&s->vec, range)
+        .slice = slice_of_slice_char(&all.slice, range)
     };
 }
 
 
+/// Create a String holding a copy of the text `str`.
+
+static UNUSED
+String new_String_from_strslice(strslice str) {
+    String s = new_String();
+    push_str_String(&s, str);
+    return s;
+}
+
+
 #define T int
 #define FORMATSTRING "%i"
 #include <cj50/gen/template/new_String_from.h>
@@ -281,4 +435,6 @@ String new_String_from_String(String s) {
 }
 
 GENERATE_Option(String);
+GENERATE_ref(String);
+GENERATE_Option(ref(String));
 
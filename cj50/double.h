@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+#include <string.h>
 #include <cj50/gen/Option.h>
 #include <cj50/gen/ref.h>
 
@@ -16,6 +18,28 @@ bool equal_move_double(const double a, const double b) {
     return a == b;
 }
 
+// The bits of `x`, transformed so that comparing them as unsigned
+// numbers gives the order of `cmp_double` (radixsort.h sorts by the
+// same keys).
+static inline
+uint64_t _total_order_key_double(double x) {
+    uint64_t k;
+    memcpy(&k, &x, sizeof(k));
+    return (k >> 63) ? ~k : (k | 0x8000000000000000);
+}
+
+/// Like `cmp_int`, using the IEEE 754 "totalOrder" relation, so that
+/// all values can be sorted consistently: -0.0 comes before 0.0, and
+/// NaNs go to the ends (before all numbers if their sign bit is set,
+/// after them otherwise). Unlike with `==` (and `equal_double`), -0.0
+/// and 0.0 are thus not the same, and a NaN is the same as itself.
+static UNUSED
+int cmp_double(const double *a, const double *b) {
+    uint64_t ka = _total_order_key_double(*a);
+    uint64_t kb = _total_order_key_double(*b);
+    return (ka > kb) - (ka < kb);
+}
+
 static UNUSED
 int print_double(const double *x) {
     return printf("%.15g", *x);
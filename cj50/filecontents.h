@@ -4,6 +4,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 
 #include <cj50/os.h>
 #include <cj50/CStr.h>
@@ -58,3 +59,166 @@ cleanup0:
 }
 
 
+// ------------------------------------------------------------------ 
+
+/// A file mapped into memory read-only (see `man 2 mmap`), with
+/// contents that have been checked to be valid UTF-8. Use
+/// `deref_MappedFile` to get at the contents as a `strslice`, which
+/// borrows from the mapping and is only valid until
+/// `drop_MappedFile` is called.
+
+/// Unlike `filecontents_String`, nothing is copied: the pages are
+/// shared with the operating system's file cache. Note that if the
+/// file is truncated by another process while it is mapped, accessing
+/// the missing part kills the program with `SIGBUS`.
+
+/// Files that can't be mapped (pipes, character devices, and files
+/// in `/proc`, which report a size of 0) are read into memory from
+/// `xmalloc` instead.
+
+typedef struct MappedFile {
+    const char *ptr;
+    size_t len;
+    // false if `ptr` is from `xmalloc` (or "" if `len` is 0)
+    bool is_mapped;
+} MappedFile;
+
+static UNUSED
+void drop_MappedFile(MappedFile self) {
+    if (self.len > 0) {
+        if (self.is_mapped) {
+            if (munmap((void*)self.ptr, self.len) != 0) {
+                WARN_("Warning: drop_MappedFile: munmap failed: %s",
+                      strerror(errno));
+            }
+        } else {
+            xfree((void*)self.ptr);
+        }
+    }
+}
+
+static UNUSED
+bool equal_MappedFile(const MappedFile *a, const MappedFile *b) {
+    return (a->ptr == b->ptr) && (a->len == b->len);
+}
+
+static UNUSED
+int print_debug_MappedFile(const MappedFile *v) {
+    INIT_RESRET;
+    RESRET(printf("MappedFile(%p, %zu)", v->ptr, v->len));
+cleanup:
+    return ret;
+}
+
+/// The contents of the file. Borrows from `self`.
+
+static UNUSED
+strslice deref_MappedFile(const MappedFile *self) {
+    return new_strslice(self->ptr, self->len);
+}
+
+GENERATE_Result(MappedFile, UnicodeError);
+
+// Read `fd` until EOF into memory from `xmalloc`, for files that
+// can't be mapped. Stops early once more than `max_bytes` were read.
+static
+Result(MappedFile, UnicodeError) _read_MappedFile(int fd, size_t max_bytes) {
+    size_t cap = 4096;
+    size_t len = 0;
+    char *buf = xmalloc(cap);
+    while (len <= max_bytes) {
+        if (len == cap) {
+            cap *= 2;
+            buf = xreallocarray(buf, cap, 1);
+        }
+        ssize_t n = read(fd, &buf[len], cap - len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int err = errno;
+            xfree(buf);
+            return Err(MappedFile, UnicodeError)(
+                new_UnicodeError_from_SystemError(
+                    systemError(SYSCALLINFO_read, err)));
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+    }
+    if (len == 0) {
+        xfree(buf);
+        return Ok(MappedFile, UnicodeError)(
+            (MappedFile) { .ptr = "", .len = 0, .is_mapped = false });
+    }
+    return Ok(MappedFile, UnicodeError)(
+        (MappedFile) { .ptr = buf, .len = len, .is_mapped = false });
+}
+
+/// Map the file at the given `path` into memory, if possible (no
+/// system error, UTF-8 decoding error or limit excess occurred). The
+/// limit is the same as for `filecontents_String`: if the file
+/// contains `max_len` or more unicode codepoints, an error with
+/// `.kind == UnicodeErrorKind_LimitExceededError` is returned.
+
+static UNUSED
+Result(MappedFile, UnicodeError) open_MappedFile(cstr path, size_t max_len) {
+    BEGIN_Result(MappedFile, UnicodeError);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        RETURN_Err(systemError(SYSCALLINFO_open, errno), cleanup0);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        RETURN_Err(systemError(SYSCALLINFO_fstat, errno), cleanup1);
+    }
+    MappedFile m;
+    if (S_ISREG(st.st_mode) && (st.st_size > 0)) {
+        size_t len = st.st_size;
+        void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            RETURN_Err(systemError(SYSCALLINFO_mmap, errno), cleanup1);
+        }
+        m = (MappedFile) { .ptr = p, .len = len, .is_mapped = true };
+    } else {
+        // Not a regular file, or one whose size is unknown (files in
+        // /proc report 0), or empty. A UTF-8 sequence has at most 4
+        // bytes, thus reading more than `max_len * 4` bytes means
+        // there are at least `max_len` codepoints.
+        size_t max_bytes = (max_len <= SIZE_MAX / 4) ? max_len * 4 : SIZE_MAX;
+        m = TRY(_read_MappedFile(fd, max_bytes), cleanup1);
+        if (m.len > max_bytes) {
+            // (Checked before decoding, as reading stopped at an
+            // arbitrary byte.)
+            RETURN_Err(UnicodeError_LimitExceeded, cleanup2);
+        }
+    }
+
+    AUTO s = new_slice_char(m.ptr, m.len);
+    size_t valid = utf8_valid_up_to(s.ptr, s.len);
+    if (valid < s.len) {
+        RETURN_Err(_utf8_decoding_error_at(s, valid), cleanup2);
+    }
+    // There can't be more codepoints than bytes, so only count them
+    // when the limit could be reached.
+    if (m.len >= max_len) {
+        size_t count = 0;
+        for (size_t i = 0; i < m.len; i++) {
+            count += ((u8)m.ptr[i] & 0xC0) != 0x80;
+        }
+        if (count >= max_len) {
+            RETURN_Err(UnicodeError_LimitExceeded, cleanup2);
+        }
+    }
+    RETURN_Ok(m, cleanup1);
+
+cleanup2:
+    drop_MappedFile(m);
+cleanup1:
+    // The mapping stays valid after closing the file descriptor.
+    close(fd);
+cleanup0:
+    END_Result();
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+#include <string.h>
 #include <cj50/gen/Option.h>
 #include <cj50/gen/ref.h>
 
@@ -16,6 +18,28 @@ bool equal_move_float(const float a, const float b) {
     return a == b;
 }
 
+// The bits of `x`, transformed so that comparing them as unsigned
+// numbers gives the order of `cmp_float` (radixsort.h sorts by the
+// same keys).
+static inline
+uint32_t _total_order_key_float(float x) {
+    uint32_t k;
+    memcpy(&k, &x, sizeof(k));
+    return (k >> 31) ? ~k : (k | 0x80000000);
+}
+
+/// Like `cmp_int`, using the IEEE 754 "totalOrder" relation, so that
+/// all values can be sorted consistently: -0.0 comes before 0.0, and
+/// NaNs go to the ends (before all numbers if their sign bit is set,
+/// after them otherwise). Unlike with `==` (and `equal_float`), -0.0
+/// and 0.0 are thus not the same, and a NaN is the same as itself.
+static UNUSED
+int cmp_float(const float *a, const float *b) {
+    uint32_t ka = _total_order_key_float(*a);
+    uint32_t kb = _total_order_key_float(*b);
+    return (ka > kb) - (ka < kb);
+}
+
 static UNUSED
 int print_float(const float *x) {
     return printf("%g", *x);
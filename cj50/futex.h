@@ -0,0 +1,72 @@
+#pragma once
+
+//! Wrappers around Linux futexes ("fast userspace mutexes", see `man
+//! 2 futex`): the kernel can put a thread to sleep until another
+//! thread changes a 32-bit word in memory and wakes it up. Locks and
+//! other synchronization types in this library are built on these
+//! (see `AdaptiveMutex`), programs should normally use those instead.
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <cj50/basic-util.h>
+#include <cj50/u32.h>
+
+
+/// Put the current thread to sleep until another thread calls
+/// `futex_wake` on the same `addr`, but only if `*addr` still
+/// contains `expected` (which is checked atomically with going to
+/// sleep, so that a wake-up between the caller checking the value
+/// and calling this function is not missed).
+
+/// The function may also return without having been woken up, thus
+/// the caller has to check the value again in a loop. If `timeout`
+/// is not NULL, it is the maximum duration to sleep; returns false
+/// if that elapsed, true otherwise.
+
+static UNUSED
+bool futex_wait(u32 *addr, u32 expected, const struct timespec *timeout) {
+    long r = syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected,
+                     timeout, NULL, 0);
+    if (r == -1) {
+        int err = errno;
+        if (err == ETIMEDOUT) {
+            return false;
+        }
+        // EAGAIN: `*addr` was not `expected`; EINTR: signal
+        if (!((err == EAGAIN) || (err == EINTR))) {
+            DIE_("futex_wait: %s", strerror(err));
+        }
+    }
+    return true;
+}
+
+/// Wake up at most `n` threads sleeping in `futex_wait` on `addr`
+/// (pass `INT_MAX` to wake all of them). Returns the number of
+/// threads woken up.
+
+static UNUSED
+int futex_wake(u32 *addr, int n) {
+    long r = syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+    if (r == -1) {
+        DIE_("futex_wake: %s", strerror(errno));
+    }
+    return r;
+}
+
+/// Tell the CPU that the current thread is waiting in a loop for
+/// another thread (saves power, and on hyperthreaded CPUs gives the
+/// other hardware thread on the same core more resources).
+
+static inline UNUSED
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__ ("yield");
+#endif
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+//! `AdaptiveMutex(T)` is an alternative to `Mutex(T)` (see
+//! [`cj50/gen/template/Mutex.h`](template/Mutex.h.md)) for data that
+//! is only locked for very short moments (e.g. to update a counter
+//! or a few fields). Locking it when it is free is a single atomic
+//! instruction without calling into the C library. When it is
+//! locked by another thread, the thread trying to lock it first
+//! waits in a loop for a short while, since the other thread will
+//! likely unlock it soon, and only when that doesn't happen, it
+//! asks the kernel to put it to sleep (via `futex_wait`, see
+//! [`cj50/futex.h`](../futex.h.md)).
+
+//! * `cj50/gen/AdaptiveMutex.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/AdaptiveMutex.h`](template/AdaptiveMutex.h.md) (parameterized parts instantiated once per AdaptiveMutex)
+
+//! It is not recursive: locking it again from the thread that holds
+//! it hangs forever.
+
+#include <cj50/futex.h>
+#include <cj50/gen/Mutex.h>
+
+/// A parametrized mutex type that spins shortly before sleeping
+#define AdaptiveMutex(T) XCAT(AdaptiveMutex_, T)
+
+/// A parametrized guard type for `AdaptiveMutex(T)`
+#define AdaptiveMutexGuard(T) XCAT(AdaptiveMutexGuard_, T)
+
+
+/// How many times locking an `AdaptiveMutex` re-checks whether it
+/// has become free before going to sleep.
+
+#define ADAPTIVE_MUTEX_SPINS 100
+
+// The states of the futex word.
+#define _FUTEX_UNLOCKED 0
+#define _FUTEX_LOCKED 1
+// Locked, and there may be sleeping threads that need to be woken up
+// on unlocking
+#define _FUTEX_CONTENDED 2
+
+// The slow path of locking, after the first attempt found the word
+// in state `c`.
+static UNUSED
+void _lock_contended_futex_word(u32 *word, u32 c) {
+    for (int i = 0; (i < ADAPTIVE_MUTEX_SPINS) && (c == _FUTEX_LOCKED); i++) {
+        cpu_relax();
+        c = __atomic_load_n(word, __ATOMIC_RELAXED);
+        if ((c == _FUTEX_UNLOCKED)
+            && __atomic_compare_exchange_n(word, &c, _FUTEX_LOCKED, false,
+                                           __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+    // Announce that we are going to sleep; if it was unlocked in the
+    // meantime, we got it (in the contended state, which just costs
+    // an unnecessary wake-up call later on)
+    c = __atomic_exchange_n(word, _FUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+    while (c != _FUTEX_UNLOCKED) {
+        futex_wait(word, _FUTEX_CONTENDED, NULL);
+        c = __atomic_exchange_n(word, _FUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+    }
+}
+
+static inline UNUSED
+void _lock_futex_word(u32 *word) {
+    u32 c = _FUTEX_UNLOCKED;
+    if (!__atomic_compare_exchange_n(word, &c, _FUTEX_LOCKED, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        _lock_contended_futex_word(word, c);
+    }
+}
+
+static inline UNUSED
+bool _try_lock_futex_word(u32 *word) {
+    u32 c = _FUTEX_UNLOCKED;
+    return __atomic_compare_exchange_n(word, &c, _FUTEX_LOCKED, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline UNUSED
+void _unlock_futex_word(u32 *word) {
+    if (__atomic_exchange_n(word, _FUTEX_UNLOCKED, __ATOMIC_RELEASE)
+        == _FUTEX_CONTENDED) {
+        futex_wake(word, 1);
+    }
+}
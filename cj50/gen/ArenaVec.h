@@ -0,0 +1,27 @@
+#pragma once
+
+//! The `cj50/gen/ArenaVec` library implements vectors that store
+//! their items in an [`Arena`](../Arena.h.md) instead of memory of
+//! their own: growing them is cheap (often in place, and never a
+//! `malloc` once the arena has enough memory), and they don't need
+//! to be freed individually, as their memory goes away with the
+//! arena when it is reset or dropped. An `ArenaVec` must thus not be
+//! used after that.
+
+//! * `cj50/gen/ArenaVec.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/ArenaVec.h`](template/ArenaVec.h.md) (parameterized parts instantiated once per ArenaVec)
+
+//! `ArenaVec(T)` offers the same functions as `Vec(T)` that don't
+//! need ownership of the items (i.e. the ones from
+//! [`vectorlikes.h`](template/vectorlikes.h.md) and
+//! [`mutvectorlikes.h`](template/mutvectorlikes.h.md), plus `push`,
+//! `pop`, `extend_from_slice`, `reserve` and `clear`). The items are
+//! never dropped, so `T` should not own any resources. `Vec(T)` must
+//! be instantiated, too.
+
+#include <cj50/Arena.h>
+#include <cj50/gen/Vec.h>
+
+
+/// A parametrized vector type storing its items in an `Arena`
+#define ArenaVec(T) XCAT(ArenaVec_, T)
@@ -0,0 +1,44 @@
+#pragma once
+
+//! `Atomic(T)` holds a number or pointer that multiple threads can
+//! read and modify at the same time without a `Mutex`: each operation
+//! on it is indivisible, e.g. when two threads both add 1 via
+//! `fetch_add`, the value is guaranteed to have increased by 2. It
+//! wraps C11's `_Atomic` types (see `man stdatomic.h` or
+//! <https://en.cppreference.com/w/c/atomic>).
+
+//! * `cj50/gen/Atomic.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/Atomic.h`](template/Atomic.h.md) (parameterized parts instantiated once per Atomic)
+
+//! Every operation takes a `memory_order` argument, which says
+//! what the operation guarantees about the order in which *other*
+//! memory accesses become visible to other threads:
+
+//! * `memory_order_relaxed`: nothing, only the atomic value itself is
+//!   consistent. Enough for counters that are only read at the end.
+//! * `memory_order_release` (for stores) paired with
+//!   `memory_order_acquire` (for loads): if a thread sees a value
+//!   stored with release, it also sees all memory writes the storing
+//!   thread did before the store. Use this to hand data from one
+//!   thread to another.
+//! * `memory_order_acq_rel`: both, for operations that read and
+//!   write (like `fetch_add`).
+//! * `memory_order_seq_cst`: additionally, all threads agree on one
+//!   order of all `seq_cst` operations. The safest choice, but the
+//!   slowest.
+
+#include <stdatomic.h>
+#include <cj50/basic-util.h>
+#include <cj50/macro-util.h>
+#include <cj50/resret.h>
+#include <cj50/CStr.h>
+
+/// A parametrized atomic type
+#define Atomic(T) XCAT(Atomic_, T)
+
+/// The size of the unit in which CPU cores exchange memory between
+/// their caches (64 bytes on current x86 and most ARM CPUs). Atomics
+/// that different threads update often should be in different
+/// units, see `Counter`.
+
+#define CACHE_LINE_SIZE 64
@@ -0,0 +1,30 @@
+#pragma once
+
+//! The `cj50/gen/BinaryHeap` library implements priority queues:
+//! collections that hand out their largest element first, with
+//! O(log n) insertion and removal. Like Rust's `BinaryHeap`, they are
+//! max-heaps; for the smallest element first, use a type with a
+//! reversed `cmp` function.
+
+//! * `cj50/gen/BinaryHeap.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/BinaryHeap.h`](template/BinaryHeap.h.md) (instantiates both heap types for `T`)
+//! * [`cj50/gen/template/heap.h`](template/heap.h.md) (the implementation, parameterized by the arity)
+
+//! Two variants are available with the same functions: `BinaryHeap(T)`
+//! where each node has 2 children, and `QuadHeap(T)`, where each node
+//! has 4. The latter is less deep, and the children of a node are
+//! next to each other in memory, which usually makes it faster for
+//! larger heaps, especially when removing elements is frequent.
+
+//! The element type `T` needs a `cmp_T(const T *a, const T *b)`
+//! function returning a negative number, 0 or a positive number for
+//! `*a` being smaller, equal or larger than `*b`, and `Vec(T)` must
+//! be instantiated, too.
+
+#include <cj50/gen/Vec.h>
+
+/// A parametrized binary heap type
+#define BinaryHeap(T) XCAT(BinaryHeap_, T)
+
+/// A parametrized 4-ary heap type
+#define QuadHeap(T) XCAT(QuadHeap_, T)
@@ -0,0 +1,134 @@
+#pragma once
+
+//! A `Channel(T)` passes values of type `T` from threads that `send`
+//! them to threads that `recv` them, in the order they were sent
+//! (per sending thread). Any number of threads may send and receive
+//! at the same time. The channel holds at most a fixed number of
+//! values: sending blocks while it is full, until a receiver takes a
+//! value out, which keeps fast producers from running away from slow
+//! consumers.
+
+//! * `cj50/gen/Channel.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/Channel.h`](template/Channel.h.md) (parameterized parts instantiated once per Channel)
+
+//! Sending and receiving don't use locks: the values are stored in a
+//! ring buffer, in which each slot carries a sequence number telling
+//! whether it is ready to be written or read (after Dmitry Vyukov's
+//! "bounded MPMC queue"). Threads only ask the kernel to sleep when
+//! the channel is full or empty.
+
+//! When the producers are done, one of them (or another thread)
+//! calls `close`: from then on, sending fails, and receiving fails
+//! once the values sent before are used up, which tells the
+//! consumers to finish.
+
+#include <cj50/basic-util.h>
+#include <cj50/xmem.h>
+#include <cj50/futex.h>
+#include <cj50/Unit.h>
+#include <cj50/gen/Result.h>
+#include <cj50/gen/error.h>
+#include <cj50/gen/Atomic.h>
+#include <cj50/instantiations/Atomic_size_t.h>
+
+/// A parametrized channel type
+#define Channel(T) XCAT(Channel_, T)
+
+
+// ------------------------------------------------------------------
+// Errors
+
+/// The reason why sending or receiving failed. The instances are:
+
+///     ChannelError_Full    (only returned by `try_send`)
+///     ChannelError_Empty   (only returned by `try_recv`)
+///     ChannelError_Closed
+
+typedef struct ChannelError {
+    uint8_t code;
+} ChannelError;
+
+#define ChannelError(cod) ((ChannelError) { .code = cod })
+
+/// Check equivalence.
+static UNUSED
+bool equal_ChannelError(const ChannelError *a, const ChannelError *b) {
+    return a->code == b->code;
+}
+
+#define DEF_ChannelError(code, name) const ChannelError name = ChannelError(code)
+
+DEF_ChannelError(0, ChannelError_Full);
+DEF_ChannelError(1, ChannelError_Empty);
+DEF_ChannelError(2, ChannelError_Closed);
+
+const struct constant_name_and_message constant_name_and_message_from_ChannelError_code[] = {
+    { "ChannelError_Full", "the channel is full" },
+    { "ChannelError_Empty", "the channel is empty" },
+    { "ChannelError_Closed", "the channel is closed" },
+};
+#define constant_name_and_message_from_ChannelError_code_len        \
+    (sizeof(constant_name_and_message_from_ChannelError_code)       \
+     / sizeof(struct constant_name_and_message))
+
+#undef DEF_ChannelError
+#undef ChannelError
+
+/// Print in C code syntax.
+static UNUSED
+int print_debug_ChannelError(const ChannelError *e) {
+    assert(e->code < constant_name_and_message_from_ChannelError_code_len);
+    return printf("ChannelError(%s)",
+                  constant_name_and_message_from_ChannelError_code[e->code].constant_name);
+}
+
+/// Print for program user.
+static UNUSED
+int fprintln_ChannelError(FILE *out, const ChannelError *e) {
+    assert(e->code < constant_name_and_message_from_ChannelError_code_len);
+    return fprintf(
+        out, "Channel error: %s\n",
+        constant_name_and_message_from_ChannelError_code[e->code].message);
+}
+
+static UNUSED
+void drop_ChannelError(UNUSED ChannelError e) {}
+
+// ------------------------------------------------------------------
+
+GENERATE_Result(Unit, ChannelError);
+
+// For use in the template: expands `T` before GENERATE_Result turns
+// it into a string for printing.
+#define _GENERATE_Result_Channel(T, E) GENERATE_Result(T, E)
+
+
+// Register as waiting for `event` to change (the other side only
+// makes the wake-up system call if there are waiters), returning its
+// current value to pass to `futex_wait`. The caller must check again
+// whether it has to wait before calling `futex_wait`, then call
+// `_end_wait_Channel`.
+static inline
+u32 _start_wait_Channel(u32 *event, u32 *waiters) {
+    __atomic_fetch_add(waiters, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_load_n(event, __ATOMIC_SEQ_CST);
+}
+
+static inline
+void _end_wait_Channel(u32 *waiters) {
+    __atomic_fetch_sub(waiters, 1, __ATOMIC_RELAXED);
+}
+
+// Wake up to `n` threads waiting for `event`, after having made a
+// change they are waiting for. (The fence pairs with the one in
+// _start_wait_Channel: either the waiter sees the change, or we see
+// the waiter.)
+static inline
+void _notify_Channel(u32 *event, u32 *waiters, int n) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(event, 1, __ATOMIC_SEQ_CST);
+        futex_wake(event, n);
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+//! The `cj50/gen/HashMap` library implements hash maps: unordered
+//! collections of values `V`, each stored under a unique key `K`,
+//! with O(1) (on average) insertion, lookup and removal by key. It is
+//! closely modelled after Rust's `HashMap`, and like it (or rather,
+//! the hashbrown library behind it), it is a "Swiss table".
+
+//! * `cj50/gen/HashMap.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/HashMap.h`](template/HashMap.h.md) (parameterized parts instantiated once per HashMap)
+
+//! The entries are stored in an array of "buckets" (a power of 2 in
+//! size), with a "control byte" for each bucket that is either
+//! `_HASHMAP_EMPTY`, `_HASHMAP_DELETED`, or for a bucket holding an
+//! entry, 7 bits of the hash of its key. A lookup starts at the bucket
+//! given by the (lower bits of the) hash of the key, and compares the
+//! control bytes of 16 buckets at once (with SSE2 instructions on
+//! x86, a loop elsewhere) against the 7 bits of the hash; only the
+//! keys in buckets with matching control bytes have to be compared
+//! using `equal`. If the group of 16 buckets contains an empty
+//! bucket, the key is not present, otherwise the search continues
+//! with the next group (quadratic probing).
+
+//! The key type `K` needs `hash_K` (see [`cj50/hash.h`](../hash.h.md)),
+//! `equal_K`, `drop_K` and `print_debug_K` functions, the value type
+//! `V` `equal_V`, `drop_V`, `print_debug_V`, as well as `Option(V)`
+//! and `Option(ref(V))`. See `cj50/instantiations/HashMap_*.h` for
+//! instantiations.
+
+#include <stdint.h>
+#include <string.h>
+#include <cj50/basic-util.h>
+#include <cj50/macro-util.h>
+#include <cj50/xmem.h>
+#include <cj50/u8.h>
+#include <cj50/u64.h>
+#include <cj50/size_t.h>
+#include <cj50/gen/Option.h>
+#include <cj50/gen/ref.h>
+#include <cj50/resret.h>
+#include <cj50/hash.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+
+/// A parametrized hash map type
+#define HashMap(K, V) XCAT(HashMap_, XCAT(K, XCAT(__, V)))
+
+/// A key and its value as stored in `HashMap(K, V)`
+#define HashMapEntry(K, V) XCAT(HashMapEntry_, XCAT(K, XCAT(__, V)))
+
+/// An iterator over the entries of a `HashMap(K, V)`
+#define HashMapIter(K, V) XCAT(HashMapIter_, XCAT(K, XCAT(__, V)))
+
+
+// Control byte values; a bucket holding an entry has the top 7 bits
+// of the hash of its key as its control byte (i.e. the high bit is
+// 0).
+#define _HASHMAP_EMPTY ((u8)0x80)
+#define _HASHMAP_DELETED ((u8)0xFE)
+
+// The number of control bytes compared at once.
+#define _HASHMAP_GROUP_WIDTH 16
+
+// Control bytes for maps without any buckets, so that lookups don't
+// need a special case. Never written to.
+static const u8 _hashmap_empty_ctrl[_HASHMAP_GROUP_WIDTH] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+// Bit i is set if control byte i in the group starting at `ctrl`
+// equals `b`.
+static inline
+uint32_t _hashmap_match_byte(const u8 *ctrl, u8 b) {
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(b)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < _HASHMAP_GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(ctrl[i] == b) << i;
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set if control byte i is _HASHMAP_EMPTY.
+static inline
+uint32_t _hashmap_match_empty(const u8 *ctrl) {
+    return _hashmap_match_byte(ctrl, _HASHMAP_EMPTY);
+}
+
+// Bit i is set if control byte i is _HASHMAP_EMPTY or
+// _HASHMAP_DELETED (the only values with the high bit set).
+static inline
+uint32_t _hashmap_match_empty_or_deleted(const u8 *ctrl) {
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(group);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < _HASHMAP_GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set if bucket i holds an entry.
+static inline
+uint32_t _hashmap_match_full(const u8 *ctrl) {
+    return _hashmap_match_empty_or_deleted(ctrl) ^ 0xFFFF;
+}
+
+// The control byte for an entry with the given hash.
+static inline
+u8 _hashmap_h2(u64 hash) {
+    return hash >> 57;
+}
+
+// The number of entries that fit into `num_buckets` before growing
+// (load factor 7/8).
+static inline
+size_t _hashmap_capacity_for_buckets(size_t num_buckets) {
+    return num_buckets - num_buckets / 8;
+}
+
+// The number of buckets needed to hold `capacity` entries: a power
+// of 2, at least `_HASHMAP_GROUP_WIDTH`.
+static UNUSED
+size_t _hashmap_buckets_for_capacity(size_t capacity) {
+    size_t num_buckets = _HASHMAP_GROUP_WIDTH;
+    while (_hashmap_capacity_for_buckets(num_buckets) < capacity) {
+        if (num_buckets > SIZE_MAX / 4) {
+            DIE("HashMap: capacity overflow");
+        }
+        num_buckets *= 2;
+    }
+    return num_buckets;
+}
+
+// The position to look at next in the probe sequence; the groups
+// visited are at offsets 0, 16, 48, 96, .. (triangular numbers
+// times 16), which for power of 2 bucket counts visits every group.
+typedef struct _HashMapProbe {
+    size_t pos;
+    size_t stride;
+} _HashMapProbe;
+
+static inline
+_HashMapProbe _hashmap_probe_start(u64 hash, size_t bucket_mask) {
+    return (_HashMapProbe) { .pos = hash & bucket_mask, .stride = 0 };
+}
+
+static inline
+void _hashmap_probe_next(_HashMapProbe *probe, size_t bucket_mask) {
+    probe->stride += _HASHMAP_GROUP_WIDTH;
+    probe->pos = (probe->pos + probe->stride) & bucket_mask;
+}
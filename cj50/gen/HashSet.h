@@ -0,0 +1,29 @@
+#pragma once
+
+//! The `cj50/gen/HashSet` library implements hash sets: unordered
+//! collections of unique values of type `T`, with O(1) (on average)
+//! insertion, lookup and removal. A `HashSet(T)` is a `HashMap(T,
+//! Unit)` (see [`cj50/gen/HashMap.h`](HashMap.h.md)), and `T` needs
+//! the same functions as the key type of a `HashMap`, plus
+//! `Option(ref(T))`.
+
+//! * `cj50/gen/HashSet.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/HashSet.h`](template/HashSet.h.md) (parameterized parts instantiated once per HashSet)
+
+//! The template instantiates `HashMap(T, Unit)`, thus that must not
+//! be instantiated separately, too.
+
+#include <cj50/gen/HashMap.h>
+#include <cj50/Unit.h>
+
+
+/// A parametrized hash set type
+#define HashSet(T) XCAT(HashSet_, T)
+
+/// An iterator over the values of a `HashSet(T)`
+#define HashSetIter(T) XCAT(HashSetIter_, T)
+
+
+GENERATE_Option(Unit);
+GENERATE_ref(Unit);
+GENERATE_Option(ref(Unit));
@@ -6,6 +6,10 @@
 /// A parametrized mutex guard type
 #define MutexGuard(T) XCAT(MutexGuard_, T)
 
+/// The result of waiting on a `Condvar` with a timeout: the guard,
+/// and whether the timeout elapsed
+#define WaitTimeout(T) XCAT(WaitTimeout_, T)
+
 
 // (XX docs on variables?)
 bool __CJ50_Mutex_debug = false;
@@ -122,7 +122,9 @@
 /// `E`. For this reason, the type names `T` and `E` must not contain
 /// spaces, e.g. `unsigned int` would not work and a typedef like
 /// `uint` has to be used instead.
-#define Result(T, E) XCAT(Result_, XCAT(T, XCAT(__, E)))
+// (Pasting `T`, `__` and `E` in one go, as `__` followed by the type
+// name, e.g. `__size_t`, may be a macro defined by the system headers.)
+#define Result(T, E) XCAT(Result_, XCAT3(T, __, E))
 
 #define GENERATE_Result(T, E)                                   \
     typedef struct Result(T, E) {                               \
@@ -0,0 +1,21 @@
+#pragma once
+
+//! An `RwLock(T)` ("reader-writer lock") protects a value of type `T`
+//! like a `Mutex(T)`, but distinguishes between reading and writing:
+//! any number of threads can hold read access at the same time, but
+//! write access is exclusive. This is better than a `Mutex` for data
+//! that is read a lot and rarely changed.
+
+//! * `cj50/gen/RwLock.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/RwLock.h`](template/RwLock.h.md) (parameterized parts instantiated once per RwLock)
+
+#include <cj50/gen/Mutex.h>
+
+/// A parametrized reader-writer lock type
+#define RwLock(T) XCAT(RwLock_, T)
+
+/// The guard type for read access to an `RwLock(T)`
+#define RwLockReadGuard(T) XCAT(RwLockReadGuard_, T)
+
+/// The guard type for write access to an `RwLock(T)`
+#define RwLockWriteGuard(T) XCAT(RwLockWriteGuard_, T)
@@ -0,0 +1,25 @@
+#pragma once
+
+//! The `cj50/gen/SmallVec` library implements vectors that store up to
+//! `N` elements inside the `SmallVec` value itself, and only allocate
+//! memory (and move their elements there) once they grow beyond that.
+//! For vectors that usually hold only a few elements, this saves
+//! the allocation and the indirection.
+
+//! * `cj50/gen/SmallVec.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/SmallVec.h`](template/SmallVec.h.md) (parameterized parts instantiated once per SmallVec)
+
+//! A `SmallVec` is larger than a `Vec` by `N` elements, and is
+//! copied along when it is moved, hence `N` should be small.
+
+//! The element type `T` needs the same functions as for `Vec(T)`,
+//! and `Vec(T)` must be instantiated, too: `SmallVec(T, N)` hands out
+//! its contents as `slice(T)` and `mutslice(T)` via `deref` and
+//! `deref_mut`, on which all functions for slices can be used.
+
+#include <cj50/gen/Vec.h>
+
+
+/// A parametrized small vector type, holding up to `N` elements
+/// without allocating.
+#define SmallVec(T, N) XCAT(SmallVec_, XCAT3(T, _, N))
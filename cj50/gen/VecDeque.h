@@ -0,0 +1,24 @@
+#pragma once
+
+//! The `cj50/gen/VecDeque` library implements double-ended queues: a
+//! growable ring buffer that allows adding and removing elements at
+//! both ends in O(1), closely modelled after Rust's `VecDeque`.
+
+//! * `cj50/gen/VecDeque.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/VecDeque.h`](template/VecDeque.h.md) (parameterized parts instantiated once per VecDeque)
+
+//! The elements are stored in a buffer whose size is a power of two,
+//! starting at some position `head` and wrapping around at the end;
+//! `as_slices` gives access to them as two `slice`s (the second one
+//! being empty if the elements do not wrap around), so that all the
+//! functions on slices can be used on them without copying.
+
+//! `Vec(T)` must be instantiated for the element type, too.
+
+#include <cj50/gen/Vec.h>
+
+/// A parametrized double-ended queue type
+#define VecDeque(T) XCAT(VecDeque_, T)
+
+/// The two parts of the contents of a `VecDeque(T)`, in order
+#define VecDequeSlices(T) XCAT(VecDequeSlices_, T)
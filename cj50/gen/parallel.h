@@ -0,0 +1,25 @@
+#pragma once
+
+//! Data parallel operations on slices, running on a `ThreadPool` (see
+//! [cj50/threadpool.h](../threadpool.h.md)):
+
+//! * `parallel_for_slice_T`, `parallel_for_mutslice_T`: call a
+//!   function on every item
+//! * `parallel_map_slice_T`: a new Vec with a function applied to
+//!   every item
+//! * `parallel_reduce_slice_T`: combine all items into one value
+
+//! The parameterized parts are in
+//! [`cj50/gen/template/parallel.h`](template/parallel.h.md); see
+//! `cj50/instantiations/parallel_*.h` for instantiations.
+
+#include <cj50/threadpool.h>
+#include <cj50/gen/Vec.h>
+
+/// The number of items that `parallel_reduce_slice_T` combines
+/// sequentially before combining the partial results. Fixed, so that
+/// the result does not depend on the number of threads (which matters
+/// for floating point numbers, where the order of additions changes
+/// the result).
+
+#define PARALLEL_REDUCE_CHUNK_LEN 4096
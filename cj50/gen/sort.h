@@ -0,0 +1,61 @@
+#pragma once
+
+//! The `cj50/gen/sort` library implements sorting and binary search
+//! for `Vec`, `mutslice` and `slice`, specialized for each element
+//! type (i.e. the comparisons are direct calls of `cmp_T` that the
+//! compiler can inline, unlike with `qsort` from the C library, which
+//! calls a comparison function through a pointer for every
+//! comparison).
+
+//! * `cj50/gen/sort.h` (main file, non-parameterized parts)
+//! * [`cj50/gen/template/sort.h`](template/sort.h.md) (parameterized parts instantiated once per element type)
+//! * [`cj50/radixsort.h`](../radixsort.h.md) (radix sort for numbers, used by the former for large inputs)
+
+//! The element type `T` needs a `cmp_T(const T *a, const T *b)`
+//! function returning a negative number, 0 or a positive number for
+//! `*a` being smaller, equal or larger than `*b`. See
+//! `cj50/instantiations/sort_*.h` for instantiations.
+
+//! `sort_mutslice_T` is a pattern-defeating quicksort (after Orson
+//! Peters' pdqsort, also used by Rust's `sort_unstable`): O(n log n)
+//! in the worst case, O(n) for already sorted input or inputs with
+//! few distinct values, does not allocate, but does not keep equal
+//! elements in their original order. `sort_stable_mutslice_T` is a
+//! merge sort that does keep them in order, but allocates a buffer
+//! of half the size of the input.
+
+#include <cj50/basic-util.h>
+#include <cj50/macro-util.h>
+#include <cj50/xmem.h>
+#include <cj50/size_t.h>
+#include <cj50/gen/Result.h>
+#include <cj50/gen/Vec.h>
+
+
+/// `binary_search` returns `Ok(index)` of a matching element, or
+/// `Err(index)` where a matching element could be inserted to keep
+/// the sequence sorted.
+
+GENERATE_Result(size_t, size_t);
+
+
+// Sequences up to this length are sorted via insertion sort.
+#define _SORT_INSERTION_LEN 20
+
+// Partial insertion sort gives up after moving this many elements.
+#define _SORT_PARTIAL_INSERTION_MOVES 8
+
+// Sequences at least this long use radix sort if available.
+#define _SORT_RADIX_MIN_LEN 256
+
+// The depth limit for quicksort, after which it switches to
+// heapsort: 2 * log2(len).
+static inline
+int _sort_depth_limit(size_t len) {
+    int limit = 0;
+    while (len > 1) {
+        limit += 2;
+        len >>= 1;
+    }
+    return limit;
+}
@@ -0,0 +1,91 @@
+// parameters: T
+
+#include <cj50/gen/AdaptiveMutex.h>
+
+
+//! Part of the [`cj50/gen/AdaptiveMutex.h`](../AdaptiveMutex.h.md)
+//! library. The functions are used the same way as those of `Mutex`.
+
+//! Example:
+
+/// ```C
+/// #include <cj50/instantiations/AdaptiveMutex_int.h>
+///
+/// void* thread_run(void *arg) {
+///     AdaptiveMutex(int) *counter = arg;
+///     for (size_t i = 0; i < 1000000; i++) {
+///         AdaptiveMutexGuard(int) g = lock_AdaptiveMutex_int(counter);
+///         (*deref_mut_AdaptiveMutexGuard_int(&g))++;
+///         drop_AdaptiveMutexGuard_int(g);
+///     }
+///     return NULL;
+/// }
+/// ```
+
+typedef struct AdaptiveMutex(T) {
+    u32 __private_word;
+    T __private_data; // never access directly, use `lock` function instead!
+} AdaptiveMutex(T);
+
+/// Create a new mutex, protecting `val`, which becomes owned by the
+/// `AdaptiveMutex` (see `new_Mutex_T`).
+
+static UNUSED
+AdaptiveMutex(T) XCAT(new_, AdaptiveMutex(T))(T val) {
+    return (AdaptiveMutex(T)) {
+        .__private_word = _FUTEX_UNLOCKED,
+        .__private_data = val
+    };
+}
+
+static UNUSED
+void XCAT(drop_, AdaptiveMutex(T))(AdaptiveMutex(T) self) {
+    assert(self.__private_word == _FUTEX_UNLOCKED);
+    XCAT(drop_, T)(self.__private_data);
+}
+
+/// Returned by `lock_AdaptiveMutex_T`, gives access to the data until
+/// dropped, like `MutexGuard`.
+
+typedef struct AdaptiveMutexGuard(T) {
+    AdaptiveMutex(T) *__private_mutex;
+    // Allocation used only to have ASAN report on usage errors:
+    void *__private_possibly_leaktest;
+} AdaptiveMutexGuard(T);
+
+/// Lock the mutex, waiting for another thread to unlock it if
+/// necessary. The returned guard must be dropped to unlock it again;
+/// see `lock_Mutex_T` for the details.
+
+static UNUSED
+AdaptiveMutexGuard(T) XCAT(lock_, AdaptiveMutex(T))(AdaptiveMutex(T) *self) {
+    _lock_futex_word(&self->__private_word);
+    return (AdaptiveMutexGuard(T)) {
+        .__private_mutex = self,
+        .__private_possibly_leaktest = __CJ50_Mutex_debug ? xmalloc(1) : NULL
+    };
+}
+
+static UNUSED
+void XCAT(drop_, AdaptiveMutexGuard(T))(AdaptiveMutexGuard(T) self) {
+    if (self.__private_possibly_leaktest) {
+        xfree(self.__private_possibly_leaktest);
+    }
+    _unlock_futex_word(&self.__private_mutex->__private_word);
+}
+
+/// Get read-only access to the protected data, valid until the guard
+/// is dropped.
+
+static UNUSED
+const T* XCAT(deref_, AdaptiveMutexGuard(T))(const AdaptiveMutexGuard(T) *self) {
+    return &self->__private_mutex->__private_data;
+}
+
+/// Get mutable access to the protected data, valid until the guard is
+/// dropped.
+
+static UNUSED
+T* XCAT(deref_mut_, AdaptiveMutexGuard(T))(const AdaptiveMutexGuard(T) *self) {
+    return &self->__private_mutex->__private_data;
+}
@@ -0,0 +1,156 @@
+// parameters: T
+
+//! Part of the [`cj50/gen/ArenaVec.h`](../ArenaVec.h.md) library.
+
+//! Example:
+
+/// ```C
+/// Arena arena = new_Arena();
+/// ArenaVec(Vec2(float)) points = new_ArenaVec_Vec2_float(&arena);
+/// push_ArenaVec_Vec2_float(&points, vec2_float(1., 2.));
+/// // ... use deref_ArenaVec_Vec2_float(&points) ...
+/// reset_Arena(&arena); // `points` is gone now
+/// ```
+
+
+/// Like `Vec`, plus the arena that the items are stored in.
+
+/// Never mutate those fields directly, use accessor functions
+/// instead!
+
+typedef struct ArenaVec(T) {
+    T *ptr;
+    size_t cap;
+    size_t len;
+    Arena *arena;
+} ArenaVec(T);
+
+
+/// Does nothing: the memory belongs to the arena, and the items are
+/// not dropped. Exists so that generic code can treat `ArenaVec`
+/// like other types.
+
+static UNUSED
+void XCAT(drop_, ArenaVec(T))(UNUSED ArenaVec(T) self) {}
+
+#define VEC ArenaVec
+#include <cj50/gen/template/vectorlikes.h>
+#include <cj50/gen/template/mutvectorlikes.h>
+#undef VEC
+
+
+/// Construct a new, empty vector storing its items in `arena`, which
+/// must live longer than the vector (it's not allocating until items
+/// are pushed).
+
+static UNUSED
+ArenaVec(T) XCAT(new_, ArenaVec(T))(Arena *arena) {
+    return (ArenaVec(T)) {
+        .ptr = NULL,
+        .cap = 0,
+        .len = 0,
+        .arena = arena
+    };
+}
+
+/// Construct a new, empty vector with room for `cap` items, see
+/// `new_ArenaVec_T`.
+
+static UNUSED
+ArenaVec(T) XCAT(with_capacity_, ArenaVec(T))(Arena *arena, size_t cap) {
+    return (ArenaVec(T)) {
+        .ptr = ARENA_ALLOC(arena, T, cap),
+        .cap = cap,
+        .len = 0,
+        .arena = arena
+    };
+}
+
+/// Make sure that there is room for at least `additional` more items,
+/// growing geometrically.
+
+static UNUSED
+void XCAT(reserve_, ArenaVec(T))(ArenaVec(T) *self, size_t additional) {
+    size_t len = self->len;
+    if (self->cap - len >= additional) {
+        return;
+    }
+    if (len > SIZE_MAX - additional) {
+        die_outofmemory();
+    }
+    size_t cap = self->cap < SIZE_MAX / 2 ? self->cap * 2 : SIZE_MAX;
+    cap = max_size_t(cap, max_size_t(len + additional, 8));
+    if (cap > SIZE_MAX / sizeof(T)) {
+        die_outofmemory();
+    }
+    self->ptr = realloc_Arena(self->arena, self->ptr,
+                              self->cap * sizeof(T), cap * sizeof(T),
+                              _Alignof(T));
+    self->cap = cap;
+}
+
+/// Appends an element to the back of the vector.
+
+static UNUSED
+void XCAT(push_, ArenaVec(T))(ArenaVec(T) *self, T value) {
+    size_t len = self->len;
+    if (len == self->cap) {
+        XCAT(reserve_, ArenaVec(T))(self, 1);
+    }
+    self->ptr[len] = value;
+    self->len = len + 1;
+}
+
+/// Removes the last element from a vector and returns it, or None if
+/// it is empty.
+
+static UNUSED
+Option(T) XCAT(pop_, ArenaVec(T))(ArenaVec(T) *self) {
+    size_t len = self->len;
+    if (len > 0) {
+        self->len = len - 1;
+        return XCAT(some_, T)(self->ptr[len - 1]);
+    } else {
+        return XCAT(none_, T)();
+    }
+}
+
+/// Appends copies of all the elements in `items` to the back of the
+/// vector.
+
+static UNUSED
+void XCAT(extend_from_slice_, ArenaVec(T))(ArenaVec(T) *self,
+                                           slice(T) items) {
+    size_t count = items.len;
+    if (count == 0) {
+        return;
+    }
+    XCAT(reserve_, ArenaVec(T))(self, count);
+    memcpy(&self->ptr[self->len], items.ptr, count * sizeof(T));
+    self->len += count;
+}
+
+/// Remove all items, keeping the capacity.
+
+static UNUSED
+void XCAT(clear_, ArenaVec(T))(ArenaVec(T) *self) {
+    self->len = 0;
+}
+
+/// Get a mutable slice of the whole vector.
+
+static UNUSED
+mutslice(T) XCAT(deref_mut_, ArenaVec(T))(ArenaVec(T) *self) {
+    return XCAT(new_, mutslice(T))(self->ptr, self->len);
+}
+
+/// Copy the items into a new `Vec`, which, unlike the `ArenaVec`, can
+/// live on after the arena is reset.
+
+static UNUSED
+Vec(T) XCAT(to_Vec_, ArenaVec(T))(const ArenaVec(T) *self) {
+    Vec(T) v = XCAT(new_, Vec(T))();
+    XCAT(extend_from_slice_, Vec(T))(
+        &v, XCAT(deref_, ArenaVec(T))(self));
+    return v;
+}
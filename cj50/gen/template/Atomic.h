@@ -0,0 +1,142 @@
+// parameters: T, optional: ATOMIC_INTEGER
+
+//! Part of the [`cj50/gen/Atomic.h`](../Atomic.h.md) library. If
+//! `ATOMIC_INTEGER` is defined when instantiating, the arithmetic
+//! operations (`fetch_add` etc.) are generated, too; leave it
+//! undefined for pointer types.
+
+//! Example:
+
+/// ```C
+/// #include <cj50/instantiations/Atomic_int.h>
+///
+/// Atomic(int) hits = new_Atomic_int(0);
+/// // in any thread:
+/// fetch_add_Atomic_int(&hits, 1, memory_order_relaxed);
+/// // after all threads have been joined:
+/// printf("%i\n", load_Atomic_int(&hits, memory_order_relaxed));
+/// ```
+
+#include <cj50/gen/Atomic.h>
+
+
+typedef struct Atomic(T) {
+    _Atomic(T) __private_value; // only access via the functions
+} Atomic(T);
+
+/// Create a new atomic holding `val`.
+
+static UNUSED
+Atomic(T) XCAT(new_, Atomic(T))(T val) {
+    Atomic(T) self;
+    atomic_init(&self.__private_value, val);
+    return self;
+}
+
+static UNUSED
+void XCAT(drop_, Atomic(T))(UNUSED Atomic(T) self) {}
+
+/// Read the value.
+
+static UNUSED
+T XCAT(load_, Atomic(T))(const Atomic(T) *self, memory_order order) {
+    return atomic_load_explicit((_Atomic(T) *)&self->__private_value, order);
+}
+
+/// Replace the value with `val`.
+
+static UNUSED
+void XCAT(store_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    atomic_store_explicit(&self->__private_value, val, order);
+}
+
+/// Replace the value with `val`, returning the previous value.
+
+static UNUSED
+T XCAT(swap_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_exchange_explicit(&self->__private_value, val, order);
+}
+
+/// If the value is equal to `*expected`, replace it with `desired`
+/// and return true. Otherwise, store the current value in
+/// `*expected` and return false. `success` is the memory order for
+/// the first case, `failure` (which can't be a release order) for
+/// the second.
+
+/// This is the basis for updating the value in a way that the
+/// other operations don't offer: read it, compute the new value,
+/// and try to store it; if another thread changed the value in the
+/// meantime, compute again from the value that it was changed to.
+
+static UNUSED
+bool XCAT(compare_exchange_, Atomic(T))(Atomic(T) *self, T *expected,
+                                        T desired, memory_order success,
+                                        memory_order failure) {
+    return atomic_compare_exchange_strong_explicit(
+        &self->__private_value, expected, desired, success, failure);
+}
+
+/// Like `compare_exchange_Atomic_T`, but may also fail when the value
+/// is equal to `*expected` (on some CPUs, this makes it faster when
+/// used in a loop that retries anyway).
+
+static UNUSED
+bool XCAT(compare_exchange_weak_, Atomic(T))(Atomic(T) *self, T *expected,
+                                             T desired, memory_order success,
+                                             memory_order failure) {
+    return atomic_compare_exchange_weak_explicit(
+        &self->__private_value, expected, desired, success, failure);
+}
+
+#ifdef ATOMIC_INTEGER
+
+/// Add `val` to the value, returning the previous value (wraps around
+/// on overflow, even for signed types).
+
+static UNUSED
+T XCAT(fetch_add_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_fetch_add_explicit(&self->__private_value, val, order);
+}
+
+/// Subtract `val` from the value, returning the previous value.
+
+static UNUSED
+T XCAT(fetch_sub_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_fetch_sub_explicit(&self->__private_value, val, order);
+}
+
+/// Bitwise "and" the value with `val`, returning the previous value.
+
+static UNUSED
+T XCAT(fetch_and_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_fetch_and_explicit(&self->__private_value, val, order);
+}
+
+/// Bitwise "or" the value with `val`, returning the previous value.
+
+static UNUSED
+T XCAT(fetch_or_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_fetch_or_explicit(&self->__private_value, val, order);
+}
+
+/// Bitwise "xor" the value with `val`, returning the previous value.
+
+static UNUSED
+T XCAT(fetch_xor_, Atomic(T))(Atomic(T) *self, T val, memory_order order) {
+    return atomic_fetch_xor_explicit(&self->__private_value, val, order);
+}
+
+#endif
+
+/// Print the current value (read with relaxed order).
+
+static UNUSED
+int XCAT(print_debug_, Atomic(T))(const Atomic(T) *self) {
+    INIT_RESRET;
+    T val = XCAT(load_, Atomic(T))(self, memory_order_relaxed);
+    RESRET(print_move_cstr("Atomic("));
+    RESRET(XCAT(print_debug_, T)(&val));
+    RESRET(print_move_cstr(")"));
+cleanup:
+    return ret;
+}
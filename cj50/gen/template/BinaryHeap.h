@@ -0,0 +1,16 @@
+// parameters: T
+
+//! Part of the [`cj50/gen/BinaryHeap.h`](../BinaryHeap.h.md) library:
+//! instantiates `BinaryHeap(T)` and `QuadHeap(T)`.
+
+#define HEAP BinaryHeap
+#define ARITY 2
+#include <cj50/gen/template/heap.h>
+#undef ARITY
+#undef HEAP
+
+#define HEAP QuadHeap
+#define ARITY 4
+#include <cj50/gen/template/heap.h>
+#undef ARITY
+#undef HEAP
@@ -0,0 +1,273 @@
+// parameters: T
+
+#include <cj50/gen/Channel.h>
+
+
+//! Part of the [`cj50/gen/Channel.h`](../Channel.h.md) library.
+
+//! Example:
+
+/// ```C
+/// #include <cj50/instantiations/Channel_int.h>
+///
+/// void* consume(void *arg) {
+///     Channel(int) *ch = arg;
+///     while (true) {
+///         if_let_Ok(n, recv_Channel_int(ch)) {
+///             printf("got %i\n", n);
+///         } else_Err(_) {
+///             // closed and all values received
+///             break;
+///         } end_let_Ok;
+///     }
+///     return NULL;
+/// }
+///
+/// // in main:
+/// Channel(int) ch = new_Channel_int(64);
+/// Thread t = unwrap(spawn_thread(consume, &ch, String("consumer")));
+/// for (int i = 0; i < 10; i++) {
+///     unwrap(send_Channel_int(&ch, i));
+/// }
+/// close_Channel_int(&ch);
+/// unwrap(join_Thread(t));
+/// drop_Channel_int(ch);
+/// ```
+
+_GENERATE_Result_Channel(T, ChannelError);
+
+typedef struct XCAT(_ChannelSlot_, T) {
+    // == position: free for the sender at that position; ==
+    // position + 1: holds the value for the receiver at position
+    Atomic(size_t) seq;
+    T value;
+} XCAT(_ChannelSlot_, T);
+
+/// Never access the fields directly, use the functions instead. A
+/// `Channel` must not be moved while threads are using it.
+
+typedef struct Channel(T) {
+    XCAT(_ChannelSlot_, T) *slots;
+    size_t mask; // number of slots - 1
+    u32 closed;
+    // Changed when a value was received, for senders waiting because
+    // the channel was full
+    u32 send_event;
+    u32 send_waiters;
+    // Changed when a value was sent, for receivers waiting because
+    // the channel was empty
+    u32 recv_event;
+    u32 recv_waiters;
+    // The positions of the next send and receive, in separate cache
+    // lines as senders and receivers update them independently
+    char _pad1[CACHE_LINE_SIZE];
+    Atomic(size_t) send_pos;
+    char _pad2[CACHE_LINE_SIZE - sizeof(Atomic(size_t))];
+    Atomic(size_t) recv_pos;
+} Channel(T);
+
+
+/// Create a new channel that can hold at least `capacity` values
+/// (rounded up to a power of two, at least 2).
+
+static UNUSED
+Channel(T) XCAT(new_, Channel(T))(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) {
+        if (n > SIZE_MAX / 2) {
+            DIE("Channel: capacity too large");
+        }
+        n *= 2;
+    }
+    Channel(T) self = {
+        .slots = xmallocarray(n, sizeof(XCAT(_ChannelSlot_, T))),
+        .mask = n - 1,
+        .closed = 0,
+        .send_event = 0,
+        .send_waiters = 0,
+        .recv_event = 0,
+        .recv_waiters = 0,
+        .send_pos = new_Atomic_size_t(0),
+        .recv_pos = new_Atomic_size_t(0)
+    };
+    for (size_t i = 0; i < n; i++) {
+        self.slots[i].seq = new_Atomic_size_t(i);
+    }
+    return self;
+}
+
+/// The number of values the channel can hold.
+
+static UNUSED
+size_t XCAT(capacity_, Channel(T))(const Channel(T) *self) {
+    return self->mask + 1;
+}
+
+/// Whether `close` was called on the channel.
+
+static UNUSED
+bool XCAT(is_closed_, Channel(T))(const Channel(T) *self) {
+    return __atomic_load_n(&self->closed, __ATOMIC_ACQUIRE);
+}
+
+// Take the next value out if there is one.
+static
+bool XCAT(_pop_, Channel(T))(Channel(T) *self, T *out) {
+    size_t pos = load_Atomic_size_t(&self->recv_pos, memory_order_relaxed);
+    while (true) {
+        XCAT(_ChannelSlot_, T) *slot = &self->slots[pos & self->mask];
+        size_t seq = load_Atomic_size_t(&slot->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (compare_exchange_weak_Atomic_size_t(
+                    &self->recv_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *out = slot->value;
+                // Free for the sender one round later
+                store_Atomic_size_t(&slot->seq, pos + self->mask + 1,
+                                    memory_order_release);
+                return true;
+            }
+            // else `pos` was updated, retry
+        } else if (dif < 0) {
+            // The sender for this position hasn't finished yet
+            return false;
+        } else {
+            // Another receiver took it
+            pos = load_Atomic_size_t(&self->recv_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/// Send `*value` if there is room in the channel, without waiting.
+/// Returns `ChannelError_Full` or `ChannelError_Closed` if not. The
+/// value is only moved into the channel on success, otherwise the
+/// caller still owns it.
+
+static UNUSED
+Result(Unit, ChannelError) XCAT(try_send_, Channel(T))(Channel(T) *self,
+                                                       T *value) {
+    if (XCAT(is_closed_, Channel(T))(self)) {
+        return Err(Unit, ChannelError)(ChannelError_Closed);
+    }
+    size_t pos = load_Atomic_size_t(&self->send_pos, memory_order_relaxed);
+    while (true) {
+        XCAT(_ChannelSlot_, T) *slot = &self->slots[pos & self->mask];
+        size_t seq = load_Atomic_size_t(&slot->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (compare_exchange_weak_Atomic_size_t(
+                    &self->send_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                slot->value = *value;
+                store_Atomic_size_t(&slot->seq, pos + 1, memory_order_release);
+                _notify_Channel(&self->recv_event, &self->recv_waiters, 1);
+                return Ok(Unit, ChannelError)(Unit());
+            }
+        } else if (dif < 0) {
+            // The slot still holds the value from one round earlier
+            return Err(Unit, ChannelError)(ChannelError_Full);
+        } else {
+            pos = load_Atomic_size_t(&self->send_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/// Receive the next value if there is one, without waiting. Returns
+/// `ChannelError_Empty` if there is none, or `ChannelError_Closed` if
+/// there is none and the channel was closed.
+
+static UNUSED
+Result(T, ChannelError) XCAT(try_recv_, Channel(T))(Channel(T) *self) {
+    T value;
+    if (!XCAT(_pop_, Channel(T))(self, &value)) {
+        if (!XCAT(is_closed_, Channel(T))(self)) {
+            return Err(T, ChannelError)(ChannelError_Empty);
+        }
+        // Values sent before closing must be seen now
+        if (!XCAT(_pop_, Channel(T))(self, &value)) {
+            return Err(T, ChannelError)(ChannelError_Closed);
+        }
+    }
+    _notify_Channel(&self->send_event, &self->send_waiters, 1);
+    return Ok(T, ChannelError)(value);
+}
+
+/// Send `value`, waiting while the channel is full. The value is
+/// consumed: if the channel is (or becomes, while waiting) closed,
+/// `ChannelError_Closed` is returned and the value dropped.
+
+static UNUSED
+Result(Unit, ChannelError) XCAT(send_, Channel(T))(Channel(T) *self, T value) {
+    while (true) {
+        AUTO r = XCAT(try_send_, Channel(T))(self, &value);
+        if (r.is_ok) {
+            return r;
+        }
+        if (r.err.code == ChannelError_Full.code) {
+            u32 ev = _start_wait_Channel(&self->send_event, &self->send_waiters);
+            r = XCAT(try_send_, Channel(T))(self, &value);
+            if (!r.is_ok && (r.err.code == ChannelError_Full.code)) {
+                futex_wait(&self->send_event, ev, NULL);
+            }
+            _end_wait_Channel(&self->send_waiters);
+            if (r.is_ok) {
+                return r;
+            }
+        }
+        if (r.err.code == ChannelError_Closed.code) {
+            XCAT(drop_, T)(value);
+            return r;
+        }
+    }
+}
+
+/// Receive the next value, waiting while the channel is empty.
+/// Returns `ChannelError_Closed` once the channel is closed and all
+/// values sent before have been received.
+
+static UNUSED
+Result(T, ChannelError) XCAT(recv_, Channel(T))(Channel(T) *self) {
+    while (true) {
+        AUTO r = XCAT(try_recv_, Channel(T))(self);
+        if (r.is_ok || (r.err.code == ChannelError_Closed.code)) {
+            return r;
+        }
+        u32 ev = _start_wait_Channel(&self->recv_event, &self->recv_waiters);
+        r = XCAT(try_recv_, Channel(T))(self);
+        if (!r.is_ok && (r.err.code == ChannelError_Empty.code)) {
+            futex_wait(&self->recv_event, ev, NULL);
+        }
+        _end_wait_Channel(&self->recv_waiters);
+        if (r.is_ok || (r.err.code == ChannelError_Closed.code)) {
+            return r;
+        }
+    }
+}
+
+/// Close the channel: sending fails from now on, and receiving fails
+/// after the values in the channel have been received. Threads
+/// waiting in `send` or `recv` are woken up. A value that a thread
+/// sends at the same time as the channel is closed is either still
+/// received, or dropped with the channel.
+
+static UNUSED
+void XCAT(close_, Channel(T))(Channel(T) *self) {
+    __atomic_store_n(&self->closed, 1, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&self->send_event, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&self->send_event, INT_MAX);
+    __atomic_fetch_add(&self->recv_event, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&self->recv_event, INT_MAX);
+}
+
+/// Free the channel, dropping the values that were not received. No
+/// thread may be using it anymore.
+
+static UNUSED
+void XCAT(drop_, Channel(T))(Channel(T) self) {
+    T value;
+    while (XCAT(_pop_, Channel(T))(&self, &value)) {
+        XCAT(drop_, T)(value);
+    }
+    xfree(self.slots);
+}
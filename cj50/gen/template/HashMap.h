@@ -0,0 +1,447 @@
+// parameters: K, V
+
+//! Part of the [`cj50/gen/HashMap.h`](../HashMap.h.md) library: the
+//! parts instantiated once per HashMap parametrization.
+
+//! Example:
+
+/// ```C
+/// #include <cj50.h>
+/// #include <cj50/instantiations/HashMap_String__int.h>
+///
+/// int main() {
+///     HashMap(String, int) m = new_HashMap_String__int();
+///     insert_HashMap_String__int(&m, String("one"), 1);
+///     insert_HashMap_String__int(&m, String("two"), 2);
+///     drop(insert_HashMap_String__int(&m, String("one"), 100)); // replaces 1
+///
+///     String two = String("two");
+///     if_let_Some(v, get_HashMap_String__int(&m, &two)) {
+///         assert(*v == 2);
+///     } else_None;
+///     assert(unwrap(remove_HashMap_String__int(&m, &two)) == 2);
+///     assert(len_HashMap_String__int(&m) == 1);
+///     drop(two);
+///
+///     HashMapIter(String, int) it = iter_HashMap_String__int(&m);
+///     while_let_Some(entry, next_HashMapIter_String__int(&it)) {
+///         print_debug(&entry->key);
+///         println(entry->value);
+///     }
+///     drop_HashMap_String__int(m);
+/// }
+/// ```
+
+
+/// The key and value of an entry in a `HashMap(K, V)`.
+
+typedef struct HashMapEntry(K, V) {
+    K key;
+    V value;
+} HashMapEntry(K, V);
+
+static UNUSED
+void XCAT(drop_, HashMapEntry(K, V))(HashMapEntry(K, V) self) {
+    XCAT(drop_, K)(self.key);
+    XCAT(drop_, V)(self.value);
+}
+
+static UNUSED
+bool XCAT(equal_, HashMapEntry(K, V))(const HashMapEntry(K, V) *a,
+                                      const HashMapEntry(K, V) *b) {
+    return (XCAT(equal_, K)(&a->key, &b->key) &&
+            XCAT(equal_, V)(&a->value, &b->value));
+}
+
+static UNUSED
+int XCAT(print_debug_, HashMapEntry(K, V))(const HashMapEntry(K, V) *self) {
+    INIT_RESRET;
+    RESRET(XCAT(print_debug_, K)(&self->key));
+    RESRET(print_move_cstr(": "));
+    RESRET(XCAT(print_debug_, V)(&self->value));
+cleanup:
+    return ret;
+}
+
+GENERATE_ref(HashMapEntry(K, V));
+GENERATE_Option(ref(HashMapEntry(K, V)));
+
+
+/// A hash map owning keys of type `K` and values of type `V`.
+
+/// Never access the fields directly, use the functions instead!
+
+typedef struct HashMap(K, V) {
+    // bucket_mask + 1 + _HASHMAP_GROUP_WIDTH control bytes; the last
+    // _HASHMAP_GROUP_WIDTH mirror the first ones, so that a group can
+    // be loaded starting at any bucket
+    u8 *ctrl;
+    HashMapEntry(K, V) *entries;
+    // The number of buckets - 1, or 0 if none are allocated
+    size_t bucket_mask;
+    size_t len;
+    // The number of entries that can be added before growing
+    size_t growth_left;
+} HashMap(K, V);
+
+
+/// Create a new, empty hash map. Does not allocate memory until the
+/// first entry is inserted.
+
+static UNUSED
+HashMap(K, V) XCAT(new_, HashMap(K, V))() {
+    return (HashMap(K, V)) {
+        .ctrl = (u8*)_hashmap_empty_ctrl,
+        .entries = NULL,
+        .bucket_mask = 0,
+        .len = 0,
+        .growth_left = 0
+    };
+}
+
+static
+size_t XCAT(_num_buckets_, HashMap(K, V))(const HashMap(K, V) *self) {
+    return self->bucket_mask ? self->bucket_mask + 1 : 0;
+}
+
+/// Remove from existence, along with the owned keys and values.
+
+static UNUSED
+void XCAT(drop_, HashMap(K, V))(HashMap(K, V) self) {
+    size_t num_buckets = XCAT(_num_buckets_, HashMap(K, V))(&self);
+    if (num_buckets) {
+        for (size_t i = 0; i < num_buckets; i++) {
+            if (! (self.ctrl[i] & 0x80)) {
+                XCAT(drop_, HashMapEntry(K, V))(self.entries[i]);
+            }
+        }
+        xfree(self.ctrl);
+        xfree(self.entries);
+    }
+}
+
+/// The number of entries in the map.
+
+static UNUSED
+size_t XCAT(len_, HashMap(K, V))(const HashMap(K, V) *self) {
+    return self->len;
+}
+
+/// Whether the map has no entries.
+
+static UNUSED
+bool XCAT(is_empty_, HashMap(K, V))(const HashMap(K, V) *self) {
+    return self->len == 0;
+}
+
+/// The number of entries the map can hold without allocating more
+/// memory.
+
+static UNUSED
+size_t XCAT(capacity_, HashMap(K, V))(const HashMap(K, V) *self) {
+    return self->len + self->growth_left;
+}
+
+static
+void XCAT(_set_ctrl_, HashMap(K, V))(HashMap(K, V) *self, size_t i, u8 c) {
+    self->ctrl[i] = c;
+    self->ctrl[((i - _HASHMAP_GROUP_WIDTH) & self->bucket_mask)
+               + _HASHMAP_GROUP_WIDTH] = c;
+}
+
+// The bucket holding `key`, or SIZE_MAX.
+static
+size_t XCAT(_find_, HashMap(K, V))(const HashMap(K, V) *self,
+                                   const K *key, u64 hash) {
+    u8 h2 = _hashmap_h2(hash);
+    _HashMapProbe probe = _hashmap_probe_start(hash, self->bucket_mask);
+    while (true) {
+        const u8 *group = &self->ctrl[probe.pos];
+        uint32_t matches = _hashmap_match_byte(group, h2);
+        while (matches) {
+            size_t i = (probe.pos + __builtin_ctz(matches)) & self->bucket_mask;
+            if (XCAT(equal_, K)(&self->entries[i].key, key)) {
+                return i;
+            }
+            matches &= matches - 1;
+        }
+        if (_hashmap_match_empty(group)) {
+            return SIZE_MAX;
+        }
+        _hashmap_probe_next(&probe, self->bucket_mask);
+    }
+}
+
+// The first empty or deleted bucket in the probe sequence for
+// `hash`. There must be buckets allocated.
+static
+size_t XCAT(_find_insert_slot_, HashMap(K, V))(const HashMap(K, V) *self,
+                                               u64 hash) {
+    _HashMapProbe probe = _hashmap_probe_start(hash, self->bucket_mask);
+    while (true) {
+        uint32_t avail = _hashmap_match_empty_or_deleted(&self->ctrl[probe.pos]);
+        if (avail) {
+            return (probe.pos + __builtin_ctz(avail)) & self->bucket_mask;
+        }
+        _hashmap_probe_next(&probe, self->bucket_mask);
+    }
+}
+
+// Move all entries into a new allocation with room for `capacity`
+// entries (which must be at least `len`). This also gets rid of
+// deleted buckets.
+static
+void XCAT(_resize_, HashMap(K, V))(HashMap(K, V) *self, size_t capacity) {
+    size_t num_buckets = _hashmap_buckets_for_capacity(capacity);
+    HashMap(K, V) new = {
+        .ctrl = xmalloc(num_buckets + _HASHMAP_GROUP_WIDTH),
+        .entries = xmallocarray(num_buckets, sizeof(HashMapEntry(K, V))),
+        .bucket_mask = num_buckets - 1,
+        .len = self->len,
+        .growth_left = _hashmap_capacity_for_buckets(num_buckets) - self->len
+    };
+    memset(new.ctrl, _HASHMAP_EMPTY, num_buckets + _HASHMAP_GROUP_WIDTH);
+
+    size_t old_num_buckets = XCAT(_num_buckets_, HashMap(K, V))(self);
+    for (size_t i = 0; i < old_num_buckets; i++) {
+        if (! (self->ctrl[i] & 0x80)) {
+            HashMapEntry(K, V) *entry = &self->entries[i];
+            u64 hash = XCAT(hash_, K)(&entry->key);
+            size_t j = XCAT(_find_insert_slot_, HashMap(K, V))(&new, hash);
+            XCAT(_set_ctrl_, HashMap(K, V))(&new, j, _hashmap_h2(hash));
+            new.entries[j] = *entry;
+        }
+    }
+    if (old_num_buckets) {
+        xfree(self->ctrl);
+        xfree(self->entries);
+    }
+    *self = new;
+}
+
+/// Make sure that at least `additional` more entries can be inserted
+/// without allocating.
+
+static UNUSED
+void XCAT(reserve_, HashMap(K, V))(HashMap(K, V) *self, size_t additional) {
+    if (additional <= self->growth_left) {
+        return;
+    }
+    size_t new_len = self->len + additional;
+    if (new_len < self->len) {
+        DIE("HashMap: capacity overflow");
+    }
+    size_t full_capacity = _hashmap_capacity_for_buckets(
+        XCAT(_num_buckets_, HashMap(K, V))(self));
+    if (new_len <= full_capacity / 2) {
+        // Mostly deleted buckets: clean up at the same size
+        XCAT(_resize_, HashMap(K, V))(self, full_capacity);
+    } else {
+        XCAT(_resize_, HashMap(K, V))(self, MAX(new_len, full_capacity + 1));
+    }
+}
+
+/// Create a new, empty hash map that can hold at least `capacity`
+/// entries without allocating.
+
+static UNUSED
+HashMap(K, V) XCAT(with_capacity_, HashMap(K, V))(size_t capacity) {
+    HashMap(K, V) self = XCAT(new_, HashMap(K, V))();
+    XCAT(reserve_, HashMap(K, V))(&self, capacity);
+    return self;
+}
+
+/// Get a reference to the value stored under `key`, or none if
+/// there is no such entry. The reference is only valid until the
+/// map is modified.
+
+static UNUSED
+Option(ref(V)) XCAT(get_, HashMap(K, V))(const HashMap(K, V) *self,
+                                         const K *key) {
+    size_t i = XCAT(_find_, HashMap(K, V))(self, key, XCAT(hash_, K)(key));
+    if (i == SIZE_MAX) {
+        return XCAT(none_, ref(V))();
+    } else {
+        return XCAT(some_, ref(V))(&self->entries[i].value);
+    }
+}
+
+/// Whether there is an entry for `key`.
+
+static UNUSED
+bool XCAT(contains_key_, HashMap(K, V))(const HashMap(K, V) *self,
+                                        const K *key) {
+    return XCAT(_find_, HashMap(K, V))(self, key, XCAT(hash_, K)(key))
+        != SIZE_MAX;
+}
+
+/// Store `value` under `key`, both are consumed. If there already was
+/// an entry for `key`, its value is replaced and returned (and the
+/// `key` passed in is dropped, the map keeps the original one);
+/// otherwise, returns none.
+
+static UNUSED
+Option(V) XCAT(insert_, HashMap(K, V))(HashMap(K, V) *self, K key, V value) {
+    u64 hash = XCAT(hash_, K)(&key);
+    size_t i = XCAT(_find_, HashMap(K, V))(self, &key, hash);
+    if (i != SIZE_MAX) {
+        V old = self->entries[i].value;
+        self->entries[i].value = value;
+        XCAT(drop_, K)(key);
+        return XCAT(some_, V)(old);
+    }
+
+    if (self->growth_left == 0) {
+        // Re-using a deleted bucket would be fine, but this is
+        // simpler and the growth policy covers it
+        XCAT(reserve_, HashMap(K, V))(self, 1);
+    }
+    i = XCAT(_find_insert_slot_, HashMap(K, V))(self, hash);
+    if (self->ctrl[i] == _HASHMAP_EMPTY) {
+        self->growth_left--;
+    }
+    XCAT(_set_ctrl_, HashMap(K, V))(self, i, _hashmap_h2(hash));
+    self->entries[i] = (HashMapEntry(K, V)) { .key = key, .value = value };
+    self->len++;
+    return XCAT(none_, V)();
+}
+
+/// Remove the entry for `key` and return its value, or none if there
+/// is no such entry. The key stored in the map is dropped.
+
+static UNUSED
+Option(V) XCAT(remove_, HashMap(K, V))(HashMap(K, V) *self, const K *key) {
+    size_t i = XCAT(_find_, HashMap(K, V))(self, key, XCAT(hash_, K)(key));
+    if (i == SIZE_MAX) {
+        return XCAT(none_, V)();
+    }
+    HashMapEntry(K, V) entry = self->entries[i];
+
+    // If there is an empty bucket in every group of
+    // _HASHMAP_GROUP_WIDTH buckets that contains bucket i, no lookup
+    // can have probed past it, and it can be marked empty. Otherwise
+    // it needs to be marked as deleted, so that lookups continue.
+    size_t before = (i - _HASHMAP_GROUP_WIDTH) & self->bucket_mask;
+    uint32_t empty_before = _hashmap_match_empty(&self->ctrl[before]);
+    uint32_t empty_after = _hashmap_match_empty(&self->ctrl[i]);
+    // (the number of non-empty buckets right before i, and from i on)
+    int full_before = __builtin_clz((empty_before << 16) | 0x8000);
+    int full_after = __builtin_ctz(empty_after | 0x10000);
+    if (full_before + full_after >= _HASHMAP_GROUP_WIDTH) {
+        XCAT(_set_ctrl_, HashMap(K, V))(self, i, _HASHMAP_DELETED);
+    } else {
+        XCAT(_set_ctrl_, HashMap(K, V))(self, i, _HASHMAP_EMPTY);
+        self->growth_left++;
+    }
+    self->len--;
+
+    XCAT(drop_, K)(entry.key);
+    return XCAT(some_, V)(entry.value);
+}
+
+/// Remove all entries, keeping the allocated memory.
+
+static UNUSED
+void XCAT(clear_, HashMap(K, V))(HashMap(K, V) *self) {
+    size_t num_buckets = XCAT(_num_buckets_, HashMap(K, V))(self);
+    if (num_buckets == 0) {
+        return;
+    }
+    for (size_t i = 0; i < num_buckets; i++) {
+        if (! (self->ctrl[i] & 0x80)) {
+            XCAT(drop_, HashMapEntry(K, V))(self->entries[i]);
+        }
+    }
+    memset(self->ctrl, _HASHMAP_EMPTY, num_buckets + _HASHMAP_GROUP_WIDTH);
+    self->len = 0;
+    self->growth_left = _hashmap_capacity_for_buckets(num_buckets);
+}
+
+
+/// An iterator over the entries of a map, see `iter_HashMap`.
+
+typedef struct HashMapIter(K, V) {
+    const HashMap(K, V) *map;
+    size_t pos;
+} HashMapIter(K, V);
+
+static UNUSED
+void XCAT(drop_, HashMapIter(K, V))(UNUSED HashMapIter(K, V) self) { }
+
+/// Get an iterator over the entries of the map, in no particular
+/// order. The map must not be modified while the iterator is in use.
+
+static UNUSED
+HashMapIter(K, V) XCAT(iter_, HashMap(K, V))(const HashMap(K, V) *self) {
+    return (HashMapIter(K, V)) {
+        .map = self,
+        .pos = 0
+    };
+}
+
+/// Get a reference to the next entry, or none if all have been
+/// visited.
+
+static UNUSED
+Option(ref(HashMapEntry(K, V))) XCAT(next_, HashMapIter(K, V))(
+    HashMapIter(K, V) *self) {
+    const HashMap(K, V) *map = self->map;
+    size_t num_buckets = XCAT(_num_buckets_, HashMap(K, V))(map);
+    while (self->pos < num_buckets) {
+        uint32_t full = _hashmap_match_full(&map->ctrl[self->pos]);
+        if (full) {
+            size_t i = self->pos + __builtin_ctz(full);
+            if (i < num_buckets) {
+                self->pos = i + 1;
+                return XCAT(some_, ref(HashMapEntry(K, V)))(&map->entries[i]);
+            }
+            // (a mirrored control byte)
+            break;
+        }
+        self->pos += _HASHMAP_GROUP_WIDTH;
+    }
+    self->pos = num_buckets;
+    return XCAT(none_, ref(HashMapEntry(K, V)))();
+}
+
+
+/// Whether the two maps have the same keys with equal values.
+
+static UNUSED
+bool XCAT(equal_, HashMap(K, V))(const HashMap(K, V) *a,
+                                 const HashMap(K, V) *b) {
+    if (a->len != b->len) {
+        return false;
+    }
+    HashMapIter(K, V) it = XCAT(iter_, HashMap(K, V))(a);
+    while_let_Some(entry, XCAT(next_, HashMapIter(K, V))(&it)) {
+        if_let_Some(bvalue, XCAT(get_, HashMap(K, V))(b, &entry->key)) {
+            if (! XCAT(equal_, V)(&entry->value, bvalue)) {
+                return false;
+            }
+        } else_None {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Print in a `{key: value, ...}` syntax, in the order of iteration.
+
+static UNUSED
+int XCAT(print_debug_, HashMap(K, V))(const HashMap(K, V) *self) {
+    INIT_RESRET;
+    RESRET(print_move_cstr("{"));
+    HashMapIter(K, V) it = XCAT(iter_, HashMap(K, V))(self);
+    bool first = true;
+    while_let_Some(entry, XCAT(next_, HashMapIter(K, V))(&it)) {
+        if (! first) {
+            RESRET(print_move_cstr(", "));
+        }
+        first = false;
+        RESRET(XCAT(print_debug_, HashMapEntry(K, V))(entry));
+    }
+    RESRET(print_move_cstr("}"));
+cleanup:
+    return ret;
+}
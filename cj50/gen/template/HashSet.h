@@ -0,0 +1,168 @@
+// parameters: T
+
+//! Part of the [`cj50/gen/HashSet.h`](../HashSet.h.md) library: the
+//! parts instantiated once per HashSet parametrization.
+
+#define K T
+#define V Unit
+#include <cj50/gen/template/HashMap.h>
+#undef V
+#undef K
+
+
+/// A hash set owning values of type `T`.
+
+/// Never access the field directly, use the functions instead!
+
+typedef struct HashSet(T) {
+    HashMap(T, Unit) map;
+} HashSet(T);
+
+/// Create a new, empty hash set. Does not allocate memory until the
+/// first value is inserted.
+
+static UNUSED
+HashSet(T) XCAT(new_, HashSet(T))() {
+    return (HashSet(T)) { .map = XCAT(new_, HashMap(T, Unit))() };
+}
+
+/// Create a new, empty hash set that can hold at least `capacity`
+/// values without allocating.
+
+static UNUSED
+HashSet(T) XCAT(with_capacity_, HashSet(T))(size_t capacity) {
+    return (HashSet(T)) {
+        .map = XCAT(with_capacity_, HashMap(T, Unit))(capacity)
+    };
+}
+
+/// Remove from existence, along with the owned values.
+
+static UNUSED
+void XCAT(drop_, HashSet(T))(HashSet(T) self) {
+    XCAT(drop_, HashMap(T, Unit))(self.map);
+}
+
+/// The number of values in the set.
+
+static UNUSED
+size_t XCAT(len_, HashSet(T))(const HashSet(T) *self) {
+    return self->map.len;
+}
+
+/// Whether the set has no values.
+
+static UNUSED
+bool XCAT(is_empty_, HashSet(T))(const HashSet(T) *self) {
+    return self->map.len == 0;
+}
+
+/// Make sure that at least `additional` more values can be inserted
+/// without allocating.
+
+static UNUSED
+void XCAT(reserve_, HashSet(T))(HashSet(T) *self, size_t additional) {
+    XCAT(reserve_, HashMap(T, Unit))(&self->map, additional);
+}
+
+/// Remove all values, keeping the allocated memory.
+
+static UNUSED
+void XCAT(clear_, HashSet(T))(HashSet(T) *self) {
+    XCAT(clear_, HashMap(T, Unit))(&self->map);
+}
+
+/// Add `value` to the set, consuming it. Returns `true` if it was
+/// not present yet; otherwise, `value` is dropped (the set keeps the
+/// equal value it already has) and `false` is returned.
+
+static UNUSED
+bool XCAT(insert_, HashSet(T))(HashSet(T) *self, T value) {
+    return ! XCAT(insert_, HashMap(T, Unit))(&self->map, value, Unit()).is_some;
+}
+
+/// Whether `value` is in the set.
+
+static UNUSED
+bool XCAT(contains_, HashSet(T))(const HashSet(T) *self, const T *value) {
+    return XCAT(contains_key_, HashMap(T, Unit))(&self->map, value);
+}
+
+/// Get a reference to the value in the set that is equal to `value`,
+/// or none. The reference is only valid until the set is modified.
+
+static UNUSED
+Option(ref(T)) XCAT(get_, HashSet(T))(const HashSet(T) *self, const T *value) {
+    size_t i = XCAT(_find_, HashMap(T, Unit))(&self->map, value,
+                                              XCAT(hash_, T)(value));
+    if (i == SIZE_MAX) {
+        return XCAT(none_, ref(T))();
+    } else {
+        return XCAT(some_, ref(T))(&self->map.entries[i].key);
+    }
+}
+
+/// Remove `value` from the set (dropping the value the set holds).
+/// Returns whether it was present.
+
+static UNUSED
+bool XCAT(remove_, HashSet(T))(HashSet(T) *self, const T *value) {
+    return XCAT(remove_, HashMap(T, Unit))(&self->map, value).is_some;
+}
+
+
+/// An iterator over the values of a set, see `iter_HashSet`.
+
+typedef struct HashSetIter(T) {
+    HashMapIter(T, Unit) iter;
+} HashSetIter(T);
+
+static UNUSED
+void XCAT(drop_, HashSetIter(T))(UNUSED HashSetIter(T) self) { }
+
+/// Get an iterator over the values of the set, in no particular
+/// order. The set must not be modified while the iterator is in use.
+
+static UNUSED
+HashSetIter(T) XCAT(iter_, HashSet(T))(const HashSet(T) *self) {
+    return (HashSetIter(T)) { .iter = XCAT(iter_, HashMap(T, Unit))(&self->map) };
+}
+
+/// Get a reference to the next value, or none if all have been
+/// visited.
+
+static UNUSED
+Option(ref(T)) XCAT(next_, HashSetIter(T))(HashSetIter(T) *self) {
+    if_let_Some(entry, XCAT(next_, HashMapIter(T, Unit))(&self->iter)) {
+        return XCAT(some_, ref(T))(&entry->key);
+    } else_None {
+        return XCAT(none_, ref(T))();
+    }
+}
+
+/// Whether the two sets contain equal values.
+
+static UNUSED
+bool XCAT(equal_, HashSet(T))(const HashSet(T) *a, const HashSet(T) *b) {
+    return XCAT(equal_, HashMap(T, Unit))(&a->map, &b->map);
+}
+
+/// Print in a `{value, ...}` syntax, in the order of iteration.
+
+static UNUSED
+int XCAT(print_debug_, HashSet(T))(const HashSet(T) *self) {
+    INIT_RESRET;
+    RESRET(print_move_cstr("{"));
+    HashSetIter(T) it = XCAT(iter_, HashSet(T))(self);
+    bool first = true;
+    while_let_Some(value, XCAT(next_, HashSetIter(T))(&it)) {
+        if (! first) {
+            RESRET(print_move_cstr(", "));
+        }
+        first = false;
+        RESRET(XCAT(print_debug_, T)(value));
+    }
+    RESRET(print_move_cstr("}"));
+cleanup:
+    return ret;
+}
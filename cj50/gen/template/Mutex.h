@@ -1,12 +1,21 @@
-// parameters: T
+// parameters: T, optional: MUTEX_RECURSIVE
 
 #include <pthread.h>
 #include <cj50/gen/Mutex.h>
+#include <cj50/Condvar.h>
 
 
 //! A `Mutex` embeds a value of type `T`, and protects access to it,
 //! so that only one thread ever accesses it at the same time.
 
+//! A thread must not lock a `Mutex` again while it is holding a
+//! `MutexGuard` for it already (this would hang forever; with
+//! `__CJ50_Mutex_debug` enabled, the program is stopped with an
+//! error instead). If `MUTEX_RECURSIVE` is defined when
+//! instantiating the template, that is allowed, at the cost of
+//! slower locking. Also see `RwLock` for data that is mostly read,
+//! and `AdaptiveMutex` for very short accesses.
+
 //! Example:
 
 /// ```C
@@ -54,14 +63,22 @@ typedef struct Mutex(T) {
 
 static UNUSED
 Mutex(T) XCAT(new_, Mutex(T))(T val) {
-    // PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP would be so easy; but,
-    // _NP = non-portable, probably needs _GNU_SOURCE.
     Mutex(T) m;
     m.__private_data = val;
     pthread_mutexattr_t att;
     pthread_mutexattr_init(&att);
-    // comment out following line for ~30% faster, but less safe mutexes
-    assert(pthread_mutexattr_settype(&att, PTHREAD_MUTEX_RECURSIVE_NP) == 0);
+#ifdef MUTEX_RECURSIVE
+    int type = PTHREAD_MUTEX_RECURSIVE;
+#else
+    // The error checking variant detects locking twice from the same
+    // thread, but is a bit slower
+    int type = __CJ50_Mutex_debug ? PTHREAD_MUTEX_ERRORCHECK
+        : PTHREAD_MUTEX_NORMAL;
+#endif
+    int err = pthread_mutexattr_settype(&att, type);
+    if (err) {
+        DIE_("pthread_mutexattr_settype: %s", strerror(err));
+    }
     pthread_mutex_init(&m.__private_sys_mutex, &att);
     pthread_mutexattr_destroy(&att); // noop in linux glibc
     return m;
@@ -118,7 +135,7 @@ MutexGuard(T) XCAT(lock_, Mutex(T))(Mutex(T) *self) {
 static UNUSED
 void XCAT(drop_, MutexGuard(T))(MutexGuard(T) self) {
     if (self.__private_possibly_leaktest) {
-        free(self.__private_possibly_leaktest);
+        xfree(self.__private_possibly_leaktest);
     }
     int err = pthread_mutex_unlock(&self.__private_mutex->__private_sys_mutex);
     if (err) {
@@ -144,3 +161,51 @@ T* XCAT(deref_mut_, MutexGuard(T))(const MutexGuard(T) *self) {
     return &self->__private_mutex->__private_data;
 }
 
+
+// ------------------------------------------------------------------
+// Waiting on a `Condvar`, see [`cj50/Condvar.h`](../../Condvar.h.md).
+
+/// Unlock the mutex that `guard` holds and sleep until the condition
+/// variable `cv` is notified (or a spurious wakeup happens), then
+/// lock the mutex again and return the guard.
+
+static UNUSED
+MutexGuard(T) XCAT(wait_Condvar_, MutexGuard(T))(Condvar *cv,
+                                                  MutexGuard(T) guard) {
+    _wait_Condvar(cv, &guard.__private_mutex->__private_sys_mutex);
+    return guard;
+}
+
+typedef struct WaitTimeout(T) {
+    MutexGuard(T) guard;
+    bool timed_out;
+} WaitTimeout(T);
+
+/// Like `wait_Condvar_MutexGuard_T`, but stop waiting after the
+/// duration `timeout`, in which case `.timed_out` in the result is
+/// true. Either way, `.guard` holds the lock again.
+
+static UNUSED
+WaitTimeout(T) XCAT(wait_timeout_Condvar_, MutexGuard(T))(
+    Condvar *cv, MutexGuard(T) guard, struct timespec timeout)
+{
+    struct timespec deadline = _deadline_Condvar(timeout);
+    bool woken = _wait_until_Condvar(
+        cv, &guard.__private_mutex->__private_sys_mutex, &deadline);
+    return (WaitTimeout(T)) { .guard = guard, .timed_out = !woken };
+}
+
+/// Wait on `cv` for as long as `condition(data, ctx)` returns true,
+/// where `data` is the value protected by the mutex. Returns the
+/// guard, with `condition` being false.
+
+static UNUSED
+MutexGuard(T) XCAT(wait_while_Condvar_, MutexGuard(T))(
+    Condvar *cv, MutexGuard(T) guard,
+    bool (*condition)(T *data, void *ctx), void *ctx)
+{
+    while (condition(XCAT(deref_mut_, MutexGuard(T))(&guard), ctx)) {
+        guard = XCAT(wait_Condvar_, MutexGuard(T))(cv, guard);
+    }
+    return guard;
+}
@@ -0,0 +1,155 @@
+// parameters: T
+
+#include <pthread.h>
+#include <cj50/gen/RwLock.h>
+
+
+//! Part of the [`cj50/gen/RwLock.h`](../RwLock.h.md) library.
+
+//! Example:
+
+/// ```C
+/// #include <cj50/instantiations/RwLock_int.h>
+///
+/// RwLock(int) lock = new_RwLock_int(1);
+///
+/// // in any number of threads at the same time:
+/// RwLockReadGuard(int) r = read_RwLock_int(&lock);
+/// printf("%i\n", *deref_RwLockReadGuard_int(&r));
+/// drop_RwLockReadGuard_int(r);
+///
+/// // waits until no other thread holds a guard:
+/// RwLockWriteGuard(int) w = write_RwLock_int(&lock);
+/// (*deref_mut_RwLockWriteGuard_int(&w))++;
+/// drop_RwLockWriteGuard_int(w);
+/// ```
+
+typedef struct RwLock(T) {
+    pthread_rwlock_t __private_sys_rwlock;
+    T __private_data; // never access directly, use `read`/`write` instead!
+} RwLock(T);
+
+/// Create a new lock, protecting `val`, which becomes owned by the
+/// `RwLock`.
+
+/// Threads waiting to write take precedence over threads that start
+/// reading, so that writers don't wait forever if the data is read
+/// continuously.
+
+static UNUSED
+RwLock(T) XCAT(new_, RwLock(T))(T val) {
+    RwLock(T) l;
+    l.__private_data = val;
+    pthread_rwlockattr_t att;
+    pthread_rwlockattr_init(&att);
+    pthread_rwlockattr_setkind_np(
+        &att, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&l.__private_sys_rwlock, &att);
+    pthread_rwlockattr_destroy(&att);
+    return l;
+}
+
+static UNUSED
+void XCAT(drop_, RwLock(T))(RwLock(T) self) {
+    pthread_rwlock_destroy(&self.__private_sys_rwlock);
+    XCAT(drop_, T)(self.__private_data);
+}
+
+/// Gives read access to the data protected by an `RwLock`, until
+/// dropped.
+
+typedef struct RwLockReadGuard(T) {
+    RwLock(T) *__private_lock;
+    // Allocation used only to have ASAN report on usage errors:
+    void *__private_possibly_leaktest;
+} RwLockReadGuard(T);
+
+/// Gives read and write access to the data protected by an `RwLock`,
+/// until dropped.
+
+typedef struct RwLockWriteGuard(T) {
+    RwLock(T) *__private_lock;
+    // Allocation used only to have ASAN report on usage errors:
+    void *__private_possibly_leaktest;
+} RwLockWriteGuard(T);
+
+/// Get read access, waiting while another thread has (or is waiting
+/// for) write access. Must not be called by a thread that already
+/// holds a guard for the same lock. The access ends when dropping
+/// the returned guard (see `lock_Mutex_T` for the debugging help
+/// with forgotten guards).
+
+static UNUSED
+RwLockReadGuard(T) XCAT(read_, RwLock(T))(RwLock(T) *self) {
+    int err = pthread_rwlock_rdlock(&self->__private_sys_rwlock);
+    if (err) {
+        DIE_("pthread_rwlock_rdlock: %s", strerror(err));
+    }
+    return (RwLockReadGuard(T)) {
+        .__private_lock = self,
+        .__private_possibly_leaktest = __CJ50_Mutex_debug ? xmalloc(1) : NULL
+    };
+}
+
+/// Get exclusive read and write access, waiting until no other
+/// thread holds a guard. Must not be called by a thread that already
+/// holds a guard for the same lock.
+
+static UNUSED
+RwLockWriteGuard(T) XCAT(write_, RwLock(T))(RwLock(T) *self) {
+    int err = pthread_rwlock_wrlock(&self->__private_sys_rwlock);
+    if (err) {
+        DIE_("pthread_rwlock_wrlock: %s", strerror(err));
+    }
+    return (RwLockWriteGuard(T)) {
+        .__private_lock = self,
+        .__private_possibly_leaktest = __CJ50_Mutex_debug ? xmalloc(1) : NULL
+    };
+}
+
+// Release a read or write lock.
+static
+void XCAT(_unlock_, RwLock(T))(RwLock(T) *self, void *leaktest) {
+    if (leaktest) {
+        xfree(leaktest);
+    }
+    int err = pthread_rwlock_unlock(&self->__private_sys_rwlock);
+    if (err) {
+        DIE_("pthread_rwlock_unlock: %s", strerror(err));
+    }
+}
+
+static UNUSED
+void XCAT(drop_, RwLockReadGuard(T))(RwLockReadGuard(T) self) {
+    XCAT(_unlock_, RwLock(T))(self.__private_lock,
+                              self.__private_possibly_leaktest);
+}
+
+static UNUSED
+void XCAT(drop_, RwLockWriteGuard(T))(RwLockWriteGuard(T) self) {
+    XCAT(_unlock_, RwLock(T))(self.__private_lock,
+                              self.__private_possibly_leaktest);
+}
+
+/// Get read-only access to the protected data. The reference must
+/// not be used after the guard is dropped.
+
+static UNUSED
+const T* XCAT(deref_, RwLockReadGuard(T))(const RwLockReadGuard(T) *self) {
+    return &self->__private_lock->__private_data;
+}
+
+/// Same as `deref_RwLockReadGuard_T`, for write guards.
+
+static UNUSED
+const T* XCAT(deref_, RwLockWriteGuard(T))(const RwLockWriteGuard(T) *self) {
+    return &self->__private_lock->__private_data;
+}
+
+/// Get mutable access to the protected data. The reference must not
+/// be used after the guard is dropped.
+
+static UNUSED
+T* XCAT(deref_mut_, RwLockWriteGuard(T))(const RwLockWriteGuard(T) *self) {
+    return &self->__private_lock->__private_data;
+}
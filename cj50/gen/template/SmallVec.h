@@ -0,0 +1,253 @@
+// parameters: T, N, optional: IS_TRIVIAL_DROP (see template/Vec.h)
+
+//! Part of the [`cj50/gen/SmallVec.h`](../SmallVec.h.md) library: the
+//! parts instantiated once per SmallVec parametrization.
+
+//! Example:
+
+/// ```C
+/// SmallVec(int, 8) v = new_SmallVec_int_8();
+/// push_SmallVec_int_8(&v, 1);
+/// push_SmallVec_int_8(&v, 2);
+/// assert(!is_spilled_SmallVec_int_8(&v));
+/// slice(int) s = deref_SmallVec_int_8(&v);
+/// assert(*at_slice_int(&s, 1) == 2);
+/// drop_SmallVec_int_8(v);
+/// ```
+
+
+/// A SmallVec consists of the number of elements, the capacity, and
+/// either the elements themselves (as long as the capacity is `N`),
+/// or a pointer to a heap-allocated array holding them.
+
+/// Never access those fields directly, use accessor functions
+/// instead! (Unlike with `Vec`, the elements can't be found via a
+/// `ptr` field, as pointing into itself would break on moving the
+/// value.)
+
+typedef struct SmallVec(T, N) {
+    size_t len;
+    size_t cap;
+    union {
+        T items[N];
+        T *heap;
+    } data;
+} SmallVec(T, N);
+
+
+/// Construct a new, empty small vector (does not allocate).
+
+static UNUSED
+SmallVec(T, N) XCAT(new_, SmallVec(T, N))() {
+    SmallVec(T, N) self;
+    self.len = 0;
+    self.cap = N;
+    return self;
+}
+
+/// Whether the elements were moved to heap-allocated memory (happens
+/// when more than `N` elements are stored).
+
+static UNUSED
+bool XCAT(is_spilled_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return self->cap > N;
+}
+
+// Pointer to the elements.
+static inline
+T *XCAT(_ptr_, SmallVec(T, N))(SmallVec(T, N) *self) {
+    return (self->cap > N) ? self->data.heap : self->data.items;
+}
+
+static inline
+const T *XCAT(_const_ptr_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return (self->cap > N) ? self->data.heap : self->data.items;
+}
+
+/// Remove from existence, along with the owned elements.
+
+static UNUSED
+void XCAT(drop_, SmallVec(T, N))(SmallVec(T, N) self) {
+#ifndef IS_TRIVIAL_DROP
+    T *ptr = XCAT(_ptr_, SmallVec(T, N))(&self);
+    for (size_t i = 0; i < self.len; i++) {
+        XCAT(drop_, T)(ptr[i]);
+    }
+#endif
+    if (self.cap > N) {
+        xfree(self.data.heap);
+    }
+}
+
+/// The number of elements in the vector.
+
+static UNUSED
+size_t XCAT(len_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return self->len;
+}
+
+/// Whether the vector has no elements.
+
+static UNUSED
+bool XCAT(is_empty_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return self->len == 0;
+}
+
+/// The number of elements the vector can hold without allocating
+/// (more memory).
+
+static UNUSED
+size_t XCAT(capacity_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return self->cap;
+}
+
+/// Make sure that there is room for at least `additional` more
+/// elements, moving them to heap-allocated memory if needed.
+
+static UNUSED
+void XCAT(reserve_, SmallVec(T, N))(SmallVec(T, N) *self,
+                                    size_t additional) {
+    size_t len = self->len;
+    if (self->cap - len >= additional) {
+        return;
+    }
+    if (len > SIZE_MAX - additional) {
+        DIE("SmallVec: capacity overflow");
+    }
+    size_t cap = self->cap < SIZE_MAX / 2 ? self->cap * 2 : SIZE_MAX;
+    cap = MAX(cap, len + additional);
+    if (self->cap > N) {
+        self->data.heap = xreallocarray(self->data.heap, cap, sizeof(T));
+    } else {
+        T *heap = xmallocarray(cap, sizeof(T));
+        if (len) {
+            memcpy(heap, self->data.items, len * sizeof(T));
+        }
+        self->data.heap = heap;
+    }
+    self->cap = cap;
+}
+
+/// Construct a new, empty small vector with room for at least `cap`
+/// elements (only allocates if `cap` is larger than `N`).
+
+static UNUSED
+SmallVec(T, N) XCAT(with_capacity_, SmallVec(T, N))(size_t cap) {
+    SmallVec(T, N) self = XCAT(new_, SmallVec(T, N))();
+    XCAT(reserve_, SmallVec(T, N))(&self, cap);
+    return self;
+}
+
+/// Appends an element to the back of the vector.
+
+static UNUSED
+void XCAT(push_, SmallVec(T, N))(SmallVec(T, N) *self, T value) {
+    size_t len = self->len;
+    if (len == self->cap) {
+        XCAT(reserve_, SmallVec(T, N))(self, 1);
+    }
+    XCAT(_ptr_, SmallVec(T, N))(self)[len] = value;
+    self->len = len + 1;
+}
+
+/// Removes the last element from the vector and returns it, or None
+/// if it is empty. (Does not move the elements back into the
+/// `SmallVec` if it was spilled.)
+
+static UNUSED
+Option(T) XCAT(pop_, SmallVec(T, N))(SmallVec(T, N) *self) {
+    size_t len = self->len;
+    if (len > 0) {
+        self->len = len - 1;
+        return XCAT(some_, T)(XCAT(_ptr_, SmallVec(T, N))(self)[len - 1]);
+    } else {
+        return XCAT(none_, T)();
+    }
+}
+
+/// Appends copies of all the elements in `items` to the back of the
+/// vector (see `extend_from_slice_Vec_T` about element types that
+/// own resources).
+
+static UNUSED
+void XCAT(extend_from_slice_, SmallVec(T, N))(SmallVec(T, N) *self,
+                                              slice(T) items) {
+    size_t count = items.len;
+    if (count == 0) {
+        return;
+    }
+    XCAT(reserve_, SmallVec(T, N))(self, count);
+    memcpy(&XCAT(_ptr_, SmallVec(T, N))(self)[self->len], items.ptr,
+           count * sizeof(T));
+    self->len += count;
+}
+
+/// Removes all elements, keeping the capacity.
+
+static UNUSED
+void XCAT(clear_, SmallVec(T, N))(SmallVec(T, N) *self) {
+#ifndef IS_TRIVIAL_DROP
+    T *ptr = XCAT(_ptr_, SmallVec(T, N))(self);
+    for (size_t i = 0; i < self->len; i++) {
+        XCAT(drop_, T)(ptr[i]);
+    }
+#endif
+    self->len = 0;
+}
+
+/// Get a slice of the whole vector. It's borrowing from the vector,
+/// which must not be moved or modified while the slice is in use.
+
+static UNUSED
+slice(T) XCAT(deref_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    return XCAT(new_, slice(T))(XCAT(_const_ptr_, SmallVec(T, N))(self),
+                                self->len);
+}
+
+/// Get a mutable slice of the whole vector, see `deref_SmallVec_*`.
+
+static UNUSED
+mutslice(T) XCAT(deref_mut_, SmallVec(T, N))(SmallVec(T, N) *self) {
+    return XCAT(new_, mutslice(T))(XCAT(_ptr_, SmallVec(T, N))(self),
+                                   self->len);
+}
+
+/// Get a read-only reference to the element at position `i`. Aborts
+/// if `i` is behind the end of the vector.
+
+static UNUSED
+const T* XCAT(at_, SmallVec(T, N))(const SmallVec(T, N) *self, size_t i) {
+    assert(i < self->len);
+    return &XCAT(_const_ptr_, SmallVec(T, N))(self)[i];
+}
+
+/// Get a read-only reference to the element at position `i`, or None
+/// if `i` is behind the end of the vector.
+
+static UNUSED
+Option(ref(T)) XCAT(get_, SmallVec(T, N))(const SmallVec(T, N) *self,
+                                          size_t i) {
+    if (i < self->len) {
+        return XCAT(some_, ref(T))(&XCAT(_const_ptr_, SmallVec(T, N))(self)[i]);
+    } else {
+        return XCAT(none_, ref(T))();
+    }
+}
+
+/// Whether the two vectors have equal elements in every position.
+
+static UNUSED
+bool XCAT(equal_, SmallVec(T, N))(const SmallVec(T, N) *a,
+                                  const SmallVec(T, N) *b) {
+    slice(T) sa = XCAT(deref_, SmallVec(T, N))(a);
+    slice(T) sb = XCAT(deref_, SmallVec(T, N))(b);
+    return XCAT(equal_, slice(T))(&sa, &sb);
+}
+
+/// Print in C code syntax.
+
+static UNUSED
+int XCAT(print_debug_, SmallVec(T, N))(const SmallVec(T, N) *self) {
+    slice(T) s = XCAT(deref_, SmallVec(T, N))(self);
+    return XCAT(print_debug_, slice(T))(&s);
+}
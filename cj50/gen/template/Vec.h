@@ -1,8 +1,13 @@
-// parameters: T
+// parameters: T, optional: IS_TRIVIAL_DROP
 
 //! Part of the [`cj50/gen/Vec.h`](../Vec.h.md) library: the parts
 //! instantiated only once per Vec parametrization.
 
+//! If `IS_TRIVIAL_DROP` is defined when instantiating, `drop_T` must
+//! be a function that does nothing; the functions that drop elements
+//! (`drop`, `clear`, `truncate`) then don't call it, which saves
+//! going through all the elements.
+
 
 /// A `slice` consists of two fields, a pointer to an array, and the
 /// current length used out of that array. A slice is borrowing the
@@ -71,10 +76,12 @@ void XCAT(drop_, Vec(T))(Vec(T) self) {
     size_t len = self.len;
     T* ptr = self.ptr;
     if (ptr) {
+#ifndef IS_TRIVIAL_DROP
         for (size_t i = 0; i < len; i++) {
             XCAT(drop_, T)(ptr[i]);
         }
-        free(ptr);
+#endif
+        xfree(ptr);
     } else {
         assert(len == 0);
     }
@@ -127,18 +134,74 @@ Result(Unit, VecError) XCAT(push_within_capacity_, Vec(T))(
     }
 }
 
-/// Reserve space for `additional` more elements on top of the current
-/// capacity (not len).
+// Set the capacity to exactly `cap2` (which must not be smaller
+// than the current len).
+static
+void XCAT(_set_capacity_, Vec(T))(Vec(T) *self, size_t cap2) {
+    assert(cap2 >= self->len);
+    if (cap2 == 0) {
+        xfree(self->ptr);
+        self->ptr = NULL;
+    } else {
+        self->ptr = xreallocarray(self->ptr, cap2, sizeof(T));
+    }
+    self->cap = cap2;
+}
+
+// The number of elements needed to hold the current elements plus
+// `additional` more, aborting on overflow.
+static
+size_t XCAT(_needed_capacity_, Vec(T))(const Vec(T) *self,
+                                       size_t additional) {
+    size_t len = self->len;
+    size_t needed = len + additional;
+    if (needed < len) {
+        DIE("Vec: capacity overflow");
+    }
+    return needed;
+}
+
+/// Reserve capacity for at least `additional` more elements on top
+/// of the current len. Does nothing if the capacity is already
+/// sufficient. Otherwise the capacity is grown geometrically (at
+/// least doubled), so that repeatedly adding elements only costs
+/// amortized O(1) per element.
 static UNUSED
 void XCAT(reserve_, Vec(T))(Vec(T) *self, size_t additional) {
-    // Does the Rust version add `additional` to cap or to len?
-    // Actually cap, since RawVec doesn't even *have* len.
+    size_t needed = XCAT(_needed_capacity_, Vec(T))(self, additional);
     size_t cap = self->cap;
-    size_t cap2 = cap + additional;
-    assert(cap2 > cap);
-    void* ptr2 = xreallocarray(self->ptr, cap2, sizeof(T));
-    self->ptr = ptr2;
-    self->cap = cap2;
+    if (needed <= cap) {
+        return;
+    }
+    size_t cap2 = cap * 2;
+    if (cap2 < cap) {
+        // doubling overflowed, take what we need
+        cap2 = needed;
+    }
+    cap2 = max_size_t(cap2, max_size_t(needed, 8));
+    XCAT(_set_capacity_, Vec(T))(self, cap2);
+}
+
+/// Reserve capacity for exactly `additional` more elements on top of
+/// the current len. Does nothing if the capacity is already
+/// sufficient. Prefer `reserve` unless you know that no more elements
+/// will be added afterwards.
+static UNUSED
+void XCAT(reserve_exact_, Vec(T))(Vec(T) *self, size_t additional) {
+    size_t needed = XCAT(_needed_capacity_, Vec(T))(self, additional);
+    if (needed <= self->cap) {
+        return;
+    }
+    XCAT(_set_capacity_, Vec(T))(self, needed);
+}
+
+/// Shrink the capacity of the vector to its current len, releasing
+/// unused memory.
+static UNUSED
+void XCAT(shrink_to_fit_, Vec(T))(Vec(T) *self) {
+    if (self->cap > self->len) {
+        XCAT(_set_capacity_, Vec(T))(self, self->len);
+    }
 }
 
 /// Appends an element to the back of the vector.
@@ -152,8 +215,9 @@ void XCAT(push_, Vec(T))(Vec(T) *self, T value) {
         self->ptr[len] = value;
         self->len = len + 1;
     } else {
-        XCAT(reserve_, Vec(T))(self, max_size_t(8, self->cap));
-        assert(XCAT(push_within_capacity_, Vec(T))(self, value).is_ok);
+        XCAT(reserve_, Vec(T))(self, 1);
+        self->ptr[len] = value;
+        self->len = len + 1;
     }
 
 #else
@@ -161,7 +225,7 @@ void XCAT(push_, Vec(T))(Vec(T) *self, T value) {
     if (res.is_ok) {
         return;
     }
-    XCAT(reserve_, Vec(T))(self, max_size_t(8, self->cap));
+    XCAT(reserve_, Vec(T))(self, 1);
     unwrap_Result_Unit__VecError(
         XCAT(push_within_capacity_, Vec(T))(self, value));
     // ^ could just assert(res.is_ok) instead
@@ -184,17 +248,33 @@ Option(T) XCAT(pop_, Vec(T))(Vec(T) *self) {
 }
 
 
-/// Moves all the elements of `other` into `self`, leaving `other` empty.
+/// Appends copies of all the elements in `items` to the back of the
+/// vector, reallocating at most once and copying the items with a
+/// single `memcpy`.
+
+/// The elements are copied bitwise, so for element types that own
+/// resources (like `String` or `CStr`), the copies must not be
+/// dropped in both places; in that case use `append` or
+/// `append_move` instead.
+
 static UNUSED
-void XCAT(append_, Vec(T))(Vec(T) *self, Vec(T) *other) {
-    size_t count = other->len;
+void XCAT(extend_from_slice_, Vec(T))(Vec(T) *self, slice(T) items) {
+    size_t count = items.len;
+    if (count == 0) {
+        return;
+    }
     XCAT(reserve_, Vec(T))(self, count);
     size_t len = self->len;
-    size_t len2 = len + count;
-    assert(len2 > len);
-    // XX multiplication overflow check?
-    memcpy(&self->ptr[len], other->ptr, count * sizeof(T));
-    self->len = len2;
+    // (reserve_ already checked len + count for overflow, and
+    // xreallocarray the multiplication.)
+    memcpy(&self->ptr[len], items.ptr, count * sizeof(T));
+    self->len = len + count;
+}
+
+/// Moves all the elements of `other` into `self`, leaving `other` empty.
+static UNUSED
+void XCAT(append_, Vec(T))(Vec(T) *self, Vec(T) *other) {
+    XCAT(extend_from_slice_, Vec(T))(self, XCAT(deref_, Vec(T))(other));
     other->len = 0;
 }
 
@@ -215,13 +295,35 @@ void XCAT(clear_, Vec(T))(Vec(T) *self) {
     size_t len = self->len;
     T* ptr = self->ptr;
     if (ptr) {
+#ifndef IS_TRIVIAL_DROP
         for (size_t i = 0; i < len; i++) {
             XCAT(drop_, T)(ptr[i]);
         }
+#endif
     } else {
         assert(len == 0);
     }
     self->len = 0;
 }
 
+/// Shortens the vector to `len` elements, dropping the elements
+/// behind. Does nothing if the vector isn't longer than `len`.
+
+/// Like `clear`, this has no effect on the allocated capacity.
+
+static UNUSED
+void XCAT(truncate_, Vec(T))(Vec(T) *self, size_t len) {
+    size_t oldlen = self->len;
+    if (len >= oldlen) {
+        return;
+    }
+#ifndef IS_TRIVIAL_DROP
+    T* ptr = self->ptr;
+    for (size_t i = len; i < oldlen; i++) {
+        XCAT(drop_, T)(ptr[i]);
+    }
+#endif
+    self->len = len;
+}
+
 
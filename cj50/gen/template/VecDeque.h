@@ -0,0 +1,292 @@
+// parameters: T, optional: IS_TRIVIAL_DROP (see template/Vec.h)
+
+//! Part of the [`cj50/gen/VecDeque.h`](../VecDeque.h.md) library: the
+//! parts instantiated once per VecDeque parametrization.
+
+//! Example:
+
+/// ```C
+/// #include <cj50.h>
+/// #include <cj50/instantiations/VecDeque_int.h>
+///
+/// int main() {
+///     VecDeque(int) q = new_VecDeque_int();
+///     push_back_VecDeque_int(&q, 2);
+///     push_back_VecDeque_int(&q, 3);
+///     push_front_VecDeque_int(&q, 1);
+///     assert(unwrap(pop_front_VecDeque_int(&q)) == 1);
+///     assert(unwrap(pop_back_VecDeque_int(&q)) == 3);
+///     drop_VecDeque_int(q);
+/// }
+/// ```
+
+
+/// A VecDeque consists of a pointer to a heap-allocated array (of a
+/// power of two in size), the size of that array, the position of
+/// the first element, and the number of elements.
+
+/// Never mutate those fields directly, use accessor functions
+/// instead!
+
+typedef struct VecDeque(T) {
+    T *ptr;
+    size_t cap;
+    size_t head;
+    size_t len;
+} VecDeque(T);
+
+/// The contents of a `VecDeque(T)`: the elements of `front` followed
+/// by the elements of `back`.
+
+typedef struct VecDequeSlices(T) {
+    slice(T) front;
+    slice(T) back;
+} VecDequeSlices(T);
+
+
+/// Construct a new, empty deque.
+
+static UNUSED
+VecDeque(T) XCAT(new_, VecDeque(T))() {
+    return (VecDeque(T)) {
+        .ptr = NULL,
+        .cap = 0,
+        .head = 0,
+        .len = 0
+    };
+}
+
+// The position in `ptr` of element `i`.
+static inline
+size_t XCAT(_physical_index_, VecDeque(T))(const VecDeque(T) *self, size_t i) {
+    return (self->head + i) & (self->cap - 1);
+}
+
+/// Remove from existence, along with the owned elements.
+
+static UNUSED
+void XCAT(drop_, VecDeque(T))(VecDeque(T) self) {
+#ifndef IS_TRIVIAL_DROP
+    for (size_t i = 0; i < self.len; i++) {
+        XCAT(drop_, T)(self.ptr[XCAT(_physical_index_, VecDeque(T))(&self, i)]);
+    }
+#endif
+    xfree(self.ptr);
+}
+
+/// The number of elements in the deque.
+
+static UNUSED
+size_t XCAT(len_, VecDeque(T))(const VecDeque(T) *self) {
+    return self->len;
+}
+
+/// Whether the deque has no elements.
+
+static UNUSED
+bool XCAT(is_empty_, VecDeque(T))(const VecDeque(T) *self) {
+    return self->len == 0;
+}
+
+/// The number of elements the deque can hold without allocating.
+
+static UNUSED
+size_t XCAT(capacity_, VecDeque(T))(const VecDeque(T) *self) {
+    return self->cap;
+}
+
+/// Reserve capacity for at least `additional` more elements on top
+/// of the current len. Does nothing if the capacity is already
+/// sufficient; otherwise, the capacity is grown to the next power of
+/// two that is large enough (and at least 8).
+
+static UNUSED
+void XCAT(reserve_, VecDeque(T))(VecDeque(T) *self, size_t additional) {
+    size_t len = self->len;
+    size_t needed = len + additional;
+    if (needed < len) {
+        DIE("VecDeque: capacity overflow");
+    }
+    size_t old_cap = self->cap;
+    if (needed <= old_cap) {
+        return;
+    }
+    size_t cap = max_size_t(old_cap, 8);
+    while (cap < needed) {
+        if (cap > SIZE_MAX / 2) {
+            DIE("VecDeque: capacity overflow");
+        }
+        cap *= 2;
+    }
+    self->ptr = xreallocarray(self->ptr, cap, sizeof(T));
+    self->cap = cap;
+    // If the elements wrapped around the end of the old buffer, move
+    // the wrapped part to after the old end (there is enough room, as
+    // the capacity at least doubled).
+    if (self->head + len > old_cap) {
+        size_t wrapped = self->head + len - old_cap;
+        memcpy(&self->ptr[old_cap], self->ptr, wrapped * sizeof(T));
+    }
+}
+
+/// Construct a new, empty deque with room for at least `cap`
+/// elements.
+
+static UNUSED
+VecDeque(T) XCAT(with_capacity_, VecDeque(T))(size_t cap) {
+    VecDeque(T) self = XCAT(new_, VecDeque(T))();
+    XCAT(reserve_, VecDeque(T))(&self, cap);
+    return self;
+}
+
+/// Add an element to the back of the deque.
+
+static UNUSED
+void XCAT(push_back_, VecDeque(T))(VecDeque(T) *self, T value) {
+    if (self->len == self->cap) {
+        XCAT(reserve_, VecDeque(T))(self, 1);
+    }
+    self->ptr[XCAT(_physical_index_, VecDeque(T))(self, self->len)] = value;
+    self->len++;
+}
+
+/// Add an element to the front of the deque.
+
+static UNUSED
+void XCAT(push_front_, VecDeque(T))(VecDeque(T) *self, T value) {
+    if (self->len == self->cap) {
+        XCAT(reserve_, VecDeque(T))(self, 1);
+    }
+    self->head = (self->head - 1) & (self->cap - 1);
+    self->ptr[self->head] = value;
+    self->len++;
+}
+
+/// Remove the last element and return it, or None if the deque is
+/// empty.
+
+static UNUSED
+Option(T) XCAT(pop_back_, VecDeque(T))(VecDeque(T) *self) {
+    if (self->len == 0) {
+        return XCAT(none_, T)();
+    }
+    self->len--;
+    return XCAT(some_, T)(
+        self->ptr[XCAT(_physical_index_, VecDeque(T))(self, self->len)]);
+}
+
+/// Remove the first element and return it, or None if the deque is
+/// empty.
+
+static UNUSED
+Option(T) XCAT(pop_front_, VecDeque(T))(VecDeque(T) *self) {
+    if (self->len == 0) {
+        return XCAT(none_, T)();
+    }
+    T value = self->ptr[self->head];
+    self->head = (self->head + 1) & (self->cap - 1);
+    self->len--;
+    return XCAT(some_, T)(value);
+}
+
+/// Get a read-only reference to the element at position `i` (0 being
+/// the front). Aborts if `i` is behind the end. If you are not sure
+/// if `i` is valid, use `get` instead.
+
+static UNUSED
+const T* XCAT(at_, VecDeque(T))(const VecDeque(T) *self, size_t i) {
+    assert(i < self->len);
+    return &self->ptr[XCAT(_physical_index_, VecDeque(T))(self, i)];
+}
+
+/// Get a read-only reference to the element at position `i` (0 being
+/// the front), or None if `i` is behind the end.
+
+static UNUSED
+Option(ref(T)) XCAT(get_, VecDeque(T))(const VecDeque(T) *self, size_t i) {
+    if (i < self->len) {
+        return XCAT(some_, ref(T))(
+            &self->ptr[XCAT(_physical_index_, VecDeque(T))(self, i)]);
+    } else {
+        return XCAT(none_, ref(T))();
+    }
+}
+
+/// Get a read-only reference to the first element, or None if the
+/// deque is empty.
+
+static UNUSED
+Option(ref(T)) XCAT(front_, VecDeque(T))(const VecDeque(T) *self) {
+    return XCAT(get_, VecDeque(T))(self, 0);
+}
+
+/// Get a read-only reference to the last element, or None if the
+/// deque is empty.
+
+static UNUSED
+Option(ref(T)) XCAT(back_, VecDeque(T))(const VecDeque(T) *self) {
+    return XCAT(get_, VecDeque(T))(self, self->len - 1);
+}
+
+/// Get the contents as two slices, without copying: all elements are
+/// in `front` followed by `back`. The slices are only valid as long
+/// as the deque is not modified.
+
+static UNUSED
+VecDequeSlices(T) XCAT(as_slices_, VecDeque(T))(const VecDeque(T) *self) {
+    size_t head = self->head;
+    size_t len = self->len;
+    size_t front_len = (head + len <= self->cap) ? len : self->cap - head;
+    return (VecDequeSlices(T)) {
+        .front = XCAT(new_slice_, T)(self->ptr ? self->ptr + head : NULL,
+                                     front_len),
+        .back = XCAT(new_slice_, T)(self->ptr, len - front_len)
+    };
+}
+
+/// Remove all elements; the capacity stays the same.
+
+static UNUSED
+void XCAT(clear_, VecDeque(T))(VecDeque(T) *self) {
+#ifndef IS_TRIVIAL_DROP
+    for (size_t i = 0; i < self->len; i++) {
+        XCAT(drop_, T)(self->ptr[XCAT(_physical_index_, VecDeque(T))(self, i)]);
+    }
+#endif
+    self->head = 0;
+    self->len = 0;
+}
+
+/// Whether the two deques have the same number of elements with
+/// equal elements in every position.
+
+static UNUSED
+bool XCAT(equal_, VecDeque(T))(const VecDeque(T) *a, const VecDeque(T) *b) {
+    if (a->len != b->len) {
+        return false;
+    }
+    for (size_t i = 0; i < a->len; i++) {
+        if (! XCAT(equal_, T)(XCAT(at_, VecDeque(T))(a, i),
+                              XCAT(at_, VecDeque(T))(b, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Print in C code syntax, front to back.
+
+static UNUSED
+int XCAT(print_debug_, VecDeque(T))(const VecDeque(T) *self) {
+    INIT_RESRET;
+    RESRET(print_move_cstr("{"));
+    for (size_t i = 0; i < self->len; i++) {
+        if (i > 0) {
+            RESRET(print_move_cstr(", "));
+        }
+        RESRET(XCAT(print_debug_, T)(XCAT(at_, VecDeque(T))(self, i)));
+    }
+    RESRET(print_move_cstr("}"));
+cleanup:
+    return ret;
+}
@@ -0,0 +1,206 @@
+// parameters: T, HEAP, ARITY
+
+//! Part of the [`cj50/gen/BinaryHeap.h`](../BinaryHeap.h.md) library:
+//! a max-heap with `ARITY` children per node, stored in a `Vec(T)`.
+//! The children of the element at index `i` are at `i * ARITY + 1` up
+//! to `i * ARITY + ARITY`.
+
+//! Example:
+
+/// ```C
+/// BinaryHeap(int) h = new_BinaryHeap_int();
+/// push_BinaryHeap_int(&h, 3);
+/// push_BinaryHeap_int(&h, 7);
+/// push_BinaryHeap_int(&h, 5);
+/// assert(*unwrap(peek_BinaryHeap_int(&h)) == 7);
+/// assert(unwrap(pop_BinaryHeap_int(&h)) == 7);
+/// Vec(int) sorted = into_sorted_Vec_BinaryHeap_int(h); // {3, 5}
+/// ```
+
+
+/// A heap consists of the `Vec` holding its elements in heap order.
+
+/// Never access the field directly, use the functions instead!
+
+typedef struct HEAP(T) {
+    Vec(T) vec;
+} HEAP(T);
+
+
+/// Construct a new, empty heap.
+
+static UNUSED
+HEAP(T) XCAT(new_, HEAP(T))() {
+    return (HEAP(T)) { .vec = XCAT(new_, Vec(T))() };
+}
+
+/// Construct a new, empty heap with room for at least `cap`
+/// elements.
+
+static UNUSED
+HEAP(T) XCAT(with_capacity_, HEAP(T))(size_t cap) {
+    return (HEAP(T)) { .vec = XCAT(with_capacity_, Vec(T))(cap) };
+}
+
+/// Remove from existence, along with the owned elements.
+
+static UNUSED
+void XCAT(drop_, HEAP(T))(HEAP(T) self) {
+    XCAT(drop_, Vec(T))(self.vec);
+}
+
+/// The number of elements in the heap.
+
+static UNUSED
+size_t XCAT(len_, HEAP(T))(const HEAP(T) *self) {
+    return self->vec.len;
+}
+
+/// Whether the heap has no elements.
+
+static UNUSED
+bool XCAT(is_empty_, HEAP(T))(const HEAP(T) *self) {
+    return self->vec.len == 0;
+}
+
+/// Remove all elements, keeping the allocated memory.
+
+static UNUSED
+void XCAT(clear_, HEAP(T))(HEAP(T) *self) {
+    XCAT(clear_, Vec(T))(&self->vec);
+}
+
+// Move the element at `pos` towards the root until its parent is
+// not smaller.
+static
+void XCAT(_sift_up_, HEAP(T))(T *ptr, size_t pos) {
+    T elem = ptr[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / ARITY;
+        if (XCAT(cmp_, T)(&elem, &ptr[parent]) <= 0) {
+            break;
+        }
+        ptr[pos] = ptr[parent];
+        pos = parent;
+    }
+    ptr[pos] = elem;
+}
+
+// Move the element at `pos` away from the root until none of its
+// children (among the first `len` elements) is larger.
+static
+void XCAT(_sift_down_, HEAP(T))(T *ptr, size_t len, size_t pos) {
+    T elem = ptr[pos];
+    while (true) {
+        size_t first = pos * ARITY + 1;
+        if (first >= len) {
+            break;
+        }
+        size_t end = (len - first < ARITY) ? len : first + ARITY;
+        size_t largest = first;
+        for (size_t c = first + 1; c < end; c++) {
+            if (XCAT(cmp_, T)(&ptr[c], &ptr[largest]) > 0) {
+                largest = c;
+            }
+        }
+        if (XCAT(cmp_, T)(&ptr[largest], &elem) <= 0) {
+            break;
+        }
+        ptr[pos] = ptr[largest];
+        pos = largest;
+    }
+    ptr[pos] = elem;
+}
+
+/// Add an element to the heap.
+
+static UNUSED
+void XCAT(push_, HEAP(T))(HEAP(T) *self, T value) {
+    XCAT(push_, Vec(T))(&self->vec, value);
+    XCAT(_sift_up_, HEAP(T))(self->vec.ptr, self->vec.len - 1);
+}
+
+/// Remove the largest element and return it, or None if the heap is
+/// empty.
+
+static UNUSED
+Option(T) XCAT(pop_, HEAP(T))(HEAP(T) *self) {
+    size_t len = self->vec.len;
+    if (len == 0) {
+        return XCAT(none_, T)();
+    }
+    T *ptr = self->vec.ptr;
+    T top = ptr[0];
+    len--;
+    self->vec.len = len;
+    if (len > 0) {
+        ptr[0] = ptr[len];
+        XCAT(_sift_down_, HEAP(T))(ptr, len, 0);
+    }
+    return XCAT(some_, T)(top);
+}
+
+/// Get a read-only reference to the largest element, or None if the
+/// heap is empty.
+
+static UNUSED
+Option(ref(T)) XCAT(peek_, HEAP(T))(const HEAP(T) *self) {
+    if (self->vec.len == 0) {
+        return XCAT(none_, ref(T))();
+    } else {
+        return XCAT(some_, ref(T))(&self->vec.ptr[0]);
+    }
+}
+
+/// Turn a vector into a heap, in O(n) time, consuming the vector.
+
+static UNUSED
+HEAP(T) XCAT(from_Vec_, HEAP(T))(Vec(T) vec) {
+    size_t len = vec.len;
+    if (len >= 2) {
+        size_t last_parent = (len - 2) / ARITY;
+        for (size_t i = last_parent + 1; i-- > 0; ) {
+            XCAT(_sift_down_, HEAP(T))(vec.ptr, len, i);
+        }
+    }
+    return (HEAP(T)) { .vec = vec };
+}
+
+/// Turn the heap into a vector, in no particular order, consuming
+/// the heap.
+
+static UNUSED
+Vec(T) XCAT(into_Vec_, HEAP(T))(HEAP(T) self) {
+    return self.vec;
+}
+
+/// Turn the heap into a vector sorted in ascending order, consuming
+/// the heap. Takes O(n log n) time, does not allocate.
+
+static UNUSED
+Vec(T) XCAT(into_sorted_Vec_, HEAP(T))(HEAP(T) self) {
+    T *ptr = self.vec.ptr;
+    for (size_t end = self.vec.len; end > 1; ) {
+        end--;
+        T tmp = ptr[0];
+        ptr[0] = ptr[end];
+        ptr[end] = tmp;
+        XCAT(_sift_down_, HEAP(T))(ptr, end, 0);
+    }
+    return self.vec;
+}
+
+/// Get the elements of the heap as a slice, in no particular order.
+
+static UNUSED
+slice(T) XCAT(as_slice_, HEAP(T))(const HEAP(T) *self) {
+    return XCAT(deref_, Vec(T))(&self->vec);
+}
+
+/// Print in C code syntax, in heap order (i.e. the largest element
+/// first, the rest in no particular order).
+
+static UNUSED
+int XCAT(print_debug_, HEAP(T))(const HEAP(T) *self) {
+    return XCAT(print_debug_, Vec(T))(&self->vec);
+}
@@ -8,12 +8,6 @@ String XCAT(new_String_from_move_, T)(T v) {
     char buf[BUFSIZE];
     size_t did = snprintf(buf, BUFSIZE, FORMATSTRING, v);
     assert(did < BUFSIZE);
-    return (String) {
-        .vec = (Vec(char)) {
-            .ptr = xmemcpy(buf, did + 1),
-            .cap = did + 1,
-            .len = did
-        }
-    };
+    return new_String_from_strslice(new_strslice(buf, did));
 #undef BUFSIZE
 }
@@ -0,0 +1,176 @@
+// parameters: T
+
+//! Part of the [`cj50/gen/parallel.h`](../parallel.h.md) library.
+
+//! `Vec(T)` must be instantiated, too.
+
+
+typedef struct XCAT(_ParallelFor_, mutslice(T)) {
+    mutslice(T) items;
+    void (*f)(T *item, void *ctx);
+    void *ctx;
+} XCAT(_ParallelFor_, mutslice(T));
+
+static
+void XCAT(_run_parallel_for_, mutslice(T))(void *ctx, size_t start, size_t end) {
+    XCAT(_ParallelFor_, mutslice(T)) *c = ctx;
+    for (size_t i = start; i < end; i++) {
+        c->f(&c->items.ptr[i], c->ctx);
+    }
+}
+
+/// Call `f(&item, ctx)` for every item in `items`, in parallel on
+/// `pool` (e.g. `default_ThreadPool()`) and the current thread. There
+/// is no particular order. `f` must only modify the item it is given
+/// (and things protected by a `Mutex` or similar).
+
+static UNUSED
+void XCAT(parallel_for_, mutslice(T))(ThreadPool *pool,
+                                      mutslice(T) items,
+                                      void (*f)(T *item, void *ctx),
+                                      void *ctx) {
+    XCAT(_ParallelFor_, mutslice(T)) c = {
+        .items = items,
+        .f = f,
+        .ctx = ctx
+    };
+    parallel_for_ThreadPool(pool, items.len, 0,
+                            XCAT(_run_parallel_for_, mutslice(T)), &c);
+}
+
+
+typedef struct XCAT(_ParallelFor_, slice(T)) {
+    slice(T) items;
+    void (*f)(const T *item, void *ctx);
+    void *ctx;
+} XCAT(_ParallelFor_, slice(T));
+
+static
+void XCAT(_run_parallel_for_, slice(T))(void *ctx, size_t start, size_t end) {
+    XCAT(_ParallelFor_, slice(T)) *c = ctx;
+    for (size_t i = start; i < end; i++) {
+        c->f(&c->items.ptr[i], c->ctx);
+    }
+}
+
+/// Call `f(&item, ctx)` for every item in `items`, in parallel on
+/// `pool` (e.g. `default_ThreadPool()`) and the current thread. There
+/// is no particular order.
+
+static UNUSED
+void XCAT(parallel_for_, slice(T))(ThreadPool *pool,
+                                   slice(T) items,
+                                   void (*f)(const T *item, void *ctx),
+                                   void *ctx) {
+    XCAT(_ParallelFor_, slice(T)) c = {
+        .items = items,
+        .f = f,
+        .ctx = ctx
+    };
+    parallel_for_ThreadPool(pool, items.len, 0,
+                            XCAT(_run_parallel_for_, slice(T)), &c);
+}
+
+
+typedef struct XCAT(_ParallelMap_, slice(T)) {
+    slice(T) items;
+    T *out;
+    T (*f)(const T *item, void *ctx);
+    void *ctx;
+} XCAT(_ParallelMap_, slice(T));
+
+static
+void XCAT(_run_parallel_map_, slice(T))(void *ctx, size_t start, size_t end) {
+    XCAT(_ParallelMap_, slice(T)) *c = ctx;
+    for (size_t i = start; i < end; i++) {
+        c->out[i] = c->f(&c->items.ptr[i], c->ctx);
+    }
+}
+
+/// Return a new Vec holding `f(&item, ctx)` for every item in
+/// `items`, in the same order. The calls to `f` happen in parallel on
+/// `pool` (e.g. `default_ThreadPool()`) and the current thread.
+
+static UNUSED
+Vec(T) XCAT(parallel_map_, slice(T))(ThreadPool *pool,
+                                     slice(T) items,
+                                     T (*f)(const T *item, void *ctx),
+                                     void *ctx) {
+    Vec(T) out = XCAT(with_capacity_, Vec(T))(items.len);
+    XCAT(_ParallelMap_, slice(T)) c = {
+        .items = items,
+        .out = out.ptr,
+        .f = f,
+        .ctx = ctx
+    };
+    parallel_for_ThreadPool(pool, items.len, 0,
+                            XCAT(_run_parallel_map_, slice(T)), &c);
+    out.len = items.len;
+    return out;
+}
+
+
+typedef struct XCAT(_ParallelReduce_, slice(T)) {
+    slice(T) items;
+    T *partials;
+    T init;
+    T (*combine)(T a, T b, void *ctx);
+    void *ctx;
+} XCAT(_ParallelReduce_, slice(T));
+
+static
+void XCAT(_run_parallel_reduce_, slice(T))(void *ctx, size_t start, size_t end) {
+    XCAT(_ParallelReduce_, slice(T)) *c = ctx;
+    for (size_t chunk = start; chunk < end; chunk++) {
+        size_t i0 = chunk * PARALLEL_REDUCE_CHUNK_LEN;
+        size_t i1 = i0 + PARALLEL_REDUCE_CHUNK_LEN;
+        if (i1 > c->items.len) {
+            i1 = c->items.len;
+        }
+        T acc = c->init;
+        for (size_t i = i0; i < i1; i++) {
+            acc = c->combine(acc, c->items.ptr[i], c->ctx);
+        }
+        c->partials[chunk] = acc;
+    }
+}
+
+/// Combine all items in `items` into one value using
+/// `combine(a, b, ctx)`, starting from `init`, for example to sum
+/// them up. Chunks of `items` are combined in parallel on `pool`
+/// (e.g. `default_ThreadPool()`) and the current thread, then the
+/// results of the chunks are combined in order.
+
+/// `combine` must be associative, `init` must be its neutral element
+/// (e.g. 0 for addition), and T must be a Copy type. If `items` is
+/// empty, the result is `init`. For a given
+/// input, the result is always the same, independent of the number of
+/// threads.
+
+static UNUSED
+T XCAT(parallel_reduce_, slice(T))(ThreadPool *pool,
+                                   slice(T) items,
+                                   T init,
+                                   T (*combine)(T a, T b, void *ctx),
+                                   void *ctx) {
+    if (items.len == 0) {
+        return init;
+    }
+    size_t nchunks = (items.len + PARALLEL_REDUCE_CHUNK_LEN - 1)
+        / PARALLEL_REDUCE_CHUNK_LEN;
+    XCAT(_ParallelReduce_, slice(T)) c = {
+        .items = items,
+        .partials = xmallocarray(nchunks, sizeof(T)),
+        .init = init,
+        .combine = combine,
+        .ctx = ctx
+    };
+    parallel_for_ThreadPool(pool, nchunks, 1,
+                            XCAT(_run_parallel_reduce_, slice(T)), &c);
+    T acc = init;
+    for (size_t i = 0; i < nchunks; i++) {
+        acc = combine(acc, c.partials[i], ctx);
+    }
+    xfree(c.partials);
+    return acc;
+}
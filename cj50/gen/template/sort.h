@@ -0,0 +1,373 @@
+// parameters: T, and optionally SORT_RADIX (if defined,
+// `radix_sort_mutslice_T` exists and is used for large inputs)
+
+//! Part of the [`cj50/gen/sort.h`](../sort.h.md) library: the parts
+//! instantiated once per element type.
+
+//! Example:
+
+/// ```C
+/// Vec(int) v = new_Vec_int();
+/// push(&v, 3);
+/// push(&v, 1);
+/// push(&v, 2);
+/// sort(&v); // {1, 2, 3}
+/// int x = 2;
+/// Result(size_t, size_t) r = binary_search(&v, &x); // Ok(1)
+/// ```
+
+
+static inline
+void XCAT(_swap_, T)(T *a, T *b) {
+    T tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+// Stable insertion sort of `v[0..len)`.
+static
+void XCAT(_insertion_sort_, T)(T *v, size_t len) {
+    for (size_t i = 1; i < len; i++) {
+        if (XCAT(cmp_, T)(&v[i], &v[i - 1]) < 0) {
+            T tmp = v[i];
+            size_t j = i;
+            do {
+                v[j] = v[j - 1];
+                j--;
+            } while ((j > 0) && (XCAT(cmp_, T)(&tmp, &v[j - 1]) < 0));
+            v[j] = tmp;
+        }
+    }
+}
+
+// Like `_insertion_sort_T`, but gives up (returning false) if more
+// than a few elements would have to be moved.
+static
+bool XCAT(_partial_insertion_sort_, T)(T *v, size_t len) {
+    size_t moves = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (XCAT(cmp_, T)(&v[i], &v[i - 1]) < 0) {
+            T tmp = v[i];
+            size_t j = i;
+            do {
+                v[j] = v[j - 1];
+                j--;
+            } while ((j > 0) && (XCAT(cmp_, T)(&tmp, &v[j - 1]) < 0));
+            v[j] = tmp;
+            moves += i - j;
+            if (moves > _SORT_PARTIAL_INSERTION_MOVES) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static
+void XCAT(_heapsort_sift_down_, T)(T *v, size_t len, size_t pos) {
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= len) {
+            break;
+        }
+        if ((child + 1 < len)
+            && (XCAT(cmp_, T)(&v[child], &v[child + 1]) < 0)) {
+            child++;
+        }
+        if (XCAT(cmp_, T)(&v[pos], &v[child]) >= 0) {
+            break;
+        }
+        XCAT(_swap_, T)(&v[pos], &v[child]);
+        pos = child;
+    }
+}
+
+// The fallback guaranteeing O(n log n) when partitioning keeps going
+// badly.
+static
+void XCAT(_heapsort_, T)(T *v, size_t len) {
+    for (size_t i = len / 2; i-- > 0; ) {
+        XCAT(_heapsort_sift_down_, T)(v, len, i);
+    }
+    for (size_t end = len; end-- > 1; ) {
+        XCAT(_swap_, T)(&v[0], &v[end]);
+        XCAT(_heapsort_sift_down_, T)(v, end, 0);
+    }
+}
+
+// Order `v[a]`, `v[b]`, `v[c]`.
+static inline
+void XCAT(_sort3_, T)(T *v, size_t a, size_t b, size_t c) {
+    if (XCAT(cmp_, T)(&v[b], &v[a]) < 0) {
+        XCAT(_swap_, T)(&v[a], &v[b]);
+    }
+    if (XCAT(cmp_, T)(&v[c], &v[b]) < 0) {
+        XCAT(_swap_, T)(&v[b], &v[c]);
+        if (XCAT(cmp_, T)(&v[b], &v[a]) < 0) {
+            XCAT(_swap_, T)(&v[a], &v[b]);
+        }
+    }
+}
+
+// Move the median of 3 (or for long sequences, of 3 medians of 3)
+// elements to `v[0]`.
+static
+void XCAT(_choose_pivot_, T)(T *v, size_t len) {
+    size_t a = len / 4, b = len / 2, c = len / 4 * 3;
+    if (len >= 128) {
+        XCAT(_sort3_, T)(v, a - 1, a, a + 1);
+        XCAT(_sort3_, T)(v, b - 1, b, b + 1);
+        XCAT(_sort3_, T)(v, c - 1, c, c + 1);
+    }
+    XCAT(_sort3_, T)(v, a, b, c);
+    XCAT(_swap_, T)(&v[0], &v[b]);
+}
+
+// Partition `v[1..len)` around the pivot `v[0]` and move the pivot
+// between the two parts. Returns the new position of the pivot: the
+// elements before it are smaller, the ones after it are not. Sets
+// `*was_partitioned` if no elements had to be swapped.
+static
+size_t XCAT(_partition_, T)(T *v, size_t len, bool *was_partitioned) {
+    T pivot = v[0];
+    size_t i = 1, j = len - 1;
+    bool swapped = false;
+    while (true) {
+        while ((i <= j) && (XCAT(cmp_, T)(&v[i], &pivot) < 0)) {
+            i++;
+        }
+        while ((i <= j) && (XCAT(cmp_, T)(&v[j], &pivot) >= 0)) {
+            j--;
+        }
+        if (i > j) {
+            break;
+        }
+        XCAT(_swap_, T)(&v[i], &v[j]);
+        swapped = true;
+        i++;
+        j--;
+    }
+    v[0] = v[j];
+    v[j] = pivot;
+    *was_partitioned = !swapped;
+    return j;
+}
+
+// Partition `v[1..len)` into the elements equal to the pivot `v[0]`
+// and those larger (there are no smaller ones, as the caller knows
+// that the pivot equals a lower bound). Returns the position of the
+// last element equal to the pivot.
+static
+size_t XCAT(_partition_equal_, T)(T *v, size_t len) {
+    T pivot = v[0];
+    size_t i = 1, j = len - 1;
+    while (true) {
+        while ((i <= j) && (XCAT(cmp_, T)(&pivot, &v[i]) >= 0)) {
+            i++;
+        }
+        while ((i <= j) && (XCAT(cmp_, T)(&pivot, &v[j]) < 0)) {
+            j--;
+        }
+        if (i > j) {
+            break;
+        }
+        XCAT(_swap_, T)(&v[i], &v[j]);
+        i++;
+        j--;
+    }
+    v[0] = v[j];
+    v[j] = pivot;
+    return j;
+}
+
+// Sort `v[0..len)`; `pred`, if not NULL, is an element that is not
+// larger than any element in it (the pivot of an enclosing
+// partition). Recurses into the smaller part only, to bound the
+// stack depth to O(log n).
+static
+void XCAT(_pdqsort_, T)(T *v, size_t len, const T *pred, int limit) {
+    while (true) {
+        if (len <= _SORT_INSERTION_LEN) {
+            XCAT(_insertion_sort_, T)(v, len);
+            return;
+        }
+        if (limit == 0) {
+            XCAT(_heapsort_, T)(v, len);
+            return;
+        }
+        limit--;
+
+        XCAT(_choose_pivot_, T)(v, len);
+
+        // If the pivot equals the lower bound, there are many equal
+        // elements: put them all aside, they are done.
+        if (pred && (XCAT(cmp_, T)(pred, &v[0]) == 0)) {
+            size_t mid = XCAT(_partition_equal_, T)(v, len);
+            v += mid + 1;
+            len -= mid + 1;
+            continue;
+        }
+
+        bool was_partitioned;
+        size_t mid = XCAT(_partition_, T)(v, len, &was_partitioned);
+        size_t left_len = mid;
+        size_t right_len = len - mid - 1;
+
+        // Probably already sorted: try to finish cheaply.
+        if (was_partitioned
+            && (left_len >= len / 8) && (right_len >= len / 8)
+            && XCAT(_partial_insertion_sort_, T)(v, left_len)
+            && XCAT(_partial_insertion_sort_, T)(v + mid + 1, right_len)) {
+            return;
+        }
+
+        if (left_len < right_len) {
+            XCAT(_pdqsort_, T)(v, left_len, pred, limit);
+            pred = &v[mid];
+            v += mid + 1;
+            len = right_len;
+        } else {
+            XCAT(_pdqsort_, T)(v + mid + 1, right_len, &v[mid], limit);
+            len = left_len;
+        }
+    }
+}
+
+/// Whether the elements of the slice are in ascending order.
+
+static UNUSED
+bool XCAT(is_sorted_, slice(T))(slice(T) self) {
+    for (size_t i = 1; i < self.len; i++) {
+        if (XCAT(cmp_, T)(&self.ptr[i], &self.ptr[i - 1]) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Sort the elements of the mutslice in ascending order, as
+/// determined by `cmp_T`. Equal elements may be reordered. O(n log n)
+/// in the worst case; does not allocate.
+
+/// `cmp_T` must be a total order, as the result would otherwise
+/// depend on the input length (long inputs of number types are radix
+/// sorted by value). `cmp_float` and `cmp_double` are.
+
+static UNUSED
+void XCAT(sort_, mutslice(T))(mutslice(T) self) {
+#ifdef SORT_RADIX
+    if (self.len >= _SORT_RADIX_MIN_LEN) {
+        // Radix sort always does all its passes; checking for sorted
+        // input first is cheap as it normally stops early.
+        if (XCAT(is_sorted_, slice(T))(
+                XCAT(new_, slice(T))(self.ptr, self.len))) {
+            return;
+        }
+        XCAT(radix_sort_, mutslice(T))(self);
+        return;
+    }
+#endif
+    XCAT(_pdqsort_, T)(self.ptr, self.len, NULL,
+                       _sort_depth_limit(self.len));
+}
+
+/// Sort the elements of the vector, see `sort_mutslice_T`.
+
+static UNUSED
+void XCAT(sort_, Vec(T))(Vec(T) *self) {
+    XCAT(sort_, mutslice(T))(
+        XCAT(new_, mutslice(T))(self->ptr, self->len));
+}
+
+// Merge the sorted `v[0..mid)` and `v[mid..len)`, using `buf` with
+// room for `mid` elements.
+static
+void XCAT(_merge_, T)(T *v, size_t mid, size_t len, T *buf) {
+    // Already in order?
+    if (XCAT(cmp_, T)(&v[mid], &v[mid - 1]) >= 0) {
+        return;
+    }
+    memcpy(buf, v, mid * sizeof(T));
+    size_t i = 0, j = mid, k = 0;
+    while ((i < mid) && (j < len)) {
+        // Take from the right only if strictly smaller, for stability
+        if (XCAT(cmp_, T)(&v[j], &buf[i]) < 0) {
+            v[k++] = v[j++];
+        } else {
+            v[k++] = buf[i++];
+        }
+    }
+    // The rest of the right part is already in place
+    memcpy(&v[k], &buf[i], (mid - i) * sizeof(T));
+}
+
+static
+void XCAT(_merge_sort_, T)(T *v, size_t len, T *buf) {
+    if (len <= _SORT_INSERTION_LEN) {
+        XCAT(_insertion_sort_, T)(v, len);
+        return;
+    }
+    size_t mid = len / 2;
+    XCAT(_merge_sort_, T)(v, mid, buf);
+    XCAT(_merge_sort_, T)(v + mid, len - mid, buf);
+    XCAT(_merge_, T)(v, mid, len, buf);
+}
+
+/// Sort the elements of the mutslice in ascending order, as
+/// determined by `cmp_T`, keeping equal elements in their original
+/// order. O(n log n) in the worst case, O(n) for sorted input;
+/// allocates a temporary buffer for half of the elements.
+
+static UNUSED
+void XCAT(sort_stable_, mutslice(T))(mutslice(T) self) {
+    size_t len = self.len;
+    if (len <= _SORT_INSERTION_LEN) {
+        XCAT(_insertion_sort_, T)(self.ptr, len);
+        return;
+    }
+    T *buf = xmallocarray(len / 2 + 1, sizeof(T));
+    XCAT(_merge_sort_, T)(self.ptr, len, buf);
+    xfree(buf);
+}
+
+/// Sort the elements of the vector, see `sort_stable_mutslice_T`.
+
+static UNUSED
+void XCAT(sort_stable_, Vec(T))(Vec(T) *self) {
+    XCAT(sort_stable_, mutslice(T))(
+        XCAT(new_, mutslice(T))(self->ptr, self->len));
+}
+
+/// Search the slice, which must be sorted, for an element equal to
+/// `*x`. Returns `Ok` with the index of a matching element if there
+/// is one (if there are several, any of them), otherwise `Err` with
+/// the index where `*x` could be inserted to keep the slice sorted.
+/// O(log n).
+
+static UNUSED
+Result(size_t, size_t) XCAT(binary_search_, slice(T))(slice(T) self,
+                                                       const T *x) {
+    size_t lo = 0, hi = self.len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = XCAT(cmp_, T)(&self.ptr[mid], x);
+        if (c < 0) {
+            lo = mid + 1;
+        } else if (c > 0) {
+            hi = mid;
+        } else {
+            return ok_Result_size_t__size_t(mid);
+        }
+    }
+    return err_Result_size_t__size_t(lo);
+}
+
+/// Search the vector, which must be sorted, see
+/// `binary_search_slice_T`.
+
+static UNUSED
+Result(size_t, size_t) XCAT(binary_search_, Vec(T))(const Vec(T) *self,
+                                                     const T *x) {
+    return XCAT(binary_search_, slice(T))(
+        XCAT(new_, slice(T))(self->ptr, self->len), x);
+}
@@ -51,7 +51,9 @@
             codepoint |= (b & 0b00111111);
         }
     }
-    if (codepoint <= 0x10FFFF) {
+    if ((codepoint <= 0x10FFFF) &&
+        // surrogates are not valid code points on their own
+        !((codepoint >= 0xD800) && (codepoint <= 0xDFFF))) {
         AUTO cp = ucodepoint(codepoint);
         int expected_numbytes = utf8_sequence_len_ucodepoint(cp);
         if (expected_numbytes == numbytes) {
@@ -0,0 +1,87 @@
+#pragma once
+
+//! Hash functions, as needed for the keys of a `HashMap` (see
+//! [`cj50/gen/HashMap.h`](gen/HashMap.h.md)).
+
+//! `hash_T(const T *v)` returns a 64-bit number calculated from the
+//! value `v`; values that are `equal` give the same number, and
+//! different values very likely give different numbers, in all of
+//! the 64 bits. The hashes are not randomized (they are the same on
+//! every program run), thus they do not protect against inputs
+//! specially crafted to collide.
+
+#include <string.h>
+#include <cj50/basic-util.h>
+#include <cj50/u64.h>
+#include <cj50/int.h>
+#include <cj50/CStr.h>
+#include <cj50/String.h>
+#include <cj50/math.h>
+
+
+// The finalizer of MurmurHash3: every input bit affects every output
+// bit.
+static inline
+u64 _hash_mix_u64(u64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    x ^= x >> 33;
+    return x;
+}
+
+/// Hash `len` bytes starting at `ptr`.
+
+static UNUSED
+u64 hash_bytes(const void *ptr, size_t len) {
+    const u8 *p = ptr;
+    u64 h = 0x9e3779b97f4a7c15 ^ len;
+    // 8 bytes at a time
+    while (len >= 8) {
+        u64 w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x9fb21c651e98df25;
+        h ^= h >> 29;
+        p += 8;
+        len -= 8;
+    }
+    if (len) {
+        u64 w = 0;
+        memcpy(&w, p, len);
+        h = (h ^ w) * 0x9fb21c651e98df25;
+    }
+    return _hash_mix_u64(h);
+}
+
+static UNUSED
+u64 hash_u64(const u64 *v) {
+    return _hash_mix_u64(*v);
+}
+
+static UNUSED
+u64 hash_int(const int *v) {
+    return _hash_mix_u64((u64)(unsigned int)*v);
+}
+
+static UNUSED
+u64 hash_cstr(const cstr *v) {
+    return hash_bytes(*v, strlen(*v));
+}
+
+static UNUSED
+u64 hash_strslice(const strslice *v) {
+    return hash_bytes(v->slice.ptr, v->slice.len);
+}
+
+static UNUSED
+u64 hash_String(const String *v) {
+    strslice s = deref_String(v);
+    return hash_bytes(s.slice.ptr, s.slice.len);
+}
+
+static UNUSED
+u64 hash_Vec2_int(const Vec2(int) *v) {
+    return _hash_mix_u64(((u64)(unsigned int)v->x << 32)
+                         | (unsigned int)v->y);
+}
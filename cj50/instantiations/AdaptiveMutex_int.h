@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cj50/gen/AdaptiveMutex.h>
+
+#define T int
+#include <cj50/gen/template/AdaptiveMutex.h>
+#undef T
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cj50/gen/Atomic.h>
+#include <cj50/ref_void.h>
+
+#define T ref(void)
+#include <cj50/gen/template/Atomic.h>
+#undef T
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cj50/gen/Atomic.h>
+#include <cj50/u32.h>
+
+#define T u32
+#define ATOMIC_INTEGER
+#include <cj50/gen/template/Atomic.h>
+#undef ATOMIC_INTEGER
+#undef T
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cj50/gen/BinaryHeap.h>
+#include <cj50/instantiations/Vec_int.h>
+
+#define T int
+#include <cj50/gen/template/BinaryHeap.h>
+#undef T
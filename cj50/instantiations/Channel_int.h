@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cj50/gen/Channel.h>
+#include <cj50/int.h>
+
+#define T int
+#include <cj50/gen/template/Channel.h>
+#undef T
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cj50/gen/HashMap.h>
+#include <cj50/String.h>
+#include <cj50/int.h>
+
+#define K String
+#define V int
+#include <cj50/gen/template/HashMap.h>
+#undef V
+#undef K
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cj50/gen/HashSet.h>
+#include <cj50/String.h>
+
+#define T String
+#include <cj50/gen/template/HashSet.h>
+#undef T
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cj50/double.h>
+#include <cj50/os.h> /* SystemError */
+
+GENERATE_Result(double, SystemError);
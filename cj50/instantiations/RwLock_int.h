@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cj50/gen/RwLock.h>
+
+#define T int
+#include <cj50/gen/template/RwLock.h>
+#undef T
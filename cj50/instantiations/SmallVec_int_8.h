@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cj50/gen/SmallVec.h>
+#include <cj50/instantiations/Vec_int.h>
+
+#define T int
+#define N 8
+#define IS_TRIVIAL_DROP
+#include <cj50/gen/template/SmallVec.h>
+#undef IS_TRIVIAL_DROP
+#undef N
+#undef T
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cj50/gen/VecDeque.h>
+#include <cj50/instantiations/Vec_int.h>
+
+#define T int
+#define IS_TRIVIAL_DROP
+#include <cj50/gen/template/VecDeque.h>
+#undef IS_TRIVIAL_DROP
+#undef T
@@ -4,6 +4,8 @@
 #include <cj50/math.h>
 
 #define T Vec2(double)
+#define IS_TRIVIAL_DROP
 #include <cj50/gen/template/Vec.h>
+#undef IS_TRIVIAL_DROP
 #undef T
 
@@ -3,6 +3,8 @@
 #include <cj50/gen/Vec.h>
 
 #define T cstr
+#define IS_TRIVIAL_DROP
 #include <cj50/gen/template/Vec.h>
+#undef IS_TRIVIAL_DROP
 #undef T
 
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cj50/gen/Vec.h>
+#include <cj50/u32.h>
+
+#define T u32
+#define IS_TRIVIAL_DROP
+#include <cj50/gen/template/Vec.h>
+#undef IS_TRIVIAL_DROP
+#undef T
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cj50/gen/Vec.h>
+#include <cj50/u64.h>
+
+#define T u64
+#define IS_TRIVIAL_DROP
+#include <cj50/gen/template/Vec.h>
+#undef IS_TRIVIAL_DROP
+#undef T
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cj50/gen/parallel.h>
+#include <cj50/instantiations/Vec_Vec2_float.h>
+
+#define T Vec2(float)
+#include <cj50/gen/template/parallel.h>
+#undef T
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cj50/gen/sort.h>
+#include <cj50/radixsort.h>
+
+#define T float
+#define SORT_RADIX
+#include <cj50/gen/template/sort.h>
+#undef SORT_RADIX
+#undef T
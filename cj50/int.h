@@ -13,6 +13,13 @@ bool equal_move_int(const int a, const int b) {
     return a == b;
 }
 
+/// Returns a negative number if `*a` is smaller than `*b`, 0 if they
+/// are equal, a positive number if `*a` is larger.
+static UNUSED
+int cmp_int(const int *a, const int *b) {
+    return (*a > *b) - (*a < *b);
+}
+
 static UNUSED
 void drop_int(const int UNUSED a) {}
 
@@ -4,12 +4,15 @@
 //! instead of the traditional combination of in-band error signalling
 //! and `errno`.
 
-#include <unistd.h> /* fsync, fdatasync, .. */
+#include <unistd.h> /* fsync, fdatasync, read, close, .. */
+#include <fcntl.h> /* open */
 
 #include <cj50/syscallinfo.h> /* rename to oscallinfo ? */
 #include <cj50/u8.h>
 #include <cj50/int.h>
 #include "cj50/resret.h"
+#include <cj50/xmem.h>
+#include <cj50/size_t.h>
 
 
 
@@ -277,3 +280,137 @@ Result(Unit, SystemError) close_CFile(CFile *f) {
     }
 }
 
+
+
+// ------------------------------------------------------------------ 
+
+/// An owned type holding a file descriptor and a byte buffer that is
+/// refilled from it using `read(2)` in large chunks. Readers (like
+/// `get_ucodepoint_unlocked_BufReader` or
+/// `read_line_Vec_ucodepoint_BufReader`) then work directly on the
+/// buffered bytes, instead of going through the C library for every
+/// single byte like `os_getc_unlocked` does.
+
+/// The bytes at `buf[pos..end]` have been read from `fd` but not
+/// consumed yet.
+
+typedef struct BufReader {
+    int fd;
+    u8 *buf;
+    size_t cap;
+    size_t pos;
+    size_t end;
+    bool eof;
+} BufReader;
+
+/// The buffer size used by `new_BufReader` and `open_BufReader`.
+
+#define BUFREADER_DEFAULT_CAPACITY (64 * 1024)
+
+/// Create a BufReader reading from the file descriptor `fd`, taking
+/// ownership of it (it is closed by `drop_BufReader`). `cap` is the
+/// size of the buffer; it must be at least 4 so that a whole UTF-8
+/// sequence always fits.
+
+static UNUSED
+BufReader new_BufReader_with_capacity(int fd, size_t cap) {
+    assert(cap >= 4);
+    return (BufReader) {
+        .fd = fd,
+        .buf = xmalloc(cap),
+        .cap = cap,
+        .pos = 0,
+        .end = 0,
+        .eof = false
+    };
+}
+
+/// Create a BufReader reading from the file descriptor `fd`, taking
+/// ownership of it (it is closed by `drop_BufReader`).
+
+static UNUSED
+BufReader new_BufReader(int fd) {
+    return new_BufReader_with_capacity(fd, BUFREADER_DEFAULT_CAPACITY);
+}
+
+/// Closes the file descriptor and frees the buffer. Like `drop_CFile`,
+/// failures are only reported as a warning.
+
+static UNUSED
+void drop_BufReader(BufReader self) {
+    if (self.fd >= 0) {
+        if (close(self.fd) != 0) {
+            WARN_("Warning: drop_BufReader: close failed: %s",
+                  strerror(errno));
+        }
+    }
+    xfree(self.buf);
+}
+
+/// Equality on BufReader does not make much sense; it does report
+/// whether the file descriptors and buffers are identical.
+
+static UNUSED
+bool equal_BufReader(const BufReader *a, const BufReader *b) {
+    return (a->fd == b->fd) && (a->buf == b->buf);
+}
+
+static UNUSED
+int print_debug_BufReader(const BufReader *v) {
+    INIT_RESRET;
+    RESRET(printf("BufReader(%i, %zu/%zu)", v->fd, v->end - v->pos, v->cap));
+cleanup:
+    return ret;
+}
+
+GENERATE_Result(BufReader, SystemError);
+GENERATE_Result(size_t, SystemError);
+
+/// Opens the file whose name is the string pointed to by `pathname`
+/// for reading, and returns a BufReader for it.
+
+static UNUSED
+Result(BufReader, SystemError) open_BufReader(cstr pathname) {
+    int fd = open(pathname, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        return Ok(BufReader, SystemError)(new_BufReader(fd));
+    } else {
+        return Err(BufReader, SystemError)(
+            systemError(SYSCALLINFO_open, errno));
+    }
+}
+
+/// Move the unconsumed bytes to the start of the buffer and read more
+/// data after them, with a single successful `read` call. Returns
+/// the number of bytes read, 0 meaning end of file (`self->eof` is
+/// set then). Interrupted calls (`EINTR`) are retried.
+
+static UNUSED
+Result(size_t, SystemError) fill_BufReader(BufReader *self) {
+    if (self->pos > 0) {
+        size_t n = self->end - self->pos;
+        memmove(self->buf, self->buf + self->pos, n);
+        self->pos = 0;
+        self->end = n;
+    }
+    if (self->end == self->cap) {
+        // Nothing consumed, no space; callers never need more than
+        // `cap` bytes at once.
+        return Ok(size_t, SystemError)(0);
+    }
+    while (true) {
+        ssize_t r = read(self->fd, self->buf + self->end,
+                         self->cap - self->end);
+        if (r >= 0) {
+            self->end += r;
+            if (r == 0) {
+                self->eof = true;
+            }
+            return Ok(size_t, SystemError)(r);
+        }
+        if (errno != EINTR) {
+            return Err(size_t, SystemError)(
+                systemError(SYSCALLINFO_read, errno));
+        }
+    }
+}
@@ -5,10 +5,19 @@
 //! `Mutex` type.
 
 #include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <cj50/os.h>
 #include <cj50/String.h>
 #include <cj50/gen/Result.h>
 #include <cj50/gen/dispatch/new_from.h>
+#include <cj50/random.h>
+#include <cj50/futex.h>
+#include <cj50/int.h>
+#include <cj50/u64.h>
 
 typedef struct Thread {
     pthread_t thread; // presumably movable "since it's just an ID"
@@ -39,19 +48,236 @@ cleanup:
 
 #include <cj50/instantiations/Result_Thread__SystemError.h>
 
+// ------------------------------------------------------------------
+// Options for spawning threads
+
+/// The highest number of CPUs that a `CpuSet` can hold.
+
+#define CPUSET_MAX_CPUS 1024
+
+/// A set of CPUs (numbered from 0, as in `/proc/cpuinfo` or the
+/// output of `lscpu`), to restrict threads to via
+/// `ThreadOptions.affinity`.
+
+typedef struct CpuSet {
+    // Bit `i % 64` of `bits[i / 64]` is CPU `i`
+    u64 bits[CPUSET_MAX_CPUS / 64];
+} CpuSet;
+
+/// An empty set.
+
 static UNUSED
-Result(Thread, SystemError) spawn_thread(void *(*start_routine) (void *),
-                                         void *arg,
-                                         String name) {
+CpuSet new_CpuSet() {
+    return (CpuSet) { .bits = { 0 } };
+}
+
+/// Add CPU number `cpu` to the set.
+
+static UNUSED
+void add_CpuSet(CpuSet *self, size_t cpu) {
+    if (cpu >= CPUSET_MAX_CPUS) {
+        DIE_("add_CpuSet: CPU number %zu is too large", cpu);
+    }
+    self->bits[cpu / 64] |= (u64)1 << (cpu % 64);
+}
+
+static UNUSED
+bool contains_CpuSet(const CpuSet *self, size_t cpu) {
+    return (cpu < CPUSET_MAX_CPUS) &&
+        (self->bits[cpu / 64] & ((u64)1 << (cpu % 64)));
+}
+
+static UNUSED
+bool is_empty_CpuSet(const CpuSet *self) {
+    for (size_t i = 0; i < CPUSET_MAX_CPUS / 64; i++) {
+        if (self->bits[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// How `spawn_thread_with_options` should set up the new thread.
+
+typedef struct ThreadOptions {
+    /// The size of the thread's stack in bytes, 0 for the system's
+    /// default (usually 8 MB, see `ulimit -s`).
+    size_t stack_size;
+    /// The CPUs the thread may run on; if empty, it may run on all
+    /// of them. Keeping a thread on the same CPUs avoids losing the
+    /// contents of the CPU caches (and, on machines with several
+    /// NUMA nodes, memory locality) when the OS moves it.
+    CpuSet affinity;
+    /// The "nice value" of the thread (see `man 2 setpriority`), from
+    /// -20 (highest priority) to 19 (lowest). If none, the thread
+    /// inherits the nice value of the thread that spawns it. Lowering
+    /// the nice value below that usually needs root permissions.
+    Option(int) niceness;
+} ThreadOptions;
+
+/// The options that `spawn_thread` uses: default stack size, all
+/// CPUs, the spawning thread's priority.
+
+static UNUSED
+ThreadOptions new_ThreadOptions() {
+    return (ThreadOptions) {
+        .stack_size = 0,
+        .affinity = new_CpuSet(),
+        .niceness = none_int()
+    };
+}
+
+
+// ------------------------------------------------------------------
+// Spawning
+
+// The longest name the kernel stores for a thread, plus '\0'.
+#define _THREAD_NAME_SIZE ((size_t)16)
+
+// Where a new thread reports the outcome of setting itself up; lives
+// on the stack of the spawning thread, which waits for `done`.
+typedef struct _ThreadSetup {
+    u32 done;
+    bool failed;
+    SystemError error;
+} _ThreadSetup;
+
+// What a new thread needs before running the user's start_routine.
+typedef struct _ThreadStart {
+    void *(*start_routine) (void *);
+    void *arg;
+    Rng rng;
+    char name[_THREAD_NAME_SIZE];
+    ThreadOptions options;
+    _ThreadSetup *setup;
+} _ThreadStart;
+
+// Apply the name and those options to the current thread that can
+// only be set from inside it. Returns false and sets `*error` on
+// failure.
+static
+bool _setup_thread(const _ThreadStart *start, SystemError *error) {
+    // (The name shows up in `top -H`, `ps -L`, `perf` and gdb.)
+    if (prctl(PR_SET_NAME, start->name, 0, 0, 0) != 0) {
+        *error = systemError(SYSCALLINFO_prctl, errno);
+        return false;
+    }
+    const ThreadOptions *o = &start->options;
+    if (!is_empty_CpuSet(&o->affinity)) {
+        if (syscall(SYS_sched_setaffinity, 0, sizeof(o->affinity.bits),
+                    o->affinity.bits) != 0) {
+            *error = systemError(SYSCALLINFO_sched_setaffinity, errno);
+            return false;
+        }
+    }
+    if (o->niceness.is_some) {
+        // On Linux, this changes the given thread only, not the
+        // whole process
+        if (setpriority(PRIO_PROCESS, syscall(SYS_gettid),
+                        o->niceness.value) != 0) {
+            *error = systemError(SYSCALLINFO_setpriority, errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void *_thread_start(void *p) {
+    _ThreadStart start = *(_ThreadStart*)p;
+    xfree(p);
+    _thread_rng = start.rng;
+    _thread_rng_initialized = true;
+    _ThreadSetup *setup = start.setup;
+    setup->failed = !_setup_thread(&start, &setup->error);
+    bool failed = setup->failed;
+    __atomic_store_n(&setup->done, 1, __ATOMIC_RELEASE);
+    // `setup` may be gone once `done` is set; waking on its address
+    // does not access it (at worst, another waiter there wakes up
+    // spuriously, which futex users have to handle anyway)
+    futex_wake(&setup->done, 1);
+    if (failed) {
+        return NULL;
+    }
+    return start.start_routine(start.arg);
+}
+
+/// Start a new thread running `start_routine(arg)`, set up according
+/// to `options`. `name` is stored in the returned `Thread`, and its
+/// first 15 bytes are given to the OS as the thread's name. If
+/// setting up the thread fails, the thread is stopped before calling
+/// `start_routine` and the error is returned.
+
+/// Like with `spawn_thread`, the new thread's random number
+/// generator is split off from the current thread's.
+
+static UNUSED
+Result(Thread, SystemError) spawn_thread_with_options(
+    void *(*start_routine) (void *),
+    void *arg,
+    String name,
+    const ThreadOptions *options)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (options->stack_size) {
+        int err = pthread_attr_setstacksize(&attr, options->stack_size);
+        if (err) {
+            pthread_attr_destroy(&attr);
+            drop_String(name);
+            return Err(Thread, SystemError)(
+                systemError(SYSCALLINFO_pthread_attr_setstacksize, err));
+        }
+    }
+
+    _ThreadSetup setup = { .done = 0, .failed = false };
+    _ThreadStart *start = xmalloc(sizeof(_ThreadStart));
+    *start = (_ThreadStart) {
+        .start_routine = start_routine,
+        .arg = arg,
+        .rng = split_Rng(thread_Rng()),
+        .options = *options,
+        .setup = &setup
+    };
+    slice(char) namebytes = deref_String(&name).slice;
+    size_t namelen = MIN(namebytes.len, _THREAD_NAME_SIZE - 1);
+    memcpy(start->name, namebytes.ptr, namelen);
+    start->name[namelen] = '\0';
+
     Thread t;
     t.name = name;
-    if (pthread_create(&t.thread, NULL /* for now */,
-                       start_routine, arg) == 0) {
-        return Ok(Thread, SystemError)(t);
-    } else {
+    int err = pthread_create(&t.thread, &attr, _thread_start, start);
+    pthread_attr_destroy(&attr);
+    if (err) {
+        xfree(start);
+        drop_String(t.name);
         return Err(Thread, SystemError)(
-            systemError(SYSCALLINFO_pthread_create, errno));
+            systemError(SYSCALLINFO_pthread_create, err));
+    }
+
+    while (!__atomic_load_n(&setup.done, __ATOMIC_ACQUIRE)) {
+        futex_wait(&setup.done, 0, NULL);
     }
+    if (setup.failed) {
+        pthread_join(t.thread, NULL);
+        drop_String(t.name);
+        return Err(Thread, SystemError)(setup.error);
+    }
+    return Ok(Thread, SystemError)(t);
+}
+
+/// Start a new thread running `start_routine(arg)`, with the default
+/// options (see `spawn_thread_with_options`). The new thread's
+/// random number generator (see `thread_Rng`) is split off from the
+/// current thread's, so that it is reproducible if the current one
+/// is (see `seed_random`).
+
+static UNUSED
+Result(Thread, SystemError) spawn_thread(void *(*start_routine) (void *),
+                                         void *arg,
+                                         String name) {
+    ThreadOptions options = new_ThreadOptions();
+    return spawn_thread_with_options(start_routine, arg, name, &options);
 }
 
 #include <cj50/instantiations/Result_ref_void__SystemError.h>
@@ -71,3 +297,45 @@ cleanup1:
     END_Result();
 }
 
+
+
+// ------------------------------------------------------------------
+// CPU time statistics
+
+#include <cj50/instantiations/Result_double__SystemError.h>
+
+static
+double _seconds_from_timespec(struct timespec t) {
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/// The CPU time in seconds that the thread `self` has used so far
+/// (time spent running, not waiting). `self` must not have been
+/// joined yet.
+
+static UNUSED
+Result(double, SystemError) thread_cpu_time(const Thread *self) {
+    clockid_t clock;
+    int err = pthread_getcpuclockid(self->thread, &clock);
+    if (err) {
+        return Err(double, SystemError)(
+            systemError(SYSCALLINFO_pthread_getcpuclockid, err));
+    }
+    struct timespec t;
+    if (clock_gettime(clock, &t) != 0) {
+        return Err(double, SystemError)(
+            systemError(SYSCALLINFO_clock_gettime, errno));
+    }
+    return Ok(double, SystemError)(_seconds_from_timespec(t));
+}
+
+/// The CPU time in seconds that the current thread has used so far.
+
+static UNUSED
+double current_thread_cpu_time() {
+    struct timespec t;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0) {
+        DIE_("clock_gettime: %s", strerror(errno));
+    }
+    return _seconds_from_timespec(t);
+}
@@ -6,6 +6,7 @@
 #include <cj50/gen/Vec.h>
 #include <cj50/instantiations/Vec2_u32.h>
 #include <sys/param.h> /* MAX */
+#include <cj50/threadpool.h>
 // for debugging only:
 #include <cj50/String.h>
 
@@ -65,29 +66,46 @@ int print_debug_move_ARGB8888(ARGB8888 self) {
 }
 
 
+/// Accumulated light, one `Vec3(float)` per pixel. There is an extra
+/// border of one pixel all around, `pixels[-1 - stride]` up to
+/// `pixels[geometry.x + geometry.y * stride]` are valid: this way
+/// `splat_points_Pixels_float` can draw points near the edges without
+/// bounds checks. The light falling onto the border is not part of the
+/// image.
 typedef struct Pixels_float {
     Vec2(int) geometry;
-    Vec3(float) *pixels; // vec3(R, G, B) [x + y*width]
+    int stride; // geometry.x + 2
+    Vec3(float) *pixels; // vec3(R, G, B) [x + y*stride]
 } Pixels_float;
 
 static
 size_t _pixels_size_for_Pixels_float(Vec2(int) geometry, size_t siz) {
-    return geometry.x * geometry.y * siz;
+    return (geometry.x + 2) * (geometry.y + 2) * siz;
+}
+
+// The start of the allocation, i.e. the top left border pixel.
+static
+Vec3(float) *_base_Pixels_float(const Pixels_float *pixels) {
+    return pixels->pixels - pixels->stride - 1;
 }
 
 static
 void clear_Pixels_float(Pixels_float *pixels) {
     // OK for float 0.0?
-    memset(pixels->pixels,
+    memset(_base_Pixels_float(pixels),
            0,
            _pixels_size_for_Pixels_float(pixels->geometry, sizeof(Vec3(float))));
 }
 
 static
 Pixels_float new_Pixels_float(Vec2(int) geometry) {
+    int stride = geometry.x + 2;
+    Vec3(float) *base =
+        xmalloc(_pixels_size_for_Pixels_float(geometry, sizeof(Vec3(float))));
     AUTO pixels = (Pixels_float) {
         .geometry = geometry,
-        .pixels = xmalloc(_pixels_size_for_Pixels_float(geometry, sizeof(Vec3(float)))),
+        .stride = stride,
+        .pixels = base + stride + 1,
     };
     clear_Pixels_float(&pixels);
     return pixels;
@@ -95,7 +113,7 @@ Pixels_float new_Pixels_float(Vec2(int) geometry) {
 
 static
 void drop_Pixels_float(Pixels_float self) {
-    free(self.pixels);
+    xfree(_base_Pixels_float(&self));
 }
 
 static
@@ -114,81 +132,179 @@ static
 Vec3(float)* at_Pixels_float(Pixels_float * RESTRICT pixels, Vec2(int) point) {
     assert(point.x < pixels->geometry.x);
     assert(point.y < pixels->geometry.y);
-    return &pixels->pixels[point.x + point.y * pixels->geometry.x];
+    return &pixels->pixels[point.x + point.y * pixels->stride];
+}
+
+/// The pixels of row `y`.
+static
+Vec3(float)* row_Pixels_float(const Pixels_float *pixels, int y) {
+    return &pixels->pixels[y * pixels->stride];
+}
+
+
+typedef float _v4f __attribute__((vector_size(16)));
+typedef int32_t _v4i __attribute__((vector_size(16)));
+
+static inline
+_v4f _max_v4f(_v4f a, _v4f b) {
+    _v4i m = a > b;
+    return (_v4f)(((_v4i)a & m) | ((_v4i)b & ~m));
 }
 
+static inline
+_v4f _loadu_v4f(const float *p) {
+    _v4f v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline
+void _storeu_v4f(float *p, _v4f v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// smaller -> skinnier lines
+#define _SPLAT_MIN_DIST2 0.32f
+
+// Add the light of a point to the 3x3 pixels around (_x, _y), which
+// must all be inside the pixels including the border. A row of 3
+// pixels is 9 floats, R0 G0 B0 R1 | G1 B1 R2 G2 | B2, handled as two
+// vectors and a scalar, so `col_a` is (R, G, B, R) and `col_b` is (G,
+// B, R, G).
+static inline
+void _splat_point_Pixels_float(Pixels_float * RESTRICT pixels,
+                               int _x, int _y,
+                               Vec2(float) point,
+                               _v4f col_a, _v4f col_b, float col_c) {
+    float d0 = (_x - 1) - point.x;
+    float d1 = _x - point.x;
+    float d2 = (_x + 1) - point.x;
+    _v4f dx2_a = (_v4f) { d0, d0, d0, d1 };
+    _v4f dx2_b = (_v4f) { d1, d1, d2, d2 };
+    dx2_a *= dx2_a;
+    dx2_b *= dx2_b;
+    float dx2_c = d2 * d2;
+    const _v4f min_dist2 = (_v4f) { _SPLAT_MIN_DIST2, _SPLAT_MIN_DIST2,
+                                    _SPLAT_MIN_DIST2, _SPLAT_MIN_DIST2 };
+    float *row = (float*)&pixels->pixels[(_x - 1) + (_y - 1) * pixels->stride];
+    for (int y = _y - 1; y <= _y + 1; y++) {
+        float dy = y - point.y;
+        float dy2 = dy * dy;
+        _v4f att_a = 1.f / _max_v4f(min_dist2, dx2_a + dy2);
+        _v4f att_b = 1.f / _max_v4f(min_dist2, dx2_b + dy2);
+        float att_c = 1.f / MAX(_SPLAT_MIN_DIST2, dx2_c + dy2);
+        _storeu_v4f(&row[0], _loadu_v4f(&row[0]) + col_a * att_a);
+        _storeu_v4f(&row[4], _loadu_v4f(&row[4]) + col_b * att_b);
+        row[8] += col_c * att_c;
+        row += 3 * pixels->stride;
+    }
+}
+
+// Like `_splat_point_Pixels_float`, but for points whose 3x3 pixels
+// reach beyond the border; those pixels are left out.
 static
+void _splat_point_clipped_Pixels_float(Pixels_float * RESTRICT pixels,
+                                       int _x, int _y,
+                                       Vec2(float) point,
+                                       Vec3(float) color) {
+    for (int y = MAX(_y - 1, -1); y <= MIN(_y + 1, pixels->geometry.y); y++) {
+        for (int x = MAX(_x - 1, -1); x <= MIN(_x + 1, pixels->geometry.x); x++) {
+            float attenuation = 1.f / MAX(
+                _SPLAT_MIN_DIST2,
+                square(x - point.x) + square(y - point.y));
+            Vec3(float) *lumtot = &pixels->pixels[x + y * pixels->stride];
+            *lumtot = add_Vec3_float(*lumtot,
+                                     mul_Vec3_float_float(color, attenuation));
+        }
+    }
+}
+
+/// Add light of the given `color` around each of the `points`. The
+/// brightness falls off with the square of the distance from the
+/// point, and reaches into the 3x3 pixels around it.
+
+static UNUSED
+void splat_points_Pixels_float(Pixels_float * RESTRICT pixels,
+                               slice(Vec2(float)) points,
+                               Vec3(float) color) {
+    _v4f col_a = (_v4f) { color.x, color.y, color.z, color.x };
+    _v4f col_b = (_v4f) { color.y, color.z, color.x, color.y };
+    float width = pixels->geometry.x;
+    float height = pixels->geometry.y;
+    for (size_t i = 0; i < points.len; i++) {
+        Vec2(float) point = points.ptr[i];
+        // Thanks to the border, the 3x3 pixels around every pixel in
+        // the image are valid. (The comparisons are also false for
+        // NaN.)
+        if ((point.x >= -0.5f) && (point.x < width - 0.5f) &&
+            (point.y >= -0.5f) && (point.y < height - 0.5f)) {
+            _splat_point_Pixels_float(pixels,
+                                      point.x + 0.5f, point.y + 0.5f,
+                                      point,
+                                      col_a, col_b, color.z);
+        } else if ((point.x >= -2.5f) && (point.x < width + 1.5f) &&
+                   (point.y >= -2.5f) && (point.y < height + 1.5f)) {
+            _splat_point_clipped_Pixels_float(pixels,
+                                              floorf(point.x + 0.5f),
+                                              floorf(point.y + 0.5f),
+                                              point,
+                                              color);
+        }
+    }
+}
+
+/// Add light around a single `point`, see `splat_points_Pixels_float`,
+/// and update `max_color_lum` with the brightness of the pixels
+/// changed in the image.
+
+static UNUSED
 void draw_point_Pixels_float(Pixels_float * RESTRICT pixels,
                              Vec2(float) point,
                              Vec3(float) color,
                              // The maximum brightness seen of any color:
                              float * RESTRICT max_color_lum) {
-    int _x = point.x + 0.5f;
-    int _y = point.y + 0.5f;
-    // Add light to 9 positions at and around this point.
-    for (int y = _y - 1; y <= _y + 1; y++) {
-        if ((y >= 0) && (y < pixels->geometry.y)) {
-            int xbase = _x - 1;
-            if ((xbase >= 0) && ((xbase + 2) < pixels->geometry.x)) {
-                for (int xadd = 0; xadd < 3; xadd++) {
-                    int x = xbase + xadd;
-                    float xf = x;
-                    float yf = y;
-                    float attenuation = 1.f / MAX(
-                        0.32f, // smaller -> skinnier lines
-                        square(xf - point.x) + square(yf - point.y));
-                    Vec3(float) lumplus =
-                        mul_Vec3_float_float(color, attenuation);
-                    Vec3(float)* RESTRICT lumtot =
-                        at_Pixels_float(pixels, vec2_int(x, y));
-                    Vec3(float) lumtotnew = add_Vec3_float(*lumtot, lumplus);
-                    *lumtot = lumtotnew;
-#define UPDATE_MAX(field)                                           \
-                    if (lumtotnew.field > *max_color_lum) {     \
-                        *max_color_lum = lumtotnew.field;       \
-                    }
-                    UPDATE_MAX(x);
-                    UPDATE_MAX(y);
-                    UPDATE_MAX(z);
-#undef UPDATE_MAX
-                }
-            } else {
-                // slow fallback
-                for (int x = _x - 1; x <= _x + 1; x++) {
-                    if ((x >= 0) && (x < pixels->geometry.x)) {
-                        float xf = x;
-                        float yf = y;
-                        float attenuation = 1.f / MAX(
-                            0.32f, // smaller -> skinnier lines
-                            square(xf - point.x) + square(yf - point.y));
-                        Vec3(float) lumplus =
-                            mul_Vec3_float_float(color, attenuation);
-                        Vec3(float)* RESTRICT lumtot =
-                            at_Pixels_float(pixels, vec2_int(x, y));
-                        Vec3(float) lumtotnew = add_Vec3_float(*lumtot, lumplus);
-                        *lumtot = lumtotnew;
-#define UPDATE_MAX(field)                                           \
-                        if (lumtotnew.field > *max_color_lum) {     \
-                            *max_color_lum = lumtotnew.field;       \
-                        }
-                        UPDATE_MAX(x);
-                        UPDATE_MAX(y);
-                        UPDATE_MAX(z);
-#undef UPDATE_MAX
-                    }
-                }
-            }
+    if (! ((point.x >= -2.5f) && (point.x < pixels->geometry.x + 1.5f) &&
+           (point.y >= -2.5f) && (point.y < pixels->geometry.y + 1.5f))) {
+        return;
+    }
+    splat_points_Pixels_float(pixels,
+                              (slice(Vec2(float))) { .ptr = &point, .len = 1 },
+                              color);
+    int _x = floorf(point.x + 0.5f);
+    int _y = floorf(point.y + 0.5f);
+    for (int y = MAX(_y - 1, 0); y <= MIN(_y + 1, pixels->geometry.y - 1); y++) {
+        for (int x = MAX(_x - 1, 0); x <= MIN(_x + 1, pixels->geometry.x - 1); x++) {
+            Vec3(float) lumtot = *at_Pixels_float(pixels, vec2_int(x, y));
+            *max_color_lum = MAX(*max_color_lum,
+                                 MAX(lumtot.x, MAX(lumtot.y, lumtot.z)));
         }
     }
 }
 
 // ------------------------------------------------------------------
 
+// The samples for a strip of `PLOT_TILE_WIDTH` screen columns are
+// drawn by one task, into its own Pixels_float (`tiles` in
+// PlotrenderCtx), the border columns of which catch the light that
+// falls onto the neighbouring strips.
+
+#define PLOT_TILE_WIDTH 64
+// Samples per screen column.
+#define PLOT_OVERSAMPLING 16
+
 typedef struct PlotrenderCtx {
     slice(ColorFunction_float) functions;
     Rect2(float) viewport;
     Pixels_float pixels;
-    VertexRenderer rdr;
+    // Streaming texture of the size of `pixels`, created on the
+    // first frame (a renderer is needed for that). It belongs to the
+    // renderer, which destroys it when `graphics_render` ends, thus
+    // it is only dropped here when it is replaced while the renderer
+    // still exists, not in `drop_PlotrenderCtx`.
+    Option(Texture) texture;
+    size_t num_tiles;
+    Pixels_float *tiles;
+    float *tile_max_color_lum;
 } PlotrenderCtx;
 
 static UNUSED
@@ -199,19 +315,60 @@ PlotrenderCtx new_PlotrenderCtx(
     )
 {
     return (PlotrenderCtx) {
-        functions,
-        viewport,
-        new_Pixels_float(geometry),
-        new_VertexRenderer()
+        .functions = functions,
+        .viewport = viewport,
+        .pixels = new_Pixels_float(geometry),
+        .texture = none_Texture(),
+        .num_tiles = 0,
+        .tiles = NULL,
+        .tile_max_color_lum = NULL
     };
 }
 
+static
+void _drop_tiles_PlotrenderCtx(PlotrenderCtx *self) {
+    for (size_t i = 0; i < self->num_tiles; i++) {
+        drop_Pixels_float(self->tiles[i]);
+    }
+    xfree(self->tiles);
+    xfree(self->tile_max_color_lum);
+    self->num_tiles = 0;
+    self->tiles = NULL;
+    self->tile_max_color_lum = NULL;
+}
+
 static UNUSED
 void drop_PlotrenderCtx(PlotrenderCtx self) {
-    drop_VertexRenderer(self.rdr);
+    _drop_tiles_PlotrenderCtx(&self);
+    // (`self.texture` was already destroyed with the renderer)
     drop_Pixels_float(self.pixels);
 }
 
+// Make sure there are tiles matching the geometry of `self->pixels`.
+static
+void _possibly_resize_tiles_PlotrenderCtx(PlotrenderCtx *self) {
+    Vec2(int) geometry = self->pixels.geometry;
+    size_t num_tiles = (geometry.x + PLOT_TILE_WIDTH - 1) / PLOT_TILE_WIDTH;
+    if ((self->num_tiles == num_tiles) &&
+        (num_tiles > 0) &&
+        (self->tiles[0].geometry.y == geometry.y)) {
+        return;
+    }
+    _drop_tiles_PlotrenderCtx(self);
+    if (num_tiles == 0) {
+        // Zero width window: nothing to draw
+        return;
+    }
+    self->tiles = xmallocarray(num_tiles, sizeof(Pixels_float));
+    self->tile_max_color_lum = xmallocarray(num_tiles, sizeof(float));
+    for (size_t i = 0; i < num_tiles; i++) {
+        int x0 = i * PLOT_TILE_WIDTH;
+        int x1 = MIN(x0 + PLOT_TILE_WIDTH, geometry.x);
+        self->tiles[i] = new_Pixels_float(vec2_int(x1 - x0, geometry.y));
+    }
+    self->num_tiles = num_tiles;
+}
+
 
 static
 u8 u8_from_float(float x, float max) {
@@ -233,6 +390,121 @@ float squared_color_float_from_u8(u8 col) {
 
 const bool showdebug = false;
 
+// What the tasks of one frame share.
+typedef struct _PlotFrame {
+    PlotrenderCtx *ctx;
+    Vec2(float) start;
+    Vec2(float) extent;
+    float height;
+} _PlotFrame;
+
+// Draw the samples for the screen columns of tiles `start..end` into
+// the tiles' own buffers.
+static
+void _draw_tiles_plot(void *_frame, size_t start, size_t end) {
+    _PlotFrame *frame = _frame;
+    PlotrenderCtx *ctx = frame->ctx;
+    float width = ctx->pixels.geometry.x;
+    // Is dx approach still OK with float and oversampling?
+    const float dx = frame->extent.x / (width * PLOT_OVERSAMPLING);
+    for (size_t t = start; t < end; t++) {
+        Pixels_float *tile = &ctx->tiles[t];
+        int x0 = t * PLOT_TILE_WIDTH;
+        int x1 = x0 + tile->geometry.x;
+        clear_Pixels_float(tile);
+        Vec2(float) points[PLOT_TILE_WIDTH * PLOT_OVERSAMPLING];
+        for (size_t j = 0; j < ctx->functions.len; j++) {
+            Color color = ctx->functions.ptr[j].color;
+            Vec3(float) colorf = vec3_float(squared_color_float_from_u8(color.r),
+                                            squared_color_float_from_u8(color.g),
+                                            squared_color_float_from_u8(color.b));
+            Option(float)(*f)(float) = ctx->functions.ptr[j].f;
+
+            size_t num_points = 0;
+            for (int i = x0 * PLOT_OVERSAMPLING;
+                 i < x1 * PLOT_OVERSAMPLING;
+                 i++) {
+                float x = frame->start.x + i * dx;
+                if_let_Some(y, f(x)) {
+                    // x position relative to the tile
+                    float xtile = i / PLOT_OVERSAMPLING - x0;
+                    float yscreen = (y - frame->start.y) / frame->extent.y
+                        * frame->height;
+                    points[num_points++] =
+                        vec2_float(xtile, frame->height - yscreen);
+                } else_None;
+            }
+            splat_points_Pixels_float(
+                tile,
+                (slice(Vec2(float))) { .ptr = points, .len = num_points },
+                colorf);
+        }
+    }
+}
+
+// Combine tiles `start..end` with the border columns of their
+// neighbours into `ctx->pixels`, and find the maximum brightness of
+// each tile.
+static
+void _merge_tiles_plot(void *_frame, size_t start, size_t end) {
+    _PlotFrame *frame = _frame;
+    PlotrenderCtx *ctx = frame->ctx;
+    int height = ctx->pixels.geometry.y;
+    for (size_t t = start; t < end; t++) {
+        const Pixels_float *tile = &ctx->tiles[t];
+        const Pixels_float *left = (t > 0) ? &ctx->tiles[t - 1] : NULL;
+        const Pixels_float *right =
+            (t + 1 < ctx->num_tiles) ? &ctx->tiles[t + 1] : NULL;
+        int x0 = t * PLOT_TILE_WIDTH;
+        int x1 = x0 + tile->geometry.x;
+        float max_color_lum = 0;
+        for (int y = 0; y < height; y++) {
+            const Vec3(float) *trow = row_Pixels_float(tile, y);
+            Vec3(float) *out = row_Pixels_float(&ctx->pixels, y);
+            for (int x = x0; x < x1; x++) {
+                Vec3(float) p = trow[x - x0];
+                if ((x == x0) && left) {
+                    p = add_Vec3_float(
+                        p, row_Pixels_float(left, y)[left->geometry.x]);
+                }
+                if ((x == x1 - 1) && right) {
+                    p = add_Vec3_float(p, row_Pixels_float(right, y)[-1]);
+                }
+                out[x] = p;
+                max_color_lum = MAX(max_color_lum, MAX(p.x, MAX(p.y, p.z)));
+            }
+        }
+        ctx->tile_max_color_lum[t] = max_color_lum;
+    }
+}
+
+typedef struct _PlotConvert {
+    const Pixels_float *pixels;
+    TextureLock lock;
+    float max_color_lum;
+} _PlotConvert;
+
+// Convert rows `start..end` of the accumulated light into the locked
+// ARGB8888 texture.
+static
+void _convert_rows_plot(void *_convert, size_t start, size_t end) {
+    _PlotConvert *convert = _convert;
+    int width = convert->pixels->geometry.x;
+    float max = convert->max_color_lum;
+    for (size_t y = start; y < end; y++) {
+        const Vec3(float) *row = row_Pixels_float(convert->pixels, y);
+        ARGB8888 *out = (ARGB8888*)((u8*)convert->lock.pixels
+                                    + y * convert->lock.pitch);
+        for (int x = 0; x < width; x++) {
+            Vec3(float) p = row[x];
+            out[x] = new_ARGB8888(255,
+                                  u8_from_float(p.x, max),
+                                  u8_from_float(p.y, max),
+                                  u8_from_float(p.z, max));
+        }
+    }
+}
+
 static UNUSED
 bool plot_render(SDL_Renderer* renderer, void* RESTRICT _ctx,
                  Vec2(int) window_dimensions) {
@@ -242,67 +514,54 @@ bool plot_render(SDL_Renderer* renderer, void* RESTRICT _ctx,
     ctx->viewport.start.x += 0.001;
     Vec2(float) extent = viewport->extent;
     possibly_resize_Pixels_float(&ctx->pixels, window_dimensions);
+    _possibly_resize_tiles_PlotrenderCtx(ctx);
+    if ((ctx->num_tiles == 0) || (window_dimensions.y <= 0)) {
+        // (e.g. minimized window) nothing to draw, and SDL can't
+        // create an empty texture
+        return true;
+    }
 
-    asserting_sdl(SDL_SetRenderDrawColor(renderer, 0,0,0, 128));
-    asserting_sdl(SDL_RenderClear(renderer));
-
-    float width = window_dimensions.x;
-    float height = window_dimensions.y;
+    _PlotFrame frame = {
+        .ctx = ctx,
+        .start = start,
+        .extent = extent,
+        .height = window_dimensions.y
+    };
+    ThreadPool *pool = default_ThreadPool();
+    parallel_for_ThreadPool(pool, ctx->num_tiles, 1, _draw_tiles_plot, &frame);
+    parallel_for_ThreadPool(pool, ctx->num_tiles, 1, _merge_tiles_plot, &frame);
 
-    // clear_Pixels_float(&ctx->pixels); -- now it's cleared below from previous frame already
     float max_color_lum = 0;
-
-    for (size_t j = 0; j < ctx->functions.len; j++) {
-        Color color = ctx->functions.ptr[j].color;
-        Vec3(float) colorf = vec3_float(squared_color_float_from_u8(color.r),
-                                        squared_color_float_from_u8(color.g),
-                                        squared_color_float_from_u8(color.b));
-        Option(float)(*f)(float) = ctx->functions.ptr[j].f;
-
-        const int oversampling = 16;
-        // Is dx approach still OK with float and oversampling?
-        const float dx = extent.x / (width * oversampling);
-        float x = start.x;
-        for (int i = 0; i < window_dimensions.x * oversampling; i++) {
-            if_let_Some(y, f(x)) {
-                float xscreen = i / oversampling;
-                float yscreen = (y - start.y) / extent.y * height;
-                draw_point_Pixels_float(&ctx->pixels,
-                                        vec2_float(xscreen, height - yscreen),
-                                        colorf,
-                                        &max_color_lum);
-            } else_None;
-            x += dx;
-        }
+    for (size_t t = 0; t < ctx->num_tiles; t++) {
+        max_color_lum = MAX(max_color_lum, ctx->tile_max_color_lum[t]);
     }
 
-    VertexRenderer *rdr = &ctx->rdr;
-    clear_VertexRenderer(rdr);
-
-    Vec3(float) * RESTRICT pixels = ctx->pixels.pixels; // vec3(R, G, B) [x + y*width]
-    for (int y = 0; y < window_dimensions.y; y++) {
-        for (int x = 0; x < window_dimensions.x; x++) {
-            Vec3(float) p = pixels[x + y * window_dimensions.x]; // XX vs at_Pixels_float ?
-            if ((p.x == 0.f) && (p.y == 0.f) && (p.z == 0.f)) {
-                // noop (most of the pixels)
-            } else {
-                AUTO col = ColorA(u8_from_float(p.x, max_color_lum),
-                                  u8_from_float(p.y, max_color_lum),
-                                  u8_from_float(p.z, max_color_lum),
-                                  255);
-                int p1 = push_vertex(rdr, vertex_2(vec2_float(x, y), col));
-                int p2 = push_vertex(rdr, vertex_2(vec2_float(x+1, y), col));
-                int p3 = push_vertex(rdr, vertex_2(vec2_float(x, y+1), col));
-                int p4 = push_vertex(rdr, vertex_2(vec2_float(x+1, y+1), col));
-                push_triangle(rdr, vec3_int(p1, p2, p3));
-                push_triangle(rdr, vec3_int(p2, p3, p4));
-                // Clear pixel for next frame, already, cheaper than memset ?:
-                pixels[x + y * window_dimensions.x] = vec3_float(0.f, 0.f, 0.f);
-            }
+    if (ctx->texture.is_some) {
+        int w, h;
+        asserting_sdl(SDL_QueryTexture(ctx->texture.value.ptr,
+                                       NULL, NULL, &w, &h));
+        if ((w != window_dimensions.x) || (h != window_dimensions.y)) {
+            drop_Option_Texture(ctx->texture);
+            ctx->texture = none_Texture();
         }
     }
-
-    render_VertexRenderer(renderer, rdr);
+    if (! ctx->texture.is_some) {
+        ctx->texture = some_Texture(
+            create_Texture(renderer,
+                           SDL_PIXELFORMAT_ARGB8888,
+                           SDL_TEXTUREACCESS_STREAMING,
+                           window_dimensions));
+    }
+    Texture *texture = &ctx->texture.value;
+    _PlotConvert convert = {
+        .pixels = &ctx->pixels,
+        .lock = lock_Texture(texture),
+        .max_color_lum = max_color_lum
+    };
+    parallel_for_ThreadPool(pool, window_dimensions.y, 0,
+                            _convert_rows_plot, &convert);
+    unlock_Texture(texture);
+    render_Texture(renderer, texture, none_Rect2_int(), none_Rect2_int());
 
     return true;
 }
@@ -313,6 +572,9 @@ bool plot_render(SDL_Renderer* renderer, void* RESTRICT _ctx,
 /// functions, which expect a float and return an optional float
 /// when possible. `viewport` is the (initial) range of coordinates
 /// that is shown on the screen.
+
+/// The functions are evaluated on multiple threads at the same time
+/// (see `default_ThreadPool`), so they must not modify global state.
 static UNUSED
 int plot_functions_float(slice(ColorFunction_float) fs,
                          Rect2(float) viewport) {
@@ -330,6 +592,9 @@ int plot_functions_float(slice(ColorFunction_float) fs,
 /// expects a float and returns an optional float when
 /// possible. `viewport` is the (initial) range of coordinates that is
 /// shown on the screen.
+
+/// `f` is evaluated on multiple threads at the same time (see
+/// `default_ThreadPool`), so it must not modify global state.
 static UNUSED
 int plot_function_float(Option(float)(*f)(float), Rect2(float) viewport) {
     AUTO geometry = vec2_int(800, 600);
@@ -0,0 +1,222 @@
+#pragma once
+
+//! Radix sort for slices of numbers: instead of comparing elements,
+//! it distributes them into 256 buckets by one byte of their value,
+//! from the least to the most significant byte. This takes O(n) time
+//! (at most one pass per byte of the number type, plus one to count),
+//! which for large inputs is a lot faster than comparison based
+//! sorting. `sort` (see [`cj50/gen/sort.h`](gen/sort.h.md)) uses it
+//! automatically for these types, for inputs with at least
+//! `_SORT_RADIX_MIN_LEN` elements.
+
+//! Floating point numbers are sorted by their bit patterns,
+//! reinterpreted so that their order matches the order of the
+//! numbers. This puts -0.0 before 0.0, and NaNs at the ends (at the
+//! start if their sign bit is set, at the end otherwise).
+
+//! All of these allocate a temporary buffer of the same size as the
+//! input.
+
+#include <string.h>
+#include <cj50/basic-util.h>
+#include <cj50/xmem.h>
+#include <cj50/u32.h>
+#include <cj50/u64.h>
+#include <cj50/instantiations/Vec_int.h>
+#include <cj50/instantiations/Vec_u32.h>
+#include <cj50/instantiations/Vec_u64.h>
+#include <cj50/instantiations/Vec_float.h>
+#include <cj50/instantiations/Vec_double.h>
+
+
+// The keys are accessed through the element arrays of other types,
+// hence need to be allowed to alias them.
+typedef u32 __attribute__((may_alias)) _radix_u32;
+typedef u64 __attribute__((may_alias)) _radix_u64;
+
+// Sort `keys[0..len)`, using `buf` which has room for `len` keys.
+static
+void _radix_sort_u32(_radix_u32 *keys, _radix_u32 *buf, size_t len) {
+    size_t counts[4][256] = { 0 };
+    for (size_t i = 0; i < len; i++) {
+        u32 k = keys[i];
+        for (int pass = 0; pass < 4; pass++) {
+            counts[pass][(k >> (pass * 8)) & 255]++;
+        }
+    }
+    _radix_u32 *src = keys, *dst = buf;
+    for (int pass = 0; pass < 4; pass++) {
+        size_t *count = counts[pass];
+        int shift = pass * 8;
+        // All keys have the same byte here: nothing to do
+        if (count[(src[0] >> shift) & 255] == len) {
+            continue;
+        }
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < len; i++) {
+            u32 k = src[i];
+            dst[count[(k >> shift) & 255]++] = k;
+        }
+        _radix_u32 *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != keys) {
+        memcpy(keys, src, len * sizeof(u32));
+    }
+}
+
+// Sort `keys[0..len)`, using `buf` which has room for `len` keys.
+static
+void _radix_sort_u64(_radix_u64 *keys, _radix_u64 *buf, size_t len) {
+    size_t (*counts)[256] = xcallocarray(8 * 256, sizeof(size_t));
+    for (size_t i = 0; i < len; i++) {
+        u64 k = keys[i];
+        for (int pass = 0; pass < 8; pass++) {
+            counts[pass][(k >> (pass * 8)) & 255]++;
+        }
+    }
+    _radix_u64 *src = keys, *dst = buf;
+    for (int pass = 0; pass < 8; pass++) {
+        size_t *count = counts[pass];
+        int shift = pass * 8;
+        if (count[(src[0] >> shift) & 255] == len) {
+            continue;
+        }
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < len; i++) {
+            u64 k = src[i];
+            dst[count[(k >> shift) & 255]++] = k;
+        }
+        _radix_u64 *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != keys) {
+        memcpy(keys, src, len * sizeof(u64));
+    }
+    xfree(counts);
+}
+
+// Sign-magnitude floating point bits to keys whose unsigned order
+// matches, and back.
+static inline
+u32 _radix_key_from_float_bits(u32 k) {
+    return (k >> 31) ? ~k : (k | 0x80000000);
+}
+
+static inline
+u32 _radix_float_bits_from_key(u32 k) {
+    return (k >> 31) ? (k & 0x7fffffff) : ~k;
+}
+
+static inline
+u64 _radix_key_from_double_bits(u64 k) {
+    return (k >> 63) ? ~k : (k | 0x8000000000000000);
+}
+
+static inline
+u64 _radix_double_bits_from_key(u64 k) {
+    return (k >> 63) ? (k & 0x7fffffffffffffff) : ~k;
+}
+
+
+/// Sort the numbers in ascending order.
+
+static UNUSED
+void radix_sort_mutslice_u32(mutslice(u32) self) {
+    size_t len = self.len;
+    if (len < 2) {
+        return;
+    }
+    _radix_u32 *buf = xmallocarray(len, sizeof(u32));
+    _radix_sort_u32(self.ptr, buf, len);
+    xfree(buf);
+}
+
+/// Sort the numbers in ascending order.
+
+static UNUSED
+void radix_sort_mutslice_u64(mutslice(u64) self) {
+    size_t len = self.len;
+    if (len < 2) {
+        return;
+    }
+    _radix_u64 *buf = xmallocarray(len, sizeof(u64));
+    _radix_sort_u64(self.ptr, buf, len);
+    xfree(buf);
+}
+
+/// Sort the numbers in ascending order.
+
+static UNUSED
+void radix_sort_mutslice_int(mutslice(int) self) {
+    size_t len = self.len;
+    if (len < 2) {
+        return;
+    }
+    // Flipping the sign bit makes the order of two's complement
+    // numbers match the unsigned order
+    _radix_u32 *keys = (_radix_u32 *)self.ptr;
+    for (size_t i = 0; i < len; i++) {
+        keys[i] ^= 0x80000000;
+    }
+    _radix_u32 *buf = xmallocarray(len, sizeof(u32));
+    _radix_sort_u32(keys, buf, len);
+    xfree(buf);
+    for (size_t i = 0; i < len; i++) {
+        keys[i] ^= 0x80000000;
+    }
+}
+
+/// Sort the numbers in ascending order (see above about -0.0 and
+/// NaN).
+
+static UNUSED
+void radix_sort_mutslice_float(mutslice(float) self) {
+    size_t len = self.len;
+    if (len < 2) {
+        return;
+    }
+    _radix_u32 *keys = (_radix_u32 *)self.ptr;
+    for (size_t i = 0; i < len; i++) {
+        keys[i] = _radix_key_from_float_bits(keys[i]);
+    }
+    _radix_u32 *buf = xmallocarray(len, sizeof(u32));
+    _radix_sort_u32(keys, buf, len);
+    xfree(buf);
+    for (size_t i = 0; i < len; i++) {
+        keys[i] = _radix_float_bits_from_key(keys[i]);
+    }
+}
+
+/// Sort the numbers in ascending order (see above about -0.0 and
+/// NaN).
+
+static UNUSED
+void radix_sort_mutslice_double(mutslice(double) self) {
+    size_t len = self.len;
+    if (len < 2) {
+        return;
+    }
+    _radix_u64 *keys = (_radix_u64 *)self.ptr;
+    for (size_t i = 0; i < len; i++) {
+        keys[i] = _radix_key_from_double_bits(keys[i]);
+    }
+    _radix_u64 *buf = xmallocarray(len, sizeof(u64));
+    _radix_sort_u64(keys, buf, len);
+    xfree(buf);
+    for (size_t i = 0; i < len; i++) {
+        keys[i] = _radix_double_bits_from_key(keys[i]);
+    }
+}
@@ -2,74 +2,350 @@
 
 //! Functions for getting good random numbers.
 
+//! The numbers come from a pseudo random number generator
+//! (xoshiro256++, see <https://prng.di.unimi.it/>), which is very
+//! fast and has good statistical properties, but is not suitable for
+//! cryptographic purposes. Each thread has its own generator (see
+//! `thread_Rng`), which is seeded from the operating system's random
+//! source the first time it is used. Functions taking an explicit
+//! `Rng*` are also available.
+
+//! For reproducible runs, set the `CJ50_SEED` environment variable
+//! to a number (this is picked up by the `MAIN` macro, otherwise call
+//! `seed_random_from_env` or `seed_random`). Threads started with
+//! `spawn_thread` then get their own deterministic streams, split off
+//! from the generator of the thread that spawned them.
+
 #include <sys/random.h>
 #include <cj50/basic-util.h>
+#include <cj50/u64.h>
+#include <cj50/instantiations/Vec_int.h>
+#include <cj50/instantiations/Vec_float.h>
+#include <cj50/instantiations/Vec_double.h>
 
-/// Get a random integer value between 0 (inclusive) and `range` (exclusive).
-int random_int(int range) {
-    // Note: this prohibits ever returning the MAXINT value.  Note:
-    // this may block when run before the random number source has
-    // entropy or is initialized.
 
-    if (range < 1) {
-        DIE_("random_int: argument not in nat range: %i", range);
-    }
-    unsigned int urange = range;
-    assert(sizeof(urange) == 32/8); // necessary for __builtin_clz ?
-    unsigned int nlz = __builtin_clz(urange);
-    unsigned int mask = (1u << (32 - nlz)) - 1;
+/// The state of a pseudo random number generator. Use
+/// `new_Rng` to create one.
 
-    unsigned int randnum;
-    while (true) {
+typedef struct Rng {
+    uint64_t s[4];
+} Rng;
+
+// Fill `buf` with random bytes from the operating system.
+static
+void _os_random_bytes(void *buf, size_t len) {
 #ifdef __APPLE__
-        srandomdev();
-        randnum = (unsigned int)random();
+    arc4random_buf(buf, len);
 #else
-        ssize_t res = getrandom(&randnum, sizeof(randnum), 0);
-        if (res < 0) {
-            DIE_("getrandom: %s", strerror(errno));
+    // Note: this may block when run before the random number source
+    // has entropy or is initialized.
+    ssize_t res = getrandom(buf, len, 0);
+    if (res < 0) {
+        DIE_("getrandom: %s", strerror(errno));
+    }
+    if ((size_t)res != len) {
+        DIE_("getrandom: expected %lu bytes, got %li", len, res);
+    }
+#endif
+}
+
+/// Create a new random number generator, seeded from the operating
+/// system's random source.
+
+static UNUSED
+Rng new_Rng() {
+    Rng rng;
+    do {
+        _os_random_bytes(rng.s, sizeof(rng.s));
+        // The all-zero state is the only invalid one.
+    } while (!(rng.s[0] | rng.s[1] | rng.s[2] | rng.s[3]));
+    return rng;
+}
+
+static UNUSED
+void drop_Rng(UNUSED Rng rng) {}
+
+// https://prng.di.unimi.it/splitmix64.c
+static inline
+uint64_t _splitmix64_next(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+/// Create a new random number generator from the given `seed`. The
+/// same seed always gives the same sequence of numbers.
+
+static UNUSED
+Rng new_Rng_from_seed(uint64_t seed) {
+    Rng rng;
+    // splitmix64 never returns four zeroes in a row, so the state is
+    // valid.
+    for (int i = 0; i < 4; i++) {
+        rng.s[i] = _splitmix64_next(&seed);
+    }
+    return rng;
+}
+
+static inline
+uint64_t _rotl_u64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/// Get the next 64 random bits from `rng`.
+
+static inline UNUSED
+uint64_t next_u64_Rng(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = _rotl_u64(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = _rotl_u64(s[3], 45);
+    return result;
+}
+
+/// Advance `rng` by 2^128 steps, as if `next_u64_Rng` had been called
+/// that many times.
+
+static UNUSED
+void jump_Rng(Rng *rng) {
+    static const uint64_t JUMP[] = {
+        0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+        0xa9582618e03fc9aa, 0x39abdc4529b1661c
+    };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & ((uint64_t)1 << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            next_u64_Rng(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+/// Split off a new stream: returns a generator that continues from the
+/// current state of `rng`, and moves `rng` 2^128 numbers ahead. The
+/// two streams won't overlap in practice. Calling this N times gives N
+/// independent, deterministic streams, e.g. one per worker thread.
+
+static UNUSED
+Rng split_Rng(Rng *rng) {
+    Rng r = *rng;
+    jump_Rng(rng);
+    return r;
+}
+
+/// Get the next 32 random bits from `rng`.
+
+static inline UNUSED
+uint32_t next_u32_Rng(Rng *rng) {
+    // The upper bits are the better ones.
+    return next_u64_Rng(rng) >> 32;
+}
+
+/// Get a random integer value between 0 (inclusive) and `range`
+/// (exclusive), without bias. `range` must not be 0.
+
+/// Uses Lemire's multiply-and-reject method, which only needs a
+/// division in the rare case of a candidate rejection.
+
+static UNUSED
+uint64_t random_u64_Rng(Rng *rng, uint64_t range) {
+    assert(range > 0);
+    unsigned __int128 m = (unsigned __int128)next_u64_Rng(rng) * range;
+    uint64_t l = (uint64_t)m;
+    if (l < range) {
+        uint64_t threshold = -range % range;
+        while (l < threshold) {
+            m = (unsigned __int128)next_u64_Rng(rng) * range;
+            l = (uint64_t)m;
         }
-        if (sizeof(randnum) != res) {
-            DIE_("getrandom: expected %lu bytes, got %li",
-                 sizeof(randnum), res);
+    }
+    return m >> 64;
+}
+
+/// Get a random integer value between 0 (inclusive) and `range`
+/// (exclusive), without bias. `range` must not be 0.
+
+static UNUSED
+uint32_t random_u32_Rng(Rng *rng, uint32_t range) {
+    assert(range > 0);
+    uint64_t m = (uint64_t)next_u32_Rng(rng) * range;
+    uint32_t l = (uint32_t)m;
+    if (l < range) {
+        uint32_t threshold = -range % range;
+        while (l < threshold) {
+            m = (uint64_t)next_u32_Rng(rng) * range;
+            l = (uint32_t)m;
         }
-#endif
-        int ret = randnum & mask;
-        // printf("randnum=%u, mask=%u, ret=%i\n", randnum, mask, ret);
-        if (ret < range) {
-            return ret;
+    }
+    return m >> 32;
+}
+
+/// Get a random integer value between 0 (inclusive) and `range`
+/// (exclusive).
+
+static UNUSED
+int random_int_Rng(Rng *rng, int range) {
+    if (range < 1) {
+        DIE_("random_int: argument not in nat range: %i", range);
+    }
+    return random_u32_Rng(rng, range);
+}
+
+/// Get a random real value (as double precision floating point type)
+/// between 0. (inclusive) and 1. (exclusive). All 2^53 possible
+/// values are equally likely.
+
+static inline UNUSED
+double random_double_Rng(Rng *rng) {
+    return (next_u64_Rng(rng) >> 11) * 0x1.0p-53;
+}
+
+/// Get a random real value (as single precision floating point type)
+/// between 0. (inclusive) and 1. (exclusive). All 2^24 possible
+/// values are equally likely.
+
+static inline UNUSED
+float random_float_Rng(Rng *rng) {
+    return (next_u64_Rng(rng) >> 40) * 0x1.0p-24f;
+}
+
+
+/// Append `n` random integer values between 0 (inclusive) and
+/// `range` (exclusive) to `v`.
+
+static UNUSED
+void fill_random_Vec_int(Vec(int) *v, size_t n, int range, Rng *rng) {
+    if (range < 1) {
+        DIE_("fill_random_Vec_int: argument not in nat range: %i", range);
+    }
+    reserve_Vec_int(v, n);
+    int *out = v->ptr + v->len;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = random_u32_Rng(rng, range);
+    }
+    v->len += n;
+}
+
+/// Append `n` random real values between 0. (inclusive) and 1.
+/// (exclusive) to `v`.
+
+static UNUSED
+void fill_random_Vec_double(Vec(double) *v, size_t n, Rng *rng) {
+    reserve_Vec_double(v, n);
+    double *out = v->ptr + v->len;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = random_double_Rng(rng);
+    }
+    v->len += n;
+}
+
+/// Append `n` random real values between 0. (inclusive) and 1.
+/// (exclusive) to `v`.
+
+static UNUSED
+void fill_random_Vec_float(Vec(float) *v, size_t n, Rng *rng) {
+    reserve_Vec_float(v, n);
+    float *out = v->ptr + v->len;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = random_float_Rng(rng);
+    }
+    v->len += n;
+}
+
+
+static __thread Rng _thread_rng;
+static __thread bool _thread_rng_initialized = false;
+
+// Set by `seed_random`.
+static bool _random_is_seeded = false;
+static uint64_t _random_seed;
+// The number of streams handed out to threads that initialized their
+// generator lazily, while seeded.
+static uint64_t _random_num_streams = 0;
+
+/// The random number generator of the current thread, seeded on first
+/// use.
+
+static UNUSED
+Rng *thread_Rng() {
+    if (__builtin_expect(!_thread_rng_initialized, 0)) {
+        if (_random_is_seeded) {
+            // A thread not started via `spawn_thread`: deterministic
+            // only if such threads start in a deterministic order.
+            uint64_t k = __atomic_fetch_add(&_random_num_streams, 1,
+                                            __ATOMIC_RELAXED);
+            _thread_rng = new_Rng_from_seed(_random_seed ^
+                                            _splitmix64_next(&k));
+        } else {
+            _thread_rng = new_Rng();
+        }
+        _thread_rng_initialized = true;
+    }
+    return &_thread_rng;
+}
+
+/// Make the numbers from `random_int`, `random_double` etc. in the
+/// current thread, and in threads started from it afterwards with
+/// `spawn_thread`, reproducible: they are fully determined by
+/// `seed`.
+
+static UNUSED
+void seed_random(uint64_t seed) {
+    _random_seed = seed;
+    _random_is_seeded = true;
+    _random_num_streams = 1;
+    _thread_rng = new_Rng_from_seed(seed);
+    _thread_rng_initialized = true;
+}
+
+/// If the environment variable with the given name is set to a
+/// non-empty string, parse it as an unsigned number and call
+/// `seed_random` with it. Dies if the value is not a number. `MAIN`
+/// calls this with `"CJ50_SEED"`.
+
+static UNUSED
+void seed_random_from_env(cstr varname) {
+    cstr val = getenv(varname);
+    if (val && val[0]) {
+        char *end;
+        errno = 0;
+        unsigned long long seed = strtoull(val, &end, 0);
+        if (errno || *end || val[0] == '-') {
+            DIE_("%s: not a valid seed: '%s'", varname, val);
         }
+        seed_random(seed);
     }
 }
 
-// CAUTION: These are probably suboptimal (distribution of bits)!
-// Consider them a HACK.
+
+/// Get a random integer value between 0 (inclusive) and `range` (exclusive).
+int random_int(int range) {
+    return random_int_Rng(thread_Rng(), range);
+}
 
 /// Get a random real value (as double precision floating point type)
 /// between 0. (inclusive) and 1. (exclusive).
 double random_double() {
-    uint64_t randnum;
-#ifdef __APPLE__
-    srandomdev();
-    uint32_t r0 = (unsigned int)random();;
-    uint32_t r1 = (unsigned int)random();;
-    randnum = r0 + r1 << 32;
-#else
-    ssize_t res = getrandom(&randnum, sizeof(randnum), 0);
-    if (res < 0) {
-        DIE_("getrandom: %s", strerror(errno));
-    }
-    if (sizeof(randnum) != res) {
-        DIE_("getrandom: expected %lu bytes, got %li",
-             sizeof(randnum), res);
-    }
-#endif
-    return randnum / 18446744073709551616.;
+    return random_double_Rng(thread_Rng());
 }
 
 /// Get a random real value (as single precision floating point type)
 /// between 0. (inclusive) and 1. (exclusive).
 float random_float() {
-    return random_double();
+    return random_float_Rng(thread_Rng());
 }
-
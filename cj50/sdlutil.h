@@ -313,7 +313,7 @@ void graphics_render(cstr title,
                  SDL_GetError(),
                  err1);
         }
-        free(err1);
+        xfree(err1);
         need_sleep = true;
     }
     if (need_sleep && ! getenv("SILENT")) {
@@ -625,7 +625,9 @@ GENERATE_ref(Vertex);
 GENERATE_Option(ref(Vertex));
 
 #define T Vertex
+#define IS_TRIVIAL_DROP
 #include <cj50/gen/template/Vec.h>
+#undef IS_TRIVIAL_DROP
 #undef T
 
 
@@ -805,6 +807,35 @@ void update_Texture(Texture *self,
                       pitch));
 }
 
+/// The pixels of a texture while it is locked, see `lock_Texture`.
+/// `pitch` is the number of bytes in a row of pixels, including
+/// padding.
+
+typedef struct TextureLock {
+    void *pixels;
+    int pitch;
+} TextureLock;
+
+/// Lock the whole texture, which must have been created with
+/// `SDL_TEXTUREACCESS_STREAMING`, for writing pixel data directly
+/// into the memory that is uploaded by `unlock_Texture`, avoiding
+/// the extra copy `update_Texture` makes. The previous contents are
+/// not preserved, so all pixels must be written.
+
+static UNUSED
+TextureLock lock_Texture(Texture *self) {
+    TextureLock lock;
+    asserting_sdl(SDL_LockTexture(self->ptr, NULL, &lock.pixels, &lock.pitch));
+    return lock;
+}
+
+/// Unlock a texture locked by `lock_Texture`, uploading the changes.
+
+static UNUSED
+void unlock_Texture(Texture *self) {
+    SDL_UnlockTexture(self->ptr);
+}
+
 /// Copy a portion of the texture to the current rendering target.
 
 static UNUSED
@@ -13,6 +13,11 @@ bool equal_move_size_t(const size_t a, const size_t b) {
     return a == b;
 }
 
+static UNUSED
+int cmp_size_t(const size_t *a, const size_t *b) {
+    return (*a > *b) - (*a < *b);
+}
+
 static UNUSED
 void drop_size_t(const size_t UNUSED a) {}
 
@@ -26,5 +31,10 @@ int print_debug_size_t(const size_t *n) {
     return print_size_t(*n);
 }
 
+static UNUSED
+int fprintln_size_t(FILE *out, const size_t *n) {
+    return fprintf(out, "%zu\n", *n);
+}
+
 
 GENERATE_Option(size_t);
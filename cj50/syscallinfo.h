@@ -40,6 +40,13 @@ const SyscallInfo syscallinfos[] = {
     { 11, 3, "fmemopen" },
     { 12, 3, "pthread_create" }, // POSIX threads but it's in section 3 ??
     { 13, 3, "pthread_join" },
+    { 14, 2, "mmap" },
+    { 15, 3, "pthread_attr_setstacksize" },
+    { 16, 2, "sched_setaffinity" },
+    { 17, 2, "setpriority" },
+    { 18, 2, "prctl" },
+    { 19, 3, "pthread_getcpuclockid" },
+    { 20, 2, "clock_gettime" },
 };
 
 // `syscallInfoId_t` identifies a SyscallInfo instance
@@ -59,4 +66,11 @@ typedef uint16_t syscallInfoId_t;
 #define SYSCALLINFO_fmemopen (syscallinfos[11])
 #define SYSCALLINFO_pthread_create (syscallinfos[12])
 #define SYSCALLINFO_pthread_join (syscallinfos[13])
+#define SYSCALLINFO_mmap (syscallinfos[14])
+#define SYSCALLINFO_pthread_attr_setstacksize (syscallinfos[15])
+#define SYSCALLINFO_sched_setaffinity (syscallinfos[16])
+#define SYSCALLINFO_setpriority (syscallinfos[17])
+#define SYSCALLINFO_prctl (syscallinfos[18])
+#define SYSCALLINFO_pthread_getcpuclockid (syscallinfos[19])
+#define SYSCALLINFO_clock_gettime (syscallinfos[20])
 
@@ -0,0 +1,423 @@
+#pragma once
+
+//! A `ThreadPool` runs work on a fixed set of worker threads that are
+//! started once and then reused, instead of creating a thread per
+//! piece of work like `spawn_thread` does.
+
+//! Work is handed out as index ranges (see
+//! `parallel_for_ThreadPool`). Each worker has its own queue
+//! (deque); a worker splits a large range into halves, keeps working
+//! on one half and pushes the other onto its own queue. Workers that
+//! run out of work steal the largest pending range from the other
+//! queues ("work stealing"), so load is balanced automatically even
+//! when items take very different amounts of time.
+
+//! Also see [cj50/gen/parallel.h](gen/parallel.h.md) for
+//! `parallel_for`, `parallel_map` and `parallel_reduce` on slices.
+
+#include <pthread.h>
+#include <unistd.h>
+#include <cj50/os.h>
+#include <cj50/xmem.h>
+#include <cj50/basic-util.h>
+#include <cj50/gen/Result.h>
+#include <cj50/random.h>
+#include <cj50/futex.h>
+
+
+// The progress of one `parallel_for_ThreadPool` call, shared by all
+// of its tasks; lives on the stack of the calling thread.
+typedef struct _PoolJob {
+    // Number of indices not yet processed (atomic).
+    size_t remaining;
+    // Set to 1 (and woken) once `remaining` reaches 0; the calling
+    // thread waits on it.
+    u32 done;
+} _PoolJob;
+
+// A range of indices to be processed by calling `run(ctx, start,
+// end)`, in chunks of about `grain` indices.
+typedef struct _PoolTask {
+    void (*run)(void *ctx, size_t start, size_t end);
+    void *ctx;
+    size_t start;
+    size_t end;
+    size_t grain;
+    _PoolJob *job;
+    // The random generator state of the thread that started the
+    // work, so that workers use reproducible streams.
+    Rng rng;
+} _PoolTask;
+
+// A double ended queue of tasks, as a ring buffer. The owning worker
+// pushes and pops at the back, thieves take from the front.
+typedef struct _PoolDeque {
+    pthread_mutex_t lock;
+    _PoolTask *tasks;
+    size_t cap; // power of 2
+    size_t head;
+    size_t len;
+} __attribute__((aligned(64))) _PoolDeque;
+
+typedef struct _ThreadPoolState {
+    size_t num_threads;
+    // How many of `threads` have been started.
+    size_t num_started;
+    pthread_t *threads;
+    // One deque per worker, plus one (the last) shared by threads
+    // that are not workers of this pool.
+    _PoolDeque *deques;
+    size_t num_queued; // atomic
+    size_t num_sleeping; // atomic
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t sleep_cond;
+    bool shutdown;
+} _ThreadPoolState;
+
+/// A fixed set of worker threads. Create with `new_ThreadPool`, or
+/// use the shared one from `default_ThreadPool`.
+
+typedef struct ThreadPool {
+    _ThreadPoolState *state;
+} ThreadPool;
+
+// The pool that the current thread is a worker of, and its index.
+static __thread _ThreadPoolState *_pool_current = NULL;
+static __thread size_t _pool_worker_index;
+
+
+static
+void _push_PoolDeque(_PoolDeque *d, _PoolTask task) {
+    pthread_mutex_lock(&d->lock);
+    if (d->len == d->cap) {
+        size_t cap2 = d->cap ? 2 * d->cap : 16;
+        _PoolTask *tasks2 = xmallocarray(cap2, sizeof(_PoolTask));
+        for (size_t i = 0; i < d->len; i++) {
+            tasks2[i] = d->tasks[(d->head + i) & (d->cap - 1)];
+        }
+        xfree(d->tasks);
+        d->tasks = tasks2;
+        d->cap = cap2;
+        d->head = 0;
+    }
+    d->tasks[(d->head + d->len) & (d->cap - 1)] = task;
+    __atomic_store_n(&d->len, d->len + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&d->lock);
+}
+
+static
+bool _pop_back_PoolDeque(_PoolDeque *d, _PoolTask *out) {
+    bool got = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->len) {
+        __atomic_store_n(&d->len, d->len - 1, __ATOMIC_RELAXED);
+        *out = d->tasks[(d->head + d->len) & (d->cap - 1)];
+        got = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return got;
+}
+
+static
+bool _pop_front_PoolDeque(_PoolDeque *d, _PoolTask *out) {
+    bool got = false;
+    // Cheap check without the lock first, as thieves look at all
+    // deques.
+    if (__atomic_load_n(&d->len, __ATOMIC_RELAXED) == 0) {
+        return false;
+    }
+    pthread_mutex_lock(&d->lock);
+    if (d->len) {
+        *out = d->tasks[d->head];
+        d->head = (d->head + 1) & (d->cap - 1);
+        __atomic_store_n(&d->len, d->len - 1, __ATOMIC_RELAXED);
+        got = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return got;
+}
+
+
+// The deque the current thread pushes to in pool `p`.
+static
+_PoolDeque *_own_deque(_ThreadPoolState *p) {
+    return &p->deques[(_pool_current == p) ? _pool_worker_index
+                      : p->num_threads];
+}
+
+static
+void _push_task(_ThreadPoolState *p, _PoolTask task) {
+    // Count first, so that num_queued never goes below the real count.
+    __atomic_fetch_add(&p->num_queued, 1, __ATOMIC_SEQ_CST);
+    _push_PoolDeque(_own_deque(p), task);
+    if (__atomic_load_n(&p->num_sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&p->sleep_lock);
+        pthread_cond_signal(&p->sleep_cond);
+        pthread_mutex_unlock(&p->sleep_lock);
+    }
+}
+
+// Get a task: from our own deque first, then steal from the others,
+// starting at a different one each time.
+static
+bool _find_task(_ThreadPoolState *p, _PoolTask *out, size_t *steal_start) {
+    _PoolDeque *own = _own_deque(p);
+    bool got = _pop_back_PoolDeque(own, out);
+    size_t n = p->num_threads + 1;
+    for (size_t i = 0; (!got) && (i < n); i++) {
+        _PoolDeque *d = &p->deques[(*steal_start + i) % n];
+        if (d != own) {
+            got = _pop_front_PoolDeque(d, out);
+        }
+    }
+    (*steal_start)++;
+    if (got) {
+        __atomic_fetch_sub(&p->num_queued, 1, __ATOMIC_SEQ_CST);
+    }
+    return got;
+}
+
+static
+void _run_task(_ThreadPoolState *p, _PoolTask task) {
+    // Keep half of the range to ourselves, offer the other half to
+    // thieves, until the range is small enough.
+    while (task.end - task.start > task.grain) {
+        size_t mid = task.start + (task.end - task.start) / 2;
+        _PoolTask right = task;
+        right.start = mid;
+        right.rng = split_Rng(&task.rng);
+        _push_task(p, right);
+        task.end = mid;
+    }
+    Rng saved_rng = *thread_Rng();
+    *thread_Rng() = task.rng;
+    task.run(task.ctx, task.start, task.end);
+    *thread_Rng() = saved_rng;
+    _PoolJob *job = task.job;
+    size_t n = task.end - task.start;
+    if (__atomic_sub_fetch(&job->remaining, n, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+        // `job` may be gone once `done` is set; waking on its address
+        // does not access it.
+        futex_wake(&job->done, 1);
+    }
+}
+
+static
+void *_worker_ThreadPool(void *arg) {
+    _ThreadPoolState *p = arg;
+    size_t steal_start = _pool_worker_index + 1;
+    while (true) {
+        _PoolTask task;
+        if (_find_task(p, &task, &steal_start)) {
+            _run_task(p, task);
+            continue;
+        }
+        pthread_mutex_lock(&p->sleep_lock);
+        __atomic_fetch_add(&p->num_sleeping, 1, __ATOMIC_SEQ_CST);
+        while ((__atomic_load_n(&p->num_queued, __ATOMIC_SEQ_CST) == 0)
+               && !p->shutdown) {
+            pthread_cond_wait(&p->sleep_cond, &p->sleep_lock);
+        }
+        __atomic_fetch_sub(&p->num_sleeping, 1, __ATOMIC_SEQ_CST);
+        bool shutdown = p->shutdown;
+        pthread_mutex_unlock(&p->sleep_lock);
+        if (shutdown) {
+            return NULL;
+        }
+    }
+}
+
+// Passed to a new worker thread; freed by it.
+typedef struct _WorkerStart {
+    _ThreadPoolState *pool;
+    size_t index;
+} _WorkerStart;
+
+static
+void *_start_worker_ThreadPool(void *arg) {
+    _WorkerStart start = *(_WorkerStart*)arg;
+    xfree(arg);
+    _pool_current = start.pool;
+    _pool_worker_index = start.index;
+    return _worker_ThreadPool(start.pool);
+}
+
+
+static UNUSED
+void drop_ThreadPool(ThreadPool self) {
+    _ThreadPoolState *p = self.state;
+    pthread_mutex_lock(&p->sleep_lock);
+    p->shutdown = true;
+    pthread_cond_broadcast(&p->sleep_cond);
+    pthread_mutex_unlock(&p->sleep_lock);
+    for (size_t i = 0; i < p->num_started; i++) {
+        int err = pthread_join(p->threads[i], NULL);
+        if (err) {
+            DIE_("drop_ThreadPool: pthread_join: %s", strerror(err));
+        }
+    }
+    for (size_t i = 0; i <= p->num_threads; i++) {
+        pthread_mutex_destroy(&p->deques[i].lock);
+        xfree(p->deques[i].tasks);
+    }
+    pthread_mutex_destroy(&p->sleep_lock);
+    pthread_cond_destroy(&p->sleep_cond);
+    xfree(p->deques);
+    xfree(p->threads);
+    xfree(p);
+}
+
+static UNUSED
+bool equal_ThreadPool(const ThreadPool *a, const ThreadPool *b) {
+    return a->state == b->state;
+}
+
+static UNUSED
+int print_debug_ThreadPool(const ThreadPool *v) {
+    INIT_RESRET;
+    RESRET(printf("ThreadPool(%zu)", v->state->num_threads));
+cleanup:
+    return ret;
+}
+
+GENERATE_Result(ThreadPool, SystemError);
+
+// Zero-initialized, cache line aligned array of `n` deques.
+static
+_PoolDeque *_new_PoolDeques(size_t n) {
+    _PoolDeque *ds = aligned_alloc(_Alignof(_PoolDeque), n * sizeof(_PoolDeque));
+    if (! ds) {
+        die_outofmemory();
+    }
+    memset(ds, 0, n * sizeof(_PoolDeque));
+    return ds;
+}
+
+/// Start a pool with `num_threads` worker threads. If `num_threads`
+/// is 0, the number of online CPUs is used.
+
+static UNUSED
+Result(ThreadPool, SystemError) new_ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (n > 0) ? n : 1;
+    }
+    _ThreadPoolState *p = xmalloc(sizeof(_ThreadPoolState));
+    *p = (_ThreadPoolState) {
+        .num_threads = num_threads,
+        .num_started = 0,
+        .threads = xmallocarray(num_threads, sizeof(pthread_t)),
+        .deques = _new_PoolDeques(num_threads + 1),
+        .num_queued = 0,
+        .num_sleeping = 0,
+        .shutdown = false
+    };
+    for (size_t i = 0; i <= num_threads; i++) {
+        pthread_mutex_init(&p->deques[i].lock, NULL);
+    }
+    pthread_mutex_init(&p->sleep_lock, NULL);
+    pthread_cond_init(&p->sleep_cond, NULL);
+    for (size_t i = 0; i < num_threads; i++) {
+        _WorkerStart *start = xmalloc(sizeof(_WorkerStart));
+        *start = (_WorkerStart) { .pool = p, .index = i };
+        int err = pthread_create(&p->threads[i], NULL,
+                                 _start_worker_ThreadPool, start);
+        if (err) {
+            xfree(start);
+            // Only the threads started so far need to be shut down.
+            drop_ThreadPool((ThreadPool) { .state = p });
+            return Err(ThreadPool, SystemError)(
+                systemError(SYSCALLINFO_pthread_create, err));
+        }
+        p->num_started = i + 1;
+    }
+    return Ok(ThreadPool, SystemError)((ThreadPool) { .state = p });
+}
+
+/// The number of worker threads in the pool.
+
+static UNUSED
+size_t num_threads_ThreadPool(const ThreadPool *self) {
+    return self->state->num_threads;
+}
+
+/// Call `run(ctx, start, end)` for disjoint ranges `start..end` that
+/// together cover `0..len`, on the worker threads of the pool and the
+/// calling thread, and wait until all of them have finished. Ranges
+/// are at most `grain` indices long (if `grain` is 0, a size giving
+/// a few ranges per thread is chosen).
+
+/// The calling thread works on the ranges too, so this may also be
+/// called from within `run` (nested parallelism) without deadlocking.
+
+/// `thread_Rng()` during `run` gives a generator split off the
+/// calling thread's one per range, so results using it are
+/// reproducible when seeded (see `seed_random`), independent of
+/// which thread ends up running which range.
+
+static UNUSED
+void parallel_for_ThreadPool(ThreadPool *self,
+                             size_t len,
+                             size_t grain,
+                             void (*run)(void *ctx, size_t start, size_t end),
+                             void *ctx) {
+    if (len == 0) {
+        return;
+    }
+    _ThreadPoolState *p = self->state;
+    if (grain == 0) {
+        grain = len / (8 * (p->num_threads + 1));
+        if (grain == 0) {
+            grain = 1;
+        }
+    }
+    _PoolJob job = { .remaining = len, .done = 0 };
+    _PoolTask task = {
+        .run = run,
+        .ctx = ctx,
+        .start = 0,
+        .end = len,
+        .grain = grain,
+        .job = &job,
+        .rng = split_Rng(thread_Rng())
+    };
+    _run_task(p, task);
+    // Help with the remaining ranges (of this or other calls), or,
+    // when there is nothing left to take, sleep until the ranges
+    // that other threads are working on are finished. (Ranges that
+    // those threads split off later are picked up by the pool's
+    // workers, which are woken for them.)
+    size_t steal_start = 0;
+    while (! __atomic_load_n(&job.done, __ATOMIC_ACQUIRE)) {
+        _PoolTask t;
+        if (_find_task(p, &t, &steal_start)) {
+            _run_task(p, t);
+        } else {
+            futex_wait(&job.done, 0, NULL);
+        }
+    }
+}
+
+
+static ThreadPool _default_ThreadPool;
+static pthread_once_t _default_ThreadPool_once = PTHREAD_ONCE_INIT;
+
+static
+void _init_default_ThreadPool() {
+    AUTO r = new_ThreadPool(0);
+    if (! r.is_ok) {
+        DIE_("default_ThreadPool: pthread_create: %s",
+             strerror(r.err.oserror.number));
+    }
+    _default_ThreadPool = r.ok;
+}
+
+/// A pool with one worker per CPU, started on first use and never
+/// stopped.
+
+static UNUSED
+ThreadPool *default_ThreadPool() {
+    pthread_once(&_default_ThreadPool_once, _init_default_ThreadPool);
+    return &_default_ThreadPool;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cj50/gen/Option.h>
+#include <cj50/gen/ref.h>
 
 /// We alias this lengthy C type name to the shorter naming used in
 /// the Rust programming language.
@@ -21,6 +22,11 @@ bool equal_move_u32(const u32 a, const u32 b) {
     return a == b;
 }
 
+static UNUSED
+int cmp_u32(const u32 *a, const u32 *b) {
+    return (*a > *b) - (*a < *b);
+}
+
 static UNUSED
 void drop_u32(const u32 UNUSED a) {}
 
@@ -45,4 +51,6 @@ int print_move_debug_u32(u32 n) {
 }
 
 GENERATE_Option(u32);
+GENERATE_ref(u32);
+GENERATE_Option(ref(u32));
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cj50/gen/Option.h>
+#include <cj50/gen/ref.h>
 
 /// We alias this lengthy C type name to the shorter naming used in
 /// the Rust programming language.
@@ -21,6 +22,11 @@ bool equal_move_u64(const u64 a, const u64 b) {
     return a == b;
 }
 
+static UNUSED
+int cmp_u64(const u64 *a, const u64 *b) {
+    return (*a > *b) - (*a < *b);
+}
+
 static UNUSED
 void drop_u64(const u64 UNUSED a) {}
 
@@ -45,4 +51,6 @@ int print_debug_move_u64(u64 n) {
 }
 
 GENERATE_Option(u64);
+GENERATE_ref(u64);
+GENERATE_Option(ref(u64));
 
@@ -17,6 +17,7 @@
 #include <cj50/unicodeError.h>
 #include <cj50/instantiations/Result_Unit__UnicodeError.h>
 #include <cj50/xmem.h>
+#include <cj50/unicode_validate.h>
 
 
 static UNUSED
@@ -350,8 +351,9 @@ Result(Option(ucodepoint), UnicodeError) get_ucodepoint_unlocked_SliceIterator_c
 
 static UNUSED
 Option(utf8char) get_utf8char_String(const String *s, size_t idx) {
-    size_t len = s->vec.len;
-    char *ptr = s->vec.ptr;
+    strslice str = deref_String(s);
+    size_t len = str.slice.len;
+    const char *ptr = str.slice.ptr;
     if (idx < len) {
         if_let_Some(seqlen, utf8_sequence_len_u8(ptr[idx])) {
             assert((idx + seqlen) <= len); // String guarantees UTF-8
@@ -434,13 +436,7 @@ cleanup1:
 
 static UNUSED
 void push_utf8char_String(String *s, utf8char c) {
-    // (XX todo: there should be something in Vec to add multiple
-    // items; slices of course)
-    cstr cs = cstr_utf8char(&c);
-    size_t len = len_utf8char(&c);
-    for (size_t i = 0; i < len; i++) {
-        push_Vec_char(&s->vec, cs[i]);
-    }
+    push_str_String(s, new_strslice(cstr_utf8char(&c), len_utf8char(&c)));
 }
 
 /// Appends the given unicode codepoint to the end of this
@@ -453,27 +449,46 @@ void push_ucodepoint_String(String *s, ucodepoint c) {
 
 
 
+// The error the decoder reports for the invalid sequence starting at
+// byte `pos` of `s` (as found by `utf8_valid_up_to`).
+static
+UnicodeError _utf8_decoding_error_at(slice(char) s, size_t pos) {
+    AUTO iter = new_SliceIterator_char(new_slice_char(s.ptr + pos, s.len - pos));
+    AUTO r = get_ucodepoint_unlocked_SliceIterator_char(&iter);
+    drop_SliceIterator_char(iter);
+    if (r.is_ok) {
+        DIE_("bug: utf8_valid_up_to and decoder disagree at byte %zu", pos);
+    }
+    return r.err;
+}
+
+/// Check that the given slice is valid and canonically UTF-8
+/// encoded. On failure, reports the same error that decoding the
+/// slice codepoint by codepoint would report.
+
+static UNUSED
+Result(Unit, UnicodeError) validate_utf8_slice_char(slice(char) s) {
+    size_t valid = utf8_valid_up_to(s.ptr, s.len);
+    if (valid == s.len) {
+        return Ok(Unit, UnicodeError)(Unit());
+    }
+    return Err(Unit, UnicodeError)(_utf8_decoding_error_at(s, valid));
+}
+
+
 /// Appends the given cstr `cs` to the end of this String. `cs` is
-/// checked for correct UTF-8 encoding.
+/// checked for correct UTF-8 encoding. If it is invalid, the valid
+/// part before the first invalid sequence is still appended.
 
 static UNUSED
 Result(Unit, UnicodeError) push_cstr_String(String *s, cstr cs) {
-    BEGIN_Result(Unit, UnicodeError);
-
     AUTO slice = new_slice_char(cs, strlen(cs));
-    AUTO in = new_SliceIterator_char(slice);
-    while_let_Some(cp, TRY(get_ucodepoint_unlocked_SliceIterator_char(&in), cleanup1)) {
-        utf8char c = new_utf8char_from_ucodepoint(cp);
-        size_t len = len_utf8char(&c);
-        for (size_t i = 0; i < len; i++) {
-            push_String(s, c.data[i]);
-        }
+    size_t valid = utf8_valid_up_to(slice.ptr, slice.len);
+    push_str_String(s, new_strslice(slice.ptr, valid));
+    if (valid == slice.len) {
+        return Ok(Unit, UnicodeError)(Unit());
     }
-    RETURN_Ok(Unit(), cleanup1);
-
-cleanup1:
-    drop_SliceIterator_char(in);
-    END_Result();
+    return Err(Unit, UnicodeError)(_utf8_decoding_error_at(slice, valid));
 }
 
 
@@ -568,7 +583,7 @@ cleanup1:
 static UNUSED
 Option(ucodepoint) get_ucodepoint_String(const String *s, size_t idx) {
     AUTO iter = new_SliceIterator_char(unsafe_slice_of_String(
-                                           s, range(idx, s->vec.len)).slice);
+                                           s, range(idx, len_String(s))).slice);
     if_let_Ok(opt_cp, get_ucodepoint_unlocked_SliceIterator_char(&iter)) {
         return opt_cp;
     } else_Err(UNUSED _) {
@@ -589,16 +604,18 @@ Option(strslice) get_slice_of_String(const String *s, Range range) {
     if (!(range.start <= range.end)) {
         return none_strslice();
     }
-    size_t len = s->vec.len;
+    strslice str = deref_String(s);
+    size_t len = str.slice.len;
     if (!(range.end <= len)) {
         return none_strslice();
     }
     if (range.end < len) {
-        if (is_utf8_continuation_byte(s->vec.ptr[range.end])) {
+        if (is_utf8_continuation_byte(str.slice.ptr[range.end])) {
             return none_strslice();
         }
     }
-    if (is_utf8_continuation_byte(s->vec.ptr[range.start])) {
+    if ((range.start < len)
+        && is_utf8_continuation_byte(str.slice.ptr[range.start])) {
         return none_strslice();
     }
     return some_strslice(unsafe_slice_of_String(s, range));
@@ -620,38 +637,222 @@ Result(size_t, UnicodeError) read_line_Vec_ucodepoint
 }
 
 
-/// The number of unicode code points in the given slice.
+/// Read a single Unicode code point from the given `BufReader`.
+
+/// Decodes UTF-8 exactly like `get_ucodepoint_unlocked_CFile`, but
+/// directly from the buffer; `read` is only called when the buffer
+/// does not hold a whole UTF-8 sequence.
 
 static UNUSED
-Result(size_t, UnicodeError) ucodepoint_count_slice_char(slice(char) s) {
-    // NOTE: count(ucodepoint_iter(s)) would be the right approach in
-    // the FUTURE instead!
+Result(Option(ucodepoint), UnicodeError) get_ucodepoint_unlocked_BufReader(
+    BufReader *in)
+{
+    if ((in->pos < in->end) && (in->buf[in->pos] < 0x80)) {
+        return Ok(Option(ucodepoint), UnicodeError)(
+            some_ucodepoint(ucodepoint(in->buf[in->pos++])));
+    }
+    while (!in->eof) {
+        size_t avail = in->end - in->pos;
+        if (avail > 0) {
+            u8 b = in->buf[in->pos];
+            size_t needed = (b >= 0xF0) ? 4 : (b >= 0xE0) ? 3 : (b >= 0xC0) ? 2 : 1;
+            if (avail >= needed) {
+                break;
+            }
+        }
+        AUTO r = fill_BufReader(in);
+        if (! r.is_ok) {
+            return Err(Option(ucodepoint), UnicodeError)(
+                new_UnicodeError_from_SystemError(r.err));
+        }
+    }
+    AUTO iter = new_SliceIterator_char(
+        new_slice_char((const char*)in->buf + in->pos, in->end - in->pos));
+    AUTO r = get_ucodepoint_unlocked_SliceIterator_char(&iter);
+    in->pos += iter.pos;
+    drop_SliceIterator_char(iter);
+    return r;
+}
+
+// The length of the part of `s[0..len]` before the first occurrence
+// of the byte sequence `needle[0..needlelen]`, or `len` if it doesn't
+// occur (completely).
+static
+size_t _find_bytes(const u8 *s, size_t len, const u8 *needle, size_t needlelen) {
+    if (needlelen == 1) {
+        const u8 *p = memchr(s, needle[0], len);
+        return p ? (size_t)(p - s) : len;
+    }
+    size_t i = 0;
+    while (i + needlelen <= len) {
+        const u8 *p = memchr(s + i, needle[0], len - needlelen + 1 - i);
+        if (! p) {
+            break;
+        }
+        i = p - s;
+        if (memcmp(p, needle, needlelen) == 0) {
+            return i;
+        }
+        i++;
+    }
+    return len;
+}
+
+// Append the codepoints of the valid UTF-8 in `s[0..len]` to `v`, at
+// most `max` of them. Returns the number of bytes consumed.
+static
+size_t _extend_Vec_ucodepoint_from_valid_utf8(Vec(ucodepoint) *v,
+                                              const u8 *s, size_t len,
+                                              size_t max) {
+    reserve_Vec_ucodepoint(v, len < max ? len : max);
+    ucodepoint *out = v->ptr + v->len;
+    size_t i = 0;
+    size_t n = 0;
+    while ((i < len) && (n < max)) {
+        u8 b = s[i];
+        u32 cp;
+        if (b < 0x80) {
+            cp = b;
+            i += 1;
+        } else if (b < 0xE0) {
+            cp = ((u32)(b & 0x1F) << 6) | (s[i+1] & 0x3F);
+            i += 2;
+        } else if (b < 0xF0) {
+            cp = ((u32)(b & 0x0F) << 12) | ((u32)(s[i+1] & 0x3F) << 6)
+                | (s[i+2] & 0x3F);
+            i += 3;
+        } else {
+            cp = ((u32)(b & 0x07) << 18) | ((u32)(s[i+1] & 0x3F) << 12)
+                | ((u32)(s[i+2] & 0x3F) << 6) | (s[i+3] & 0x3F);
+            i += 4;
+        }
+        out[n++] = ucodepoint(cp);
+    }
+    v->len += n;
+    return i;
+}
+
+/// Read all unicode codepoints into buf until the delimiter character
+/// or EOF is reached. Same as `read_until_Vec_ucodepoint`, but
+/// reading from a `BufReader`: the buffered bytes are searched for the
+/// delimiter, validated with `utf8_valid_up_to`, and decoded in bulk.
+
+static UNUSED
+Result(size_t, UnicodeError) read_until_Vec_ucodepoint_BufReader
+    (BufReader *in,
+     ucodepoint delimiter,
+     Vec(ucodepoint) *buf,
+     bool strip_delimiter,
+     size_t max_len)
+{
     BEGIN_Result(size_t, UnicodeError);
 
-    AUTO iter = new_SliceIterator_char(s);
-    size_t count = 0;
-    while_let_Some(_, TRY(get_ucodepoint_unlocked_SliceIterator_char(&iter),
-                          cleanup1)) {
-        drop_ucodepoint(_);
-        count++;
+    AUTO d = new_utf8char_from_ucodepoint(delimiter);
+    const u8 *dbytes = (const u8*)cstr_utf8char(&d);
+    size_t dlen = len_utf8char(&d);
+
+    size_t nread = 0;
+    while (true) {
+        if (in->pos == in->end) {
+            if (in->eof) {
+                break;
+            }
+            TRY(fill_BufReader(in), cleanup1);
+            continue;
+        }
+        const u8 *p = in->buf + in->pos;
+        size_t avail = in->end - in->pos;
+        size_t before_delimiter = _find_bytes(p, avail, dbytes, dlen);
+        size_t valid = utf8_valid_up_to((const char*)p, before_delimiter);
+        size_t len0 = buf->len;
+        size_t consumed = _extend_Vec_ucodepoint_from_valid_utf8(
+            buf, p, valid, max_len - nread);
+        nread += buf->len - len0;
+        in->pos += consumed;
+        if (consumed < valid) {
+            RETURN_Err(UnicodeError_LimitExceeded, cleanup1);
+        }
+        if (valid == before_delimiter) {
+            if (before_delimiter < avail) {
+                in->pos += dlen;
+                if (! strip_delimiter) {
+                    if (nread < max_len) {
+                        push_Vec_ucodepoint(buf, delimiter);
+                        nread++;
+                    } else {
+                        RETURN_Err(UnicodeError_LimitExceeded, cleanup1);
+                    }
+                }
+                break;
+            }
+            // else all of the buffer was consumed, refill
+        } else {
+            // Invalid UTF-8 or a sequence that continues past the end
+            // of the buffer: go through the single codepoint decoder,
+            // which refills and reports errors as needed.
+            let_Some_else(c, TRY(get_ucodepoint_unlocked_BufReader(in),
+                                 cleanup1)) {
+                break;
+            }
+            bool is_end = equal_ucodepoint(&c, &delimiter);
+            if ((! is_end) || (! strip_delimiter)) {
+                if (nread < max_len) {
+                    push_Vec_ucodepoint(buf, c);
+                    nread++;
+                } else {
+                    RETURN_Err(UnicodeError_LimitExceeded, cleanup1);
+                }
+            }
+            if (is_end) {
+                break;
+            }
+        }
     }
-    RETURN_Ok(count, cleanup1);
+    RETURN_Ok(nread, cleanup1);
 
 cleanup1:
-    drop_SliceIterator_char(iter); // (even though it's a noop)
     END_Result();
 }
 
+/// Read all unicode codepoints into buf until `uchar("\n")` or EOF is
+/// reached. Same as `read_line_Vec_ucodepoint`, but reading from a
+/// `BufReader`.
+
+static UNUSED
+Result(size_t, UnicodeError) read_line_Vec_ucodepoint_BufReader
+    (BufReader *in,
+     Vec(ucodepoint) *buf,
+     bool strip_delimiter,
+     size_t max_len)
+{
+    return read_until_Vec_ucodepoint_BufReader(in, uchar("\n"), buf,
+                                               strip_delimiter, max_len);
+}
+
+
+/// The number of unicode code points in the given slice.
+
+static UNUSED
+Result(size_t, UnicodeError) ucodepoint_count_slice_char(slice(char) s) {
+    size_t valid = utf8_valid_up_to(s.ptr, s.len);
+    if (valid != s.len) {
+        return Err(size_t, UnicodeError)(_utf8_decoding_error_at(s, valid));
+    }
+    // Every codepoint has exactly one byte that's not a continuation
+    // byte.
+    size_t count = 0;
+    for (size_t i = 0; i < s.len; i++) {
+        count += ((u8)s.ptr[i] & 0xC0) != 0x80;
+    }
+    return Ok(size_t, UnicodeError)(count);
+}
+
 /// Whether the given slice represents valid and canonically UTF-8
 /// encoded unicode codepoints.
 
 static UNUSED
 bool is_valid_utf8_slice_char(slice(char) s) {
-    if_let_Ok(UNUSED _, ucodepoint_count_slice_char(s)) {
-        return true;
-    } else_Err(UNUSED _) {
-        return false;
-    } end_let_Ok;
+    return utf8_valid_up_to(s.ptr, s.len) == s.len;
 }
 
 
@@ -663,12 +864,19 @@ static UNUSED
 String new_String_from_CStr(CStr s) {
     size_t len = strlen(s.cstr);
     assert(is_valid_utf8_slice_char(new_slice_char(s.cstr, len)));
+    if (len <= STRING_INLINE_CAP) {
+        String str = new_String_from_strslice(new_strslice(s.cstr, len));
+        drop_CStr(s);
+        return str;
+    }
+    // Take over the memory
     return (String) {
-        .vec = (Vec(char)) {
+        .repr.heap = {
             .ptr = s.cstr,
+            .len = len,
             .cap = len + 1,
-            .len = len
-        }       
+            .tag = _STRING_SPILLED
+        }
     };
 }
 
@@ -680,13 +888,7 @@ String new_String_from_CStr(CStr s) {
 static UNUSED
 String new_String_from_slice_char(slice(char) s) {
     assert(is_valid_utf8_slice_char(s));
-    return (String) {
-        .vec = (Vec(char)) {
-            .ptr = xmemcpy(s.ptr, s.len + 1),
-            .cap = s.len + 1,
-            .len = s.len
-        }       
-    };
+    return new_String_from_strslice(new_strslice(s.ptr, s.len));
 }
 
 /// Create a String from a cstr, copying the data in the string.
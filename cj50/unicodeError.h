@@ -68,6 +68,8 @@ bool equal_DecodingError(const DecodingError *a, const DecodingError *b) {
              (a->byte_number == b->byte_number) :
              (a->kind == DecodingErrorKind_InvalidCodepoint) ?
              (a->codepoint == b->codepoint) :
+             (a->kind == DecodingErrorKind_OverlongEncoding) ?
+             (a->codepoint == b->codepoint) :
              die_match_failure()));
 }
 
@@ -0,0 +1,367 @@
+#pragma once
+
+//! Fast validation of UTF-8 encoded byte sequences.
+
+//! `utf8_valid_up_to` checks a whole buffer at once instead of
+//! decoding it code point by code point. On x86 processors it
+//! chooses at runtime (via cpuid) between an AVX2 implementation that
+//! validates 32 bytes per step, an SSE2 implementation that skips
+//! over ASCII 16 bytes at a time, and a portable scalar
+//! implementation (also used on all other architectures).
+
+//! All variants accept exactly what the decoder in
+//! [`cj50/gen/template/unicode_utf8decode.h`](gen/template/unicode_utf8decode.h.md)
+//! accepts: canonical (shortest form) encodings of code points up to
+//! 0x10FFFF, excluding the surrogates 0xD800..0xDFFF. Use the
+//! functions in [`cj50/unicode.h`](unicode.h.md) to get the
+//! `UnicodeError` describing a failure.
+
+#include <stdint.h>
+#include <string.h>
+#include <cj50/basic-util.h>
+#include <cj50/u8.h>
+#include <cj50/u32.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define CJ50_UTF8_VALIDATE_X86 1
+#  include <immintrin.h>
+#else
+#  define CJ50_UTF8_VALIDATE_X86 0
+#endif
+
+
+// Returns the length of the valid UTF-8 sequence starting at `pos`
+// (1..4), or 0 if it is invalid or incomplete. Same acceptance rules
+// as unicode_utf8decode.h.
+static inline
+size_t _utf8_sequence_len_at(const u8 *s, size_t pos, size_t len) {
+    u8 b1 = s[pos];
+    if (b1 < 0x80) {
+        return 1;
+    }
+    size_t numbytes;
+    u32 codepoint;
+    if        ((b1 & 0b11100000) == 0b11000000) {
+        numbytes = 2;
+        codepoint = b1 & 0b11111;
+    } else if ((b1 & 0b11110000) == 0b11100000) {
+        numbytes = 3;
+        codepoint = b1 & 0b1111;
+    } else if ((b1 & 0b11111000) == 0b11110000) {
+        numbytes = 4;
+        codepoint = b1 & 0b111;
+    } else {
+        return 0;
+    }
+    if (len - pos < numbytes) {
+        return 0;
+    }
+    for (size_t i = 1; i < numbytes; i++) {
+        u8 b = s[pos + i];
+        if ((b & 0b11000000) != 0b10000000) {
+            return 0;
+        }
+        codepoint = (codepoint << 6) | (b & 0b00111111);
+    }
+    size_t expected_numbytes =
+        codepoint <= 0x7F ? 1 :
+        codepoint <= 0x7FF ? 2 :
+        codepoint <= 0xFFFF ? 3 : 4;
+    if ((expected_numbytes != numbytes) ||
+        (codepoint > 0x10FFFF) ||
+        ((codepoint >= 0xD800) && (codepoint <= 0xDFFF))) {
+        return 0;
+    }
+    return numbytes;
+}
+
+// The scalar implementation, starting at `pos`, which must be at the
+// start of a byte sequence. Skips ASCII 8 bytes at a time.
+static
+size_t _utf8_valid_up_to_scalar(const u8 *s, size_t pos, size_t len) {
+    while (pos < len) {
+        if (len - pos >= 8) {
+            uint64_t word;
+            memcpy(&word, &s[pos], 8);
+            if ((word & 0x8080808080808080ull) == 0) {
+                pos += 8;
+                continue;
+            }
+        }
+        size_t n = _utf8_sequence_len_at(s, pos, len);
+        if (n == 0) {
+            return pos;
+        }
+        pos += n;
+    }
+    return pos;
+}
+
+// Move back from block boundary `pos` to the start of the last byte
+// sequence before it if that one might extend past `pos`. Used to
+// resume with the scalar implementation after a vectorized one
+// stopped at a block boundary: everything before the boundary is
+// known to be valid except for a possibly incomplete last sequence,
+// which can't be longer than 3 bytes.
+static UNUSED
+size_t _utf8_sequence_start_before(const u8 *s, size_t pos) {
+    size_t stop = pos >= 3 ? pos - 3 : 0;
+    for (size_t p = pos; p > stop; p--) {
+        u8 b = s[p - 1];
+        if (b >= 0b11000000) {
+            // lead byte
+            return p - 1;
+        }
+        if (b < 0x80) {
+            // ASCII, the last sequence ended before `pos`
+            return pos;
+        }
+    }
+    return pos;
+}
+
+
+#if CJ50_UTF8_VALIDATE_X86
+
+// Skips ASCII 16 bytes at a time; non-ASCII sequences are checked one
+// at a time via `_utf8_sequence_len_at`.
+__attribute__((target("sse2")))
+static
+size_t _utf8_valid_up_to_sse2(const u8 *s, size_t len) {
+    size_t pos = 0;
+    while (len - pos >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)&s[pos]);
+        int mask = _mm_movemask_epi8(chunk);
+        if (mask == 0) {
+            pos += 16;
+            continue;
+        }
+        pos += __builtin_ctz(mask);
+        // Check sequences until we are at ASCII again
+        do {
+            size_t n = _utf8_sequence_len_at(s, pos, len);
+            if (n == 0) {
+                return pos;
+            }
+            pos += n;
+        } while ((pos < len) && (s[pos] >= 0x80));
+    }
+    return _utf8_valid_up_to_scalar(s, pos, len);
+}
+
+
+// The "lookup" algorithm by John Keiser and Daniel Lemire (Validating
+// UTF-8 In Less Than One Instruction Per Byte, 2021): every byte is
+// classified together with its predecessor via three 16-entry
+// lookup tables (high nibble of the previous byte, low nibble of the
+// previous byte, high nibble of the current byte); any bit remaining
+// set after and-ing the three results is an error. The lengths of 3
+// and 4 byte sequences are checked separately.
+
+#define _UTF8_TOO_SHORT (1 << 0)
+#define _UTF8_TOO_LONG (1 << 1)
+#define _UTF8_OVERLONG_3 (1 << 2)
+#define _UTF8_TOO_LARGE (1 << 3)
+#define _UTF8_SURROGATE (1 << 4)
+#define _UTF8_OVERLONG_2 (1 << 5)
+#define _UTF8_TOO_LARGE_1000 (1 << 6)
+#define _UTF8_OVERLONG_4 (1 << 6)
+#define _UTF8_TWO_CONTS (1 << 7)
+#define _UTF8_CARRY (_UTF8_TOO_SHORT | _UTF8_TOO_LONG | _UTF8_TWO_CONTS)
+
+#define _UTF8_TABLE16(...)                                      \
+    _mm256_broadcastsi128_si256(                                \
+        _mm_loadu_si128((const __m128i *)(const u8[16]) { __VA_ARGS__ }))
+
+__attribute__((target("avx2")))
+static inline
+__m256i _utf8_avx2_prev(__m256i input, __m256i prev_input, int n) {
+    // bytes [prev_input[16..31], input[0..15]]
+    __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    switch (n) {
+    case 1: return _mm256_alignr_epi8(input, shifted, 16 - 1);
+    case 2: return _mm256_alignr_epi8(input, shifted, 16 - 2);
+    default: return _mm256_alignr_epi8(input, shifted, 16 - 3);
+    }
+}
+
+__attribute__((target("avx2")))
+static inline
+__m256i _utf8_avx2_high_nibbles(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+// Returns a vector with non-zero bytes where errors were found.
+__attribute__((target("avx2")))
+static inline
+__m256i _utf8_avx2_check_block(__m256i input, __m256i prev_input) {
+    __m256i prev1 = _utf8_avx2_prev(input, prev_input, 1);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(
+        _UTF8_TABLE16(
+            // 0_______ ________ <ASCII in byte 1>
+            _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG,
+            _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG,
+            // 10______ ________ <continuation in byte 1>
+            _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS,
+            // 1100____ ________ <two byte lead in byte 1>
+            _UTF8_TOO_SHORT | _UTF8_OVERLONG_2,
+            // 1101____ ________ <two byte lead in byte 1>
+            _UTF8_TOO_SHORT,
+            // 1110____ ________ <three byte lead in byte 1>
+            _UTF8_TOO_SHORT | _UTF8_OVERLONG_3 | _UTF8_SURROGATE,
+            // 1111____ ________ <four+ byte lead in byte 1>
+            _UTF8_TOO_SHORT | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000
+            | _UTF8_OVERLONG_4),
+        _utf8_avx2_high_nibbles(prev1));
+
+    __m256i byte_1_low = _mm256_shuffle_epi8(
+        _UTF8_TABLE16(
+            // ____0000 ________
+            _UTF8_CARRY | _UTF8_OVERLONG_3 | _UTF8_OVERLONG_2 | _UTF8_OVERLONG_4,
+            // ____0001 ________
+            _UTF8_CARRY | _UTF8_OVERLONG_2,
+            // ____001_ ________
+            _UTF8_CARRY,
+            _UTF8_CARRY,
+            // ____0100 ________
+            _UTF8_CARRY | _UTF8_TOO_LARGE,
+            // ____0101 ________
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            // ____011_ ________
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            // ____1___ ________
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            // ____1101 ________
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000 | _UTF8_SURROGATE,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+            _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000),
+        _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+
+    __m256i byte_2_high = _mm256_shuffle_epi8(
+        _UTF8_TABLE16(
+            // ________ 0_______ <ASCII in byte 2>
+            _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT,
+            _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT,
+            // ________ 1000____
+            _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3
+            | _UTF8_TOO_LARGE_1000 | _UTF8_OVERLONG_4,
+            // ________ 1001____
+            _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3
+            | _UTF8_TOO_LARGE,
+            // ________ 101_____
+            _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE
+            | _UTF8_TOO_LARGE,
+            _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE
+            | _UTF8_TOO_LARGE,
+            // ________ 11______
+            _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT),
+        _utf8_avx2_high_nibbles(input));
+
+    __m256i special_cases =
+        _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low),
+                         byte_2_high);
+
+    // The 3rd and 4th bytes of 3 and 4 byte sequences must be
+    // continuations (and nothing else may be); special_cases has
+    // 0x80 (TWO_CONTS) set for those positions, xor cancels it out.
+    __m256i prev2 = _utf8_avx2_prev(input, prev_input, 2);
+    __m256i prev3 = _utf8_avx2_prev(input, prev_input, 3);
+    __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80));
+    __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80));
+    __m256i must23_80 = _mm256_and_si256(
+        _mm256_or_si256(is_third_byte, is_fourth_byte),
+        _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must23_80, special_cases);
+}
+
+#undef _UTF8_TABLE16
+
+// Stops at the first block containing an error (or at the last
+// incomplete block) and lets the scalar implementation find the
+// exact position.
+__attribute__((target("avx2")))
+static
+size_t _utf8_valid_up_to_avx2(const u8 *s, size_t len) {
+    size_t pos = 0;
+    __m256i prev_input = _mm256_setzero_si256();
+    while (len - pos >= 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i *)&s[pos]);
+        if (_mm256_movemask_epi8(input) == 0) {
+            // All ASCII; only valid if the previous block didn't end
+            // in the middle of a sequence.
+            if (_mm256_movemask_epi8(prev_input) != 0) {
+                __m256i err = _utf8_avx2_check_block(input, prev_input);
+                if (! _mm256_testz_si256(err, err)) {
+                    break;
+                }
+            }
+        } else {
+            __m256i err = _utf8_avx2_check_block(input, prev_input);
+            if (! _mm256_testz_si256(err, err)) {
+                break;
+            }
+        }
+        prev_input = input;
+        pos += 32;
+    }
+    return _utf8_valid_up_to_scalar(
+        s, _utf8_sequence_start_before(s, pos), len);
+}
+
+#undef _UTF8_TOO_SHORT
+#undef _UTF8_TOO_LONG
+#undef _UTF8_OVERLONG_3
+#undef _UTF8_TOO_LARGE
+#undef _UTF8_SURROGATE
+#undef _UTF8_OVERLONG_2
+#undef _UTF8_TOO_LARGE_1000
+#undef _UTF8_OVERLONG_4
+#undef _UTF8_TWO_CONTS
+#undef _UTF8_CARRY
+
+#endif /* CJ50_UTF8_VALIDATE_X86 */
+
+
+static
+size_t _utf8_valid_up_to_portable(const u8 *s, size_t len) {
+    return _utf8_valid_up_to_scalar(s, 0, len);
+}
+
+static
+size_t (*_utf8_valid_up_to_impl(void))(const u8 *, size_t) {
+#if CJ50_UTF8_VALIDATE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return _utf8_valid_up_to_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return _utf8_valid_up_to_sse2;
+    }
+#endif
+    return _utf8_valid_up_to_portable;
+}
+
+
+/// Returns the number of bytes at the start of `ptr[0..len)` that
+/// form valid, canonically UTF-8 encoded unicode code points. This is
+/// `len` if the whole buffer is valid, otherwise the position of the
+/// start of the first invalid (or incomplete) byte sequence.
+
+static UNUSED
+size_t utf8_valid_up_to(const char *ptr, size_t len) {
+    // (Selecting the implementation twice in concurrent first calls
+    // is harmless.)
+    static size_t (*impl)(const u8 *, size_t) = NULL;
+    AUTO f = __atomic_load_n(&impl, __ATOMIC_RELAXED);
+    if (! f) {
+        f = _utf8_valid_up_to_impl();
+        __atomic_store_n(&impl, f, __ATOMIC_RELAXED);
+    }
+    return f((const u8 *)ptr, len);
+}
@@ -5,9 +5,29 @@
 
 #pragma once
 
+//! Memory allocation functions that abort the program when out of
+//! memory, instead of returning NULL. All allocations of the library
+//! go through these.
+
+//! They can also collect statistics about the allocations: if the
+//! `CJ50_XMEM_STATS` environment variable is true at program start
+//! (when using the `MAIN` macro, otherwise call
+//! `enable_xmem_stats(true)`),
+//! a summary is printed to stderr when the program exits: the number
+//! of allocations and bytes allocated per place in the source code
+//! (file, line and function, i.e. for templates, the instantiation),
+//! the bytes copied by `xreallocarray` when it had to move the data,
+//! the peak amount of memory in use, and how many allocations fell
+//! into which size range. Memory only counts as freed when freed via
+//! `xfree` (which the library's `drop` functions use).
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
+#include "basic-util.h"
 
 static
 void die_outofmemory() {
@@ -16,54 +36,443 @@ void die_outofmemory() {
     abort();
 }
 
+
+// ------------------------------------------------------------------
+// Statistics
+
+/// Whether allocation statistics are being collected (see above).
+
+bool __CJ50_xmem_stats = false;
+
+// Size classes: allocations of 0 bytes, then [2^(i-1), 2^i) for
+// class i.
+#define _XMEM_SIZE_CLASSES 65
+
+// The maximum number of distinct allocation sites tracked (any further
+// ones are accounted as one "other" site); power of 2.
+#define _XMEM_MAX_CALLSITES 4096
+
+typedef struct _XmemCallsite {
+    const char *file;
+    const char *func;
+    int line;
+    size_t allocs;
+    size_t reallocs;
+    size_t bytes;
+    size_t realloc_copy_bytes;
+} _XmemCallsite;
+
+// A live allocation, in an open addressing hash table keyed by `ptr`.
+typedef struct _XmemLive {
+    void *ptr;
+    size_t size;
+} _XmemLive;
+
+/// Totals of the statistics, see `get_xmem_stats`.
+
+typedef struct XmemStats {
+    size_t allocs;
+    size_t reallocs;
+    size_t frees;
+    size_t bytes;
+    size_t realloc_copy_bytes;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+} XmemStats;
+
+static struct {
+    pthread_mutex_t lock;
+    XmemStats totals;
+    _XmemCallsite callsites[_XMEM_MAX_CALLSITES];
+    size_t num_callsites;
+    _XmemCallsite other;
+    _XmemLive *live;
+    size_t live_cap; // power of 2, or 0
+    size_t live_len;
+    size_t size_classes[_XMEM_SIZE_CLASSES];
+} _xmem_stats = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .other = { .file = "(other)", .func = "", .line = 0 }
+};
+
+static inline
+size_t _xmem_hash(uintptr_t x) {
+    x *= 0x9e3779b97f4a7c15;
+    return x ^ (x >> 29);
+}
+
+static
+int _xmem_size_class(size_t size) {
+    int c = 0;
+    while (size) {
+        c++;
+        size >>= 1;
+    }
+    return c;
+}
+
+static
+_XmemCallsite *_xmem_callsite(const char *file, int line, const char *func) {
+    size_t mask = _XMEM_MAX_CALLSITES - 1;
+    size_t i = _xmem_hash((uintptr_t)func ^ (uintptr_t)line) & mask;
+    for (size_t n = 0; n < _XMEM_MAX_CALLSITES; n++) {
+        _XmemCallsite *c = &_xmem_stats.callsites[(i + n) & mask];
+        if (!c->file) {
+            if (_xmem_stats.num_callsites >= _XMEM_MAX_CALLSITES / 2) {
+                break;
+            }
+            *c = (_XmemCallsite) { .file = file, .func = func, .line = line };
+            _xmem_stats.num_callsites++;
+            return c;
+        }
+        if ((c->line == line) && (c->func == func) && (c->file == file)) {
+            return c;
+        }
+    }
+    return &_xmem_stats.other;
+}
+
+static
+void _xmem_live_insert(void *ptr, size_t size);
+
+static
+void _xmem_live_grow() {
+    size_t old_cap = _xmem_stats.live_cap;
+    _XmemLive *old = _xmem_stats.live;
+    size_t cap = old_cap ? old_cap * 2 : 1024;
+    // (Not via xcallocarray, to not count ourselves.)
+    _xmem_stats.live = calloc(cap, sizeof(_XmemLive));
+    if (!_xmem_stats.live) die_outofmemory();
+    _xmem_stats.live_cap = cap;
+    _xmem_stats.live_len = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].ptr) {
+            _xmem_live_insert(old[i].ptr, old[i].size);
+        }
+    }
+    free(old);
+}
+
+// Record `ptr` as live with `size` bytes (replacing a stale entry for
+// the same address, from memory that was freed without `xfree`).
+static
+void _xmem_live_insert(void *ptr, size_t size) {
+    if (_xmem_stats.live_len * 2 >= _xmem_stats.live_cap) {
+        _xmem_live_grow();
+    }
+    size_t mask = _xmem_stats.live_cap - 1;
+    size_t i = _xmem_hash((uintptr_t)ptr) & mask;
+    while (true) {
+        _XmemLive *e = &_xmem_stats.live[i];
+        if (!e->ptr) {
+            *e = (_XmemLive) { .ptr = ptr, .size = size };
+            _xmem_stats.live_len++;
+            _xmem_stats.totals.live_bytes += size;
+            return;
+        }
+        if (e->ptr == ptr) {
+            _xmem_stats.totals.live_bytes += size - e->size;
+            e->size = size;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+// Remove `ptr` from the live allocations, returning its size, or
+// SIZE_MAX if it is not known.
+static
+size_t _xmem_live_remove(void *ptr) {
+    if (!_xmem_stats.live_cap) {
+        return SIZE_MAX;
+    }
+    size_t mask = _xmem_stats.live_cap - 1;
+    size_t i = _xmem_hash((uintptr_t)ptr) & mask;
+    while (true) {
+        _XmemLive *e = &_xmem_stats.live[i];
+        if (!e->ptr) {
+            return SIZE_MAX;
+        }
+        if (e->ptr == ptr) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    size_t size = _xmem_stats.live[i].size;
+    _xmem_stats.live_len--;
+    _xmem_stats.totals.live_bytes -= size;
+    // Backward shift deletion: move following entries that would
+    // not be found anymore into the hole
+    size_t hole = i;
+    while (true) {
+        i = (i + 1) & mask;
+        _XmemLive *e = &_xmem_stats.live[i];
+        if (!e->ptr) {
+            break;
+        }
+        size_t home = _xmem_hash((uintptr_t)e->ptr) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            _xmem_stats.live[hole] = *e;
+            hole = i;
+        }
+    }
+    _xmem_stats.live[hole] = (_XmemLive) { .ptr = NULL, .size = 0 };
+    return size;
+}
+
+static
+void _xmem_note_peak() {
+    if (_xmem_stats.totals.live_bytes > _xmem_stats.totals.peak_live_bytes) {
+        _xmem_stats.totals.peak_live_bytes = _xmem_stats.totals.live_bytes;
+    }
+}
+
+static
+void _xmem_record_alloc(void *p, size_t size,
+                        const char *file, int line, const char *func) {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    _XmemCallsite *c = _xmem_callsite(file, line, func);
+    c->allocs++;
+    c->bytes += size;
+    _xmem_stats.totals.allocs++;
+    _xmem_stats.totals.bytes += size;
+    _xmem_stats.size_classes[_xmem_size_class(size)]++;
+    _xmem_live_insert(p, size);
+    _xmem_note_peak();
+    pthread_mutex_unlock(&_xmem_stats.lock);
+}
+
+// Remove `ptr`, which is about to be reallocated, from the live
+// allocations (before the realloc, as afterwards another thread might
+// get the same address), returning its size (0 if unknown).
+static
+size_t _xmem_take_live(void *ptr) {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    size_t old_size = _xmem_live_remove(ptr);
+    pthread_mutex_unlock(&_xmem_stats.lock);
+    // Unknown if not from our functions; count it as new then
+    return old_size == SIZE_MAX ? 0 : old_size;
+}
+
+static
+void _xmem_record_realloc(void *p, size_t size, size_t old_size, bool moved,
+                          const char *file, int line, const char *func) {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    _XmemCallsite *c = _xmem_callsite(file, line, func);
+    size_t grown = size > old_size ? size - old_size : 0;
+    c->reallocs++;
+    c->bytes += grown;
+    _xmem_stats.totals.reallocs++;
+    _xmem_stats.totals.bytes += grown;
+    if (moved) {
+        size_t copied = old_size < size ? old_size : size;
+        c->realloc_copy_bytes += copied;
+        _xmem_stats.totals.realloc_copy_bytes += copied;
+    }
+    _xmem_stats.size_classes[_xmem_size_class(size)]++;
+    _xmem_live_insert(p, size);
+    _xmem_note_peak();
+    pthread_mutex_unlock(&_xmem_stats.lock);
+}
+
+static
+void _xmem_record_free(void *p) {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    if (_xmem_live_remove(p) != SIZE_MAX) {
+        _xmem_stats.totals.frees++;
+    }
+    pthread_mutex_unlock(&_xmem_stats.lock);
+}
+
+static
+int _xmem_cmp_callsite_bytes(const void *a, const void *b) {
+    const _XmemCallsite *ca = *(const _XmemCallsite * const *)a;
+    const _XmemCallsite *cb = *(const _XmemCallsite * const *)b;
+    size_t wa = ca->bytes + ca->realloc_copy_bytes;
+    size_t wb = cb->bytes + cb->realloc_copy_bytes;
+    return (wa < wb) - (wa > wb);
+}
+
+/// Print the statistics collected so far to `out` (see above). The
+/// allocation sites are sorted by bytes allocated plus copied, at
+/// most `max_sites` of them are shown.
+
+static UNUSED
+void print_xmem_stats(FILE *out, size_t max_sites) {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    fprintf(out,
+            "xmem: %zu allocations, %zu reallocations, %zu frees\n"
+            "xmem: %zu bytes allocated, %zu bytes copied by realloc\n"
+            "xmem: %zu bytes peak live, %zu bytes in %zu allocations"
+            " still live\n",
+            _xmem_stats.totals.allocs, _xmem_stats.totals.reallocs, _xmem_stats.totals.frees,
+            _xmem_stats.totals.bytes, _xmem_stats.totals.realloc_copy_bytes,
+            _xmem_stats.totals.peak_live_bytes, _xmem_stats.totals.live_bytes,
+            _xmem_stats.live_len);
+
+    fprintf(out, "xmem: size classes:\n");
+    for (int i = 0; i < _XMEM_SIZE_CLASSES; i++) {
+        size_t n = _xmem_stats.size_classes[i];
+        if (!n) {
+            continue;
+        }
+        if (i == 0) {
+            fprintf(out, "  %20s: %zu\n", "0", n);
+        } else {
+            char range[48];
+            snprintf(range, sizeof(range), "%zu..%zu",
+                     (size_t)1 << (i - 1),
+                     i < 64 ? ((size_t)1 << i) - 1 : SIZE_MAX);
+            fprintf(out, "  %20s: %zu\n", range, n);
+        }
+    }
+
+    const _XmemCallsite *sites[_XMEM_MAX_CALLSITES + 1];
+    size_t num_sites = 0;
+    for (size_t i = 0; i < _XMEM_MAX_CALLSITES; i++) {
+        if (_xmem_stats.callsites[i].file) {
+            sites[num_sites++] = &_xmem_stats.callsites[i];
+        }
+    }
+    if (_xmem_stats.other.allocs || _xmem_stats.other.reallocs) {
+        sites[num_sites++] = &_xmem_stats.other;
+    }
+    qsort(sites, num_sites, sizeof(sites[0]), _xmem_cmp_callsite_bytes);
+    fprintf(out, "xmem: %12s %12s %14s %14s  site\n",
+            "allocs", "reallocs", "bytes", "copied");
+    for (size_t i = 0; (i < num_sites) && (i < max_sites); i++) {
+        const _XmemCallsite *c = sites[i];
+        fprintf(out, "xmem: %12zu %12zu %14zu %14zu  %s:%i (%s)\n",
+                c->allocs, c->reallocs, c->bytes, c->realloc_copy_bytes,
+                c->file, c->line, c->func);
+    }
+    pthread_mutex_unlock(&_xmem_stats.lock);
+}
+
+/// Get the totals of the statistics collected so far.
+
 static UNUSED
-void *xmalloc(size_t size) {
+XmemStats get_xmem_stats() {
+    pthread_mutex_lock(&_xmem_stats.lock);
+    XmemStats totals = _xmem_stats.totals;
+    pthread_mutex_unlock(&_xmem_stats.lock);
+    return totals;
+}
+
+static
+void _xmem_print_stats_atexit() {
+    print_xmem_stats(stderr, 30);
+}
+
+/// Start collecting allocation statistics, and if `print_at_exit` is
+/// true, print them to stderr when the program exits. Should be
+/// called at the very start of the program (the `MAIN` macro does so
+/// if the `CJ50_XMEM_STATS` environment variable is true).
+
+static UNUSED
+void enable_xmem_stats(bool print_at_exit) {
+    __CJ50_xmem_stats = true;
+    if (print_at_exit) {
+        atexit(_xmem_print_stats_atexit);
+    }
+}
+
+
+// ------------------------------------------------------------------
+// Allocation functions
+
+// Each of these is used via a macro of the same name without the
+// `_at` suffix that passes the place of the call, for the statistics.
+
+static UNUSED
+void *xmalloc_at(size_t size, const char *file, int line, const char *func) {
     void *p = malloc(size);
     if (!p) die_outofmemory();
+    if (__CJ50_xmem_stats) {
+        _xmem_record_alloc(p, size, file, line, func);
+    }
     return p;
 }
 
 static UNUSED
-void *xmallocarray(size_t nmemb, size_t size) {
+void *xmallocarray_at(size_t nmemb, size_t size,
+                      const char *file, int line, const char *func) {
     size_t bytes = nmemb * size;
     if ((bytes < nmemb) || (bytes < size))
         die_outofmemory();
-    void *p = xmalloc(bytes);
-    if (!p) die_outofmemory();
-    return p;
+    return xmalloc_at(bytes, file, line, func);
 }
 
 static UNUSED
-void *xreallocarray(void *ptr, size_t nmemb, size_t size) {
+void *xreallocarray_at(void *ptr, size_t nmemb, size_t size,
+                       const char *file, int line, const char *func) {
     // void *p = reallocarray(ptr, nmemb, size);
     size_t bytes = nmemb * size;
     if ((bytes < nmemb) || (bytes < size))
         die_outofmemory();
+    bool stats = __CJ50_xmem_stats;
+    size_t old_size = (stats && ptr) ? _xmem_take_live(ptr) : 0;
+    uintptr_t old_addr = (uintptr_t)ptr;
     void *p = realloc(ptr, bytes);
     if (!p) die_outofmemory();
+    if (stats) {
+        _xmem_record_realloc(p, bytes, old_size,
+                             old_addr && ((uintptr_t)p != old_addr),
+                             file, line, func);
+    }
     return p;
 }
 
 static UNUSED
-void *xcallocarray(size_t nmemb, size_t size) {
+void *xcallocarray_at(size_t nmemb, size_t size,
+                      const char *file, int line, const char *func) {
     void *p = calloc(nmemb, size);
     if (!p) die_outofmemory();
+    if (__CJ50_xmem_stats) {
+        // (calloc already checked for overflow)
+        _xmem_record_alloc(p, nmemb * size, file, line, func);
+    }
     return p;
 }
 
-
 static UNUSED
-char *xstrdup(const char *str) {
+char *xstrdup_at(const char *str,
+                 const char *file, int line, const char *func) {
     char *res= strdup(str);
     if (!res) die_outofmemory();
+    if (__CJ50_xmem_stats) {
+        _xmem_record_alloc(res, strlen(res) + 1, file, line, func);
+    }
     return res;
 }
 
 static UNUSED
-void *xmemcpy(const void *src, size_t n) {
-    void *p = xmalloc(n);
+void *xmemcpy_at(const void *src, size_t n,
+                 const char *file, int line, const char *func) {
+    void *p = xmalloc_at(n, file, line, func);
     memcpy(p, src, n);
     return p;
 }
 
+#define xmalloc(size)                                   \
+    xmalloc_at((size), __FILE__, __LINE__, __func__)
+#define xmallocarray(nmemb, size)                                       \
+    xmallocarray_at((nmemb), (size), __FILE__, __LINE__, __func__)
+#define xreallocarray(ptr, nmemb, size)                                 \
+    xreallocarray_at((ptr), (nmemb), (size), __FILE__, __LINE__, __func__)
+#define xcallocarray(nmemb, size)                                       \
+    xcallocarray_at((nmemb), (size), __FILE__, __LINE__, __func__)
+#define xstrdup(str)                                    \
+    xstrdup_at((str), __FILE__, __LINE__, __func__)
+#define xmemcpy(src, n)                                 \
+    xmemcpy_at((src), (n), __FILE__, __LINE__, __func__)
+
+/// Free memory allocated by the functions above (or `malloc` etc.).
 
+static UNUSED
+void xfree(void *ptr) {
+    if (__CJ50_xmem_stats && ptr) {
+        _xmem_record_free(ptr);
+    }
+    free(ptr);
+}
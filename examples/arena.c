@@ -0,0 +1,108 @@
+#include <cj50.h>
+
+// One "frame" of an animation: temporary points and a label, all
+// allocated from `arena`, which is reset at the start.
+float frame(Arena *arena, int i) {
+    reset_Arena(arena);
+    int n = 100 + (i % 7) * 300;
+    ArenaVec(Vec2(float)) points = new_ArenaVec_Vec2_float(arena);
+    for (int j = 0; j < n; j++) {
+        float a = 2 * M_PI * j / n;
+        push_ArenaVec_Vec2_float(&points, vec2_float(cosf(a), sinf(a)));
+    }
+    ArenaString label = new_ArenaString(arena);
+    push_fmt_ArenaString(&label, "frame %i: ", i);
+    push_fmt_ArenaString(&label, "%i points", n);
+    // Another vector growing at the same time: no longer the most
+    // recent allocation, `points` has to be copied when growing
+    ArenaVec(Vec2(float)) hull = new_ArenaVec_Vec2_float(arena);
+    float sum = 0;
+    for (size_t j = 0; j < points.len; j++) {
+        const Vec2(float) *p = at_ArenaVec_Vec2_float(&points, j);
+        if (j % 10 == 0) {
+            push_ArenaVec_Vec2_float(&hull, *p);
+        }
+        sum += p->x * p->x + p->y * p->y;
+    }
+    assert(hull.len == (size_t)(n + 9) / 10);
+    if (i % 8 == 0) {
+        print_ArenaString(&label);
+        printf(", sum of squares %.0f\n", sum);
+    }
+    return sum;
+}
+
+void check_alloc() {
+    Arena arena = with_chunk_size_Arena(100);
+    char *c = ARENA_ALLOC(&arena, char, 3);
+    double *d = ARENA_ALLOC(&arena, double, 5);
+    assert((uintptr_t)d % _Alignof(double) == 0);
+    assert((char*)d > c);
+    // Larger than the chunk size: gets a chunk of its own
+    int *big = ARENA_ALLOC(&arena, int, 1000);
+    for (int i = 0; i < 1000; i++) {
+        big[i] = i;
+    }
+    // Growing the most recent allocation stays in place if it fits
+    int *grown = realloc_Arena(&arena, big, 1000 * sizeof(int),
+                               1001 * sizeof(int), _Alignof(int));
+    assert(grown[999] == 999);
+    // Several chunks are merged into one on reset
+    size_t cap = capacity_Arena(&arena);
+    reset_Arena(&arena);
+    assert(used_Arena(&arena) == 0);
+    assert(capacity_Arena(&arena) >= cap);
+    d = ARENA_ALLOC(&arena, double, 1);
+    assert(used_Arena(&arena) == sizeof(double));
+    drop(arena);
+}
+
+void check_string() {
+    Arena arena = new_Arena();
+    ArenaString s = new_ArenaString(&arena);
+    push_str_ArenaString(&s, new_strslice("héllo", 6));
+    push_ArenaString(&s, ' ');
+    push_fmt_ArenaString(&s, "%s %.1f", "wörld", 2.5);
+    String copy = to_String_ArenaString(&s);
+    reset_Arena(&arena);
+    print_move_cstr("copy after reset: ");
+    print_debug(&copy);
+    print_move_cstr("\n");
+    ArenaString t = new_ArenaString(&arena);
+    push_ArenaString(&t, 'a');
+    push_ArenaString(&t, '\0');
+    assert(!cstr_ArenaString(&t).is_some);
+    clear_ArenaString(&t);
+    push_fmt_ArenaString(&t, "%i", 42);
+    assert(strcmp(unwrap(cstr_ArenaString(&t)), "42") == 0);
+    drop(copy);
+    drop(arena);
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+    // Small chunks, to see them being merged
+    Arena arena = with_chunk_size_Arena(4096);
+    size_t cap_after_warmup = 0;
+    for (int i = 0; i < 60; i++) {
+        frame(&arena, i);
+        if (i == 7) {
+            cap_after_warmup = capacity_Arena(&arena);
+        }
+    }
+    // Once every frame size was seen (and the chunks merged by
+    // `reset_Arena`), no more memory was needed
+    assert(capacity_Arena(&arena) == cap_after_warmup);
+    print_move_cstr("after 60 frames: ");
+    print_debug_Arena(&arena);
+    print_move_cstr("\n");
+    drop(arena);
+
+    check_alloc();
+    check_string();
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,88 @@
+#include <cj50.h>
+#include <cj50/instantiations/Atomic_int.h>
+#include <cj50/instantiations/Atomic_ref_void.h>
+#include <cj50/instantiations/Atomic_u32.h>
+
+#define NUM_THREADS 4
+#define NUM_ITERATIONS 500000
+
+typedef struct Shared {
+    Atomic(int) sum;
+    Atomic(int) max;
+    Counter events;
+    // The first thread to get here stores its argument
+    Atomic(ref(void)) winner;
+} Shared;
+
+typedef struct Worker {
+    Shared *shared;
+    int id;
+} Worker;
+
+// Raise `max` to `val` if it is smaller.
+void update_max(Atomic(int) *max, int val) {
+    int cur = load_Atomic_int(max, memory_order_relaxed);
+    while ((cur < val)
+           && !compare_exchange_weak_Atomic_int(max, &cur, val,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        // `cur` has been updated, try again
+    }
+}
+
+void* work(void *arg) {
+    Worker *w = arg;
+    Shared *s = w->shared;
+    const void *none = NULL;
+    compare_exchange_Atomic_ref_void(&s->winner, &none, w,
+                                     memory_order_acq_rel,
+                                     memory_order_acquire);
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        fetch_add_Atomic_int(&s->sum, 1, memory_order_relaxed);
+        add_Counter(&s->events, 2);
+        update_max(&s->max, i * NUM_THREADS + w->id);
+    }
+    return NULL;
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    Shared shared = {
+        .sum = new_Atomic_int(0),
+        .max = new_Atomic_int(-1),
+        .events = new_Counter(),
+        .winner = new_Atomic_ref_void(NULL)
+    };
+    Worker workers[NUM_THREADS];
+    Thread ts[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+        workers[i] = (Worker) { .shared = &shared, .id = i };
+        ts[i] = unwrap_Result_Thread__SystemError(
+            spawn_thread(work, &workers[i], new_String_from_move_int(i)));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        unwrap_Result_ref_void__SystemError(join_Thread(ts[i]));
+    }
+
+    print_debug_Atomic_int(&shared.sum);
+    printf("\n");
+    DBG(load_Atomic_int(&shared.max, memory_order_relaxed));
+    DBG(get_Counter(&shared.events));
+    const Worker *winner = load_Atomic_ref_void(&shared.winner,
+                                                memory_order_acquire);
+    DBG((winner >= workers) && (winner < workers + NUM_THREADS));
+
+    Atomic(u32) bits = new_Atomic_u32(0xF0);
+    DBG(fetch_or_Atomic_u32(&bits, 0x0F, memory_order_relaxed));
+    DBG(fetch_and_Atomic_u32(&bits, 0x3C, memory_order_relaxed));
+    DBG(fetch_xor_Atomic_u32(&bits, 0xFF, memory_order_relaxed));
+    DBG(swap_Atomic_u32(&bits, 7, memory_order_relaxed));
+    DBG(load_Atomic_u32(&bits, memory_order_relaxed));
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,118 @@
+#include <cj50.h>
+#include <cj50/instantiations/Channel_int.h>
+
+#define T String
+#include <cj50/gen/template/Channel.h>
+#undef T
+
+#define NUM_WORKERS 3
+
+// The stages of a pipeline: the main thread sends numbers to
+// `input`, workers turn them into strings and send those to
+// `output`, which the collector thread reads.
+typedef struct Pipeline {
+    Channel(int) input;
+    Channel(String) output;
+} Pipeline;
+
+void* worker(void *arg) {
+    Pipeline *p = arg;
+    while (true) {
+        AUTO r = recv_Channel_int(&p->input);
+        if (!r.is_ok) {
+            break;
+        }
+        String s = new_String_from_move_size_t((size_t)r.ok * r.ok);
+        unwrap_Result_Unit__ChannelError(send_Channel_String(&p->output, s));
+    }
+    return NULL;
+}
+
+typedef struct Collected {
+    Channel(String) *output;
+    size_t count;
+    long sum;
+} Collected;
+
+void* collector(void *arg) {
+    Collected *c = arg;
+    while (true) {
+        AUTO r = recv_Channel_String(c->output);
+        if (!r.is_ok) {
+            break;
+        }
+        c->count++;
+        cstr s = unwrap_Option_cstr(cstr_String(&r.ok));
+        c->sum += atol(s);
+        drop_String(r.ok);
+    }
+    return NULL;
+}
+
+Result(Unit, String) run(slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    if (argv.len != 2) {
+        RETURN_Err(String("usage: channel n"), cleanup1);
+    }
+    int n = unwrap(parse_int(argv.ptr[1]));
+
+    // The non-blocking functions
+    Channel(int) small = new_Channel_int(2);
+    DBG(capacity_Channel_int(&small));
+    int v = 1;
+    print_debug_move_Result_Unit__ChannelError(try_send_Channel_int(&small, &v));
+    print_debug_move_Result_Unit__ChannelError(try_send_Channel_int(&small, &v));
+    print_debug_move_Result_Unit__ChannelError(try_send_Channel_int(&small, &v));
+    printf("\n");
+    print_debug_move_Result_int__ChannelError(try_recv_Channel_int(&small));
+    print_debug_move_Result_int__ChannelError(try_recv_Channel_int(&small));
+    print_debug_move_Result_int__ChannelError(try_recv_Channel_int(&small));
+    printf("\n");
+    unwrap_Result_Unit__ChannelError(send_Channel_int(&small, 2));
+    close_Channel_int(&small);
+    print_debug_move_Result_Unit__ChannelError(send_Channel_int(&small, 3));
+    print_debug_move_Result_int__ChannelError(recv_Channel_int(&small));
+    print_debug_move_Result_int__ChannelError(recv_Channel_int(&small));
+    printf("\n");
+    drop_Channel_int(small);
+
+    // Values left in the channel are dropped with it
+    Channel(String) left = new_Channel_String(4);
+    unwrap_Result_Unit__ChannelError(send_Channel_String(&left, String("a")));
+    drop_Channel_String(left);
+
+    // The pipeline, with small channels so that the threads have to
+    // wait for each other
+    Pipeline p = {
+        .input = new_Channel_int(4),
+        .output = new_Channel_String(4)
+    };
+    Collected c = { .output = &p.output, .count = 0, .sum = 0 };
+    Thread workers[NUM_WORKERS];
+    for (int i = 0; i < NUM_WORKERS; i++) {
+        workers[i] = unwrap_Result_Thread__SystemError(
+            spawn_thread(worker, &p, String("worker")));
+    }
+    Thread coll = unwrap_Result_Thread__SystemError(
+        spawn_thread(collector, &c, String("collector")));
+    for (int i = 1; i <= n; i++) {
+        unwrap_Result_Unit__ChannelError(send_Channel_int(&p.input, i));
+    }
+    close_Channel_int(&p.input);
+    for (int i = 0; i < NUM_WORKERS; i++) {
+        unwrap_Result_ref_void__SystemError(join_Thread(workers[i]));
+    }
+    close_Channel_String(&p.output);
+    unwrap_Result_ref_void__SystemError(join_Thread(coll));
+    printf("%zu squares, sum %li (expected %li)\n", c.count, c.sum,
+           (long)n * (n + 1) * (2 * n + 1) / 6);
+    drop_Channel_int(p.input);
+    drop_Channel_String(p.output);
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
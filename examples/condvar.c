@@ -0,0 +1,114 @@
+#include <cj50.h>
+#include <cj50/instantiations/Vec_int.h>
+
+// Work handed from a producer to consumer threads.
+typedef struct Jobs {
+    Vec(int) items;
+    bool done; // the producer won't add any more items
+} Jobs;
+
+static UNUSED
+void drop_Jobs(Jobs self) {
+    drop_Vec_int(self.items);
+}
+
+#define T Jobs
+#include <cj50/gen/template/Mutex.h>
+#undef T
+
+#define NUM_CONSUMERS 3
+
+typedef struct Shared {
+    Mutex(Jobs) jobs;
+    Condvar available;
+} Shared;
+
+typedef struct Consumer {
+    Shared *shared;
+    long sum;
+    int count;
+} Consumer;
+
+static
+bool nothing_to_do(Jobs *jobs, UNUSED void *ctx) {
+    return (jobs->items.len == 0) && !jobs->done;
+}
+
+void* consume(void *arg) {
+    Consumer *c = arg;
+    Shared *s = c->shared;
+    while (true) {
+        MutexGuard(Jobs) g = wait_while_Condvar_MutexGuard_Jobs(
+            &s->available, lock_Mutex_Jobs(&s->jobs), nothing_to_do, NULL);
+        Jobs *jobs = deref_mut_MutexGuard_Jobs(&g);
+        if_let_Some(item, pop_Vec_int(&jobs->items)) {
+            drop_MutexGuard_Jobs(g);
+            c->sum += item;
+            c->count++;
+        } else_None {
+            // done, and nothing left
+            drop_MutexGuard_Jobs(g);
+            return NULL;
+        }
+    }
+}
+
+Result(Unit, String) run(slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    if (argv.len != 2) {
+        RETURN_Err(String("usage: condvar n"), cleanup1);
+    }
+    int n = atoi(argv.ptr[1]);
+
+    Shared s = {
+        .jobs = new_Mutex_Jobs((Jobs) { .items = new_Vec_int(), .done = false }),
+        .available = new_Condvar()
+    };
+
+    Consumer cs[NUM_CONSUMERS];
+    Thread ts[NUM_CONSUMERS];
+    for (int i = 0; i < NUM_CONSUMERS; i++) {
+        cs[i] = (Consumer) { .shared = &s, .sum = 0, .count = 0 };
+        ts[i] = unwrap_Result_Thread__SystemError(
+            spawn_thread(consume, &cs[i], new_String_from_move_int(i)));
+    }
+
+    for (int i = 1; i <= n; i++) {
+        MutexGuard(Jobs) g = lock_Mutex_Jobs(&s.jobs);
+        push_Vec_int(&deref_mut_MutexGuard_Jobs(&g)->items, i);
+        drop_MutexGuard_Jobs(g);
+        notify_one_Condvar(&s.available);
+    }
+    {
+        MutexGuard(Jobs) g = lock_Mutex_Jobs(&s.jobs);
+        deref_mut_MutexGuard_Jobs(&g)->done = true;
+        drop_MutexGuard_Jobs(g);
+        notify_all_Condvar(&s.available);
+    }
+
+    long sum = 0;
+    int count = 0;
+    for (int i = 0; i < NUM_CONSUMERS; i++) {
+        unwrap_Result_ref_void__SystemError(join_Thread(ts[i]));
+        sum += cs[i].sum;
+        count += cs[i].count;
+    }
+    printf("consumed %i items, sum %li\n", count, sum);
+
+    // Nobody notifies anymore, thus this returns after the timeout.
+    MutexGuard(Jobs) g = lock_Mutex_Jobs(&s.jobs);
+    WaitTimeout(Jobs) w = wait_timeout_Condvar_MutexGuard_Jobs(
+        &s.available, g, (struct timespec) { .tv_sec = 0, .tv_nsec = 20000000 });
+    printf("timed out: %s\n", w.timed_out ? "true" : "false");
+    drop_MutexGuard_Jobs(w.guard);
+
+    drop_Condvar(s.available);
+    drop_Mutex_Jobs(s.jobs);
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,98 @@
+#include <cj50.h>
+#include <cj50/instantiations/HashMap_String__int.h>
+
+// A HashMap with int keys, instantiated right here.
+#define K int
+#define V int
+#include <cj50/gen/template/HashMap.h>
+#undef V
+#undef K
+
+// Count how often each argument appears, then show the counts in the
+// order of first appearance.
+void count_words(slice(cstr) words) {
+    HashMap(String, int) counts = new_HashMap_String__int();
+    Vec(cstr) order = new_Vec_cstr();
+    for (size_t i = 0; i < words.len; i++) {
+        String word = String(words.ptr[i]);
+        int n = 0;
+        if_let_Some(count, get_HashMap_String__int(&counts, &word)) {
+            n = *count;
+        } else_None {
+            push(&order, words.ptr[i]);
+        }
+        drop(insert_HashMap_String__int(&counts, word, n + 1));
+    }
+    for (size_t i = 0; i < order.len; i++) {
+        String word = String(order.ptr[i]);
+        printf("%s: %i\n", order.ptr[i],
+               *unwrap_Option_ref_int(
+                   get_HashMap_String__int(&counts, &word)));
+        drop(word);
+    }
+    DBG(len_HashMap_String__int(&counts));
+
+    String missing = String("missing");
+    DBG(contains_key_HashMap_String__int(&counts, &missing) ? 1 : 0);
+    drop(missing);
+    drop(order);
+    drop_HashMap_String__int(counts);
+}
+
+// Insert and remove lots of keys, checking against an array.
+void check_int_keys() {
+    enum { N = 5000 };
+    bool present[N] = { false };
+    int values[N];
+    HashMap(int, int) m = new_HashMap_int__int();
+    u64 x = 1;
+    for (int round = 0; round < 200000; round++) {
+        x = x * 6364136223846793005 + 1442695040888963407;
+        int k = (x >> 33) % N;
+        if ((x >> 20) & 1) {
+            Option(int) old = insert_HashMap_int__int(&m, k, round);
+            assert(old.is_some == present[k]);
+            assert(!old.is_some || old.value == values[k]);
+            present[k] = true;
+            values[k] = round;
+        } else {
+            Option(int) old = remove_HashMap_int__int(&m, &k);
+            assert(old.is_some == present[k]);
+            assert(!old.is_some || old.value == values[k]);
+            present[k] = false;
+        }
+    }
+    size_t n = 0;
+    for (int k = 0; k < N; k++) {
+        if_let_Some(v, get_HashMap_int__int(&m, &k)) {
+            assert(present[k] && *v == values[k]);
+            n++;
+        } else_None {
+            assert(!present[k]);
+        }
+    }
+    size_t n_iter = 0;
+    HashMapIter(int, int) it = iter_HashMap_int__int(&m);
+    while_let_Some(entry, next_HashMapIter_int__int(&it)) {
+        assert(present[entry->key] && entry->value == values[entry->key]);
+        n_iter++;
+    }
+    assert(n == n_iter);
+    assert(n == len_HashMap_int__int(&m));
+    printf("int keys: %zu entries, all found\n", n);
+
+    clear_HashMap_int__int(&m);
+    DBG(len_HashMap_int__int(&m));
+    drop_HashMap_int__int(m);
+}
+
+Result(Unit, String) run(slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+    count_words(slice_of_slice_cstr(&argv, range(1, argv.len)));
+    check_int_keys();
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,143 @@
+#include <cj50.h>
+#include <cj50/instantiations/BinaryHeap_int.h>
+
+// A task for a scheduler: the one with the earliest deadline should
+// run first, thus `cmp_Task` is reversed so that the heap, which
+// hands out its largest element first, yields the earliest one.
+typedef struct Task {
+    int deadline;
+    int id;
+} Task;
+
+static void drop_Task(UNUSED Task self) {}
+
+static bool equal_Task(const Task *a, const Task *b) {
+    return (a->deadline == b->deadline) && (a->id == b->id);
+}
+
+static int cmp_Task(const Task *a, const Task *b) {
+    int c = cmp_int(&b->deadline, &a->deadline);
+    return c ? c : cmp_int(&b->id, &a->id);
+}
+
+static int print_debug_Task(const Task *self) {
+    return printf("(Task) { .deadline = %i, .id = %i }",
+                  self->deadline, self->id);
+}
+
+GENERATE_Option(Task);
+GENERATE_ref(Task);
+GENERATE_Option(ref(Task));
+
+#define T Task
+#include <cj50/gen/template/Vec.h>
+#include <cj50/gen/template/BinaryHeap.h>
+#undef T
+
+// The `k` largest numbers, largest first, keeping at most `k`
+// numbers at once (in a min-heap, via negation).
+Vec(int) top_k(slice(int) nums, size_t k) {
+    QuadHeap(int) h = new_QuadHeap_int();
+    for (size_t i = 0; i < nums.len; i++) {
+        push_QuadHeap_int(&h, -nums.ptr[i]);
+        if (len_QuadHeap_int(&h) > k) {
+            pop_QuadHeap_int(&h);
+        }
+    }
+    Vec(int) result = into_sorted_Vec_QuadHeap_int(h);
+    for (size_t i = 0; i < result.len; i++) {
+        result.ptr[i] = -result.ptr[i];
+    }
+    return result;
+}
+
+// Check that pops come out in descending order, for both arities,
+// and that `from_Vec` and `into_sorted_Vec` agree.
+void check_random() {
+    u64 x = 1;
+    for (int round = 0; round < 200; round++) {
+        BinaryHeap(int) h2 = new_BinaryHeap_int();
+        QuadHeap(int) h4 = new_QuadHeap_int();
+        Vec(int) v = new_Vec_int();
+        int n = round * 7;
+        for (int i = 0; i < n; i++) {
+            x = x * 6364136223846793005 + 1442695040888963407;
+            int val = (x >> 33) % (round + 1);
+            push_BinaryHeap_int(&h2, val);
+            push_QuadHeap_int(&h4, val);
+            push(&v, val);
+        }
+        Vec(int) copy = new_Vec_int();
+        extend_from_slice(&copy, deref_Vec_int(&v));
+        Vec(int) sorted = into_sorted_Vec_QuadHeap_int(
+            from_Vec_QuadHeap_int(copy));
+        for (int i = 1; i < n; i++) {
+            assert(sorted.ptr[i - 1] <= sorted.ptr[i]);
+        }
+        Vec(int) sorted2 = into_sorted_Vec_BinaryHeap_int(
+            from_Vec_BinaryHeap_int(v));
+        assert(equal(&sorted, &sorted2));
+        for (int i = n; i-- > 0; ) {
+            assert(*unwrap_Option_ref_int(peek_BinaryHeap_int(&h2))
+                   == sorted.ptr[i]);
+            assert(unwrap(pop_BinaryHeap_int(&h2)) == sorted.ptr[i]);
+            assert(unwrap(pop_QuadHeap_int(&h4)) == sorted.ptr[i]);
+        }
+        assert(is_empty_BinaryHeap_int(&h2));
+        assert(!pop_QuadHeap_int(&h4).is_some);
+        drop(sorted2);
+        drop(sorted);
+        drop_QuadHeap_int(h4);
+        drop_BinaryHeap_int(h2);
+    }
+}
+
+Result(Unit, String) run(slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+    Vec(int) nums = new_Vec_int();
+    for (size_t i = 1; i < argv.len; i++) {
+        push(&nums, unwrap(parse_int(argv.ptr[i])));
+    }
+
+    Vec(int) copy = new_Vec_int();
+    extend_from_slice(&copy, deref_Vec_int(&nums));
+    BinaryHeap(int) h = from_Vec_BinaryHeap_int(copy);
+    print_move_cstr("heap: ");
+    print_debug_BinaryHeap_int(&h);
+    print_move_cstr("\n");
+    Vec(int) sorted = into_sorted_Vec_BinaryHeap_int(h);
+    print_move_cstr("sorted: ");
+    print_debug(&sorted);
+    print_move_cstr("\n");
+
+    Vec(int) top = top_k(deref_Vec_int(&nums), 3);
+    print_move_cstr("top 3: ");
+    print_debug(&top);
+    print_move_cstr("\n");
+
+    BinaryHeap(Task) tasks = new_BinaryHeap_Task();
+    for (size_t i = 0; i < nums.len; i++) {
+        push_BinaryHeap_Task(&tasks, (Task) {
+                .deadline = nums.ptr[i], .id = i });
+    }
+    if_let_Some(t, peek_BinaryHeap_Task(&tasks)) {
+        print_move_cstr("next: ");
+        print_debug_Task(t);
+        print_move_cstr("\n");
+    } else_None {}
+    while_let_Some(t, pop_BinaryHeap_Task(&tasks)) {
+        printf("run task %i (deadline %i)\n", t.id, t.deadline);
+    }
+
+    check_random();
+
+    drop_BinaryHeap_Task(tasks);
+    drop(top);
+    drop(sorted);
+    drop(nums);
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
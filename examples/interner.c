@@ -0,0 +1,61 @@
+#include <cj50.h>
+#include <cj50/instantiations/HashSet_String.h>
+
+// Read words (separated by spaces) from stdin, and print the symbol
+// of each word; then print the distinct words.
+Result(Unit, UnicodeError) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, UnicodeError);
+
+    AUTO in = new_BufReader(0);
+    Interner interner = new_Interner();
+    // To cross-check with owned Strings.
+    HashSet(String) words = new_HashSet_String();
+    Vec(ucodepoint) line = new_Vec_ucodepoint();
+    String word = new_String();
+    while (true) {
+        size_t n = TRY(read_line(&in, &line, false, 1000), cleanup1);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i <= line.len; i++) {
+            if ((i == line.len) || (line.ptr[i].u32 == ' ')
+                || (line.ptr[i].u32 == '\n')) {
+                if (len_String(&word)) {
+                    u32 sym = intern_Interner(&interner, deref_String(&word));
+                    printf("%u ", sym);
+                    insert_HashSet_String(&words, word);
+                    word = new_String();
+                }
+            } else {
+                push_ucodepoint_String(&word, line.ptr[i]);
+            }
+        }
+        printf("\n");
+        clear(&line);
+    }
+    DBG(len_Interner(&interner));
+    assert(len_Interner(&interner) == len_HashSet_String(&words));
+    for (size_t sym = 0; sym < len_Interner(&interner); sym++) {
+        strslice s = resolve_Interner(&interner, sym);
+        printf("%zu: ", sym);
+        print_debug_strslice(&s);
+        printf("\n");
+        String owned = new_String_from_slice_char(s.slice);
+        assert(contains_HashSet_String(&words, &owned));
+        drop(owned);
+    }
+    String missing = String("missing");
+    DBG(get_Interner(&interner, deref_String(&missing)).is_some ? 1 : 0);
+    drop(missing);
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    drop(word);
+    drop(line);
+    drop_HashSet_String(words);
+    drop(interner);
+    drop(in);
+    END_Result();
+}
+
+MAIN(run);
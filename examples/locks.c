@@ -0,0 +1,126 @@
+#include <cj50.h>
+#include <cj50/instantiations/Mutex_int.h>
+#include <cj50/instantiations/AdaptiveMutex_int.h>
+
+// A table that is read a lot and rarely changed: the sum of the
+// entries is always kept at 0, so that readers can check that they
+// never see a half-done update.
+typedef struct Table {
+    int entries[16];
+} Table;
+
+static UNUSED
+void drop_Table(UNUSED Table self) {}
+
+#define T Table
+#include <cj50/gen/template/RwLock.h>
+#undef T
+
+#define NUM_THREADS 4
+#define NUM_ITERATIONS 200000
+
+void* count_adaptive(void *arg) {
+    AdaptiveMutex(int) *counter = arg;
+    for (size_t i = 0; i < NUM_ITERATIONS; i++) {
+        AdaptiveMutexGuard(int) g = lock_AdaptiveMutex_int(counter);
+        (*deref_mut_AdaptiveMutexGuard_int(&g))++;
+        drop_AdaptiveMutexGuard_int(g);
+    }
+    return NULL;
+}
+
+void* count_mutex(void *arg) {
+    Mutex(int) *counter = arg;
+    for (size_t i = 0; i < NUM_ITERATIONS; i++) {
+        MutexGuard(int) g = lock_Mutex_int(counter);
+        (*deref_mut_MutexGuard_int(&g))++;
+        drop_MutexGuard_int(g);
+    }
+    return NULL;
+}
+
+// Thread 0 updates the table, the others read it.
+typedef struct TableUser {
+    RwLock(Table) *table;
+    int id;
+    int bad_reads;
+} TableUser;
+
+void* use_table(void *arg) {
+    TableUser *u = arg;
+    for (int i = 0; i < NUM_ITERATIONS / 10; i++) {
+        if (u->id == 0) {
+            RwLockWriteGuard(Table) w = write_RwLock_Table(u->table);
+            Table *t = deref_mut_RwLockWriteGuard_Table(&w);
+            t->entries[i % 16] += i;
+            t->entries[(i + 1) % 16] -= i;
+            drop_RwLockWriteGuard_Table(w);
+        } else {
+            RwLockReadGuard(Table) r = read_RwLock_Table(u->table);
+            const Table *t = deref_RwLockReadGuard_Table(&r);
+            int sum = 0;
+            for (int j = 0; j < 16; j++) {
+                sum += t->entries[j];
+            }
+            if (sum != 0) {
+                u->bad_reads++;
+            }
+            drop_RwLockReadGuard_Table(r);
+        }
+    }
+    return NULL;
+}
+
+// Run `run(args[i])` in NUM_THREADS threads and wait for them to
+// finish.
+void run_threads(void *(*run)(void *), void *args[NUM_THREADS]) {
+    Thread ts[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+        ts[i] = unwrap_Result_Thread__SystemError(
+            spawn_thread(run, args[i], new_String_from_move_int(i)));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        unwrap_Result_ref_void__SystemError(join_Thread(ts[i]));
+    }
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    Mutex(int) m = new_Mutex_int(0);
+    void *margs[NUM_THREADS] = { &m, &m, &m, &m };
+    run_threads(count_mutex, margs);
+    MutexGuard(int) mg = lock_Mutex_int(&m);
+    printf("Mutex count: %i\n", *deref_MutexGuard_int(&mg));
+    drop_MutexGuard_int(mg);
+    drop_Mutex_int(m);
+
+    AdaptiveMutex(int) a = new_AdaptiveMutex_int(0);
+    void *aargs[NUM_THREADS] = { &a, &a, &a, &a };
+    run_threads(count_adaptive, aargs);
+    AdaptiveMutexGuard(int) ag = lock_AdaptiveMutex_int(&a);
+    printf("AdaptiveMutex count: %i\n", *deref_AdaptiveMutexGuard_int(&ag));
+    drop_AdaptiveMutexGuard_int(ag);
+    drop_AdaptiveMutex_int(a);
+
+    RwLock(Table) table = new_RwLock_Table((Table) { .entries = { 0 } });
+    TableUser users[NUM_THREADS];
+    void *uargs[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+        users[i] = (TableUser) { .table = &table, .id = i, .bad_reads = 0 };
+        uargs[i] = &users[i];
+    }
+    run_threads(use_table, uargs);
+    int bad_reads = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        bad_reads += users[i].bad_reads;
+    }
+    printf("RwLock: %i inconsistent reads\n", bad_reads);
+    drop_RwLock_Table(table);
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
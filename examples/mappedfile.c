@@ -0,0 +1,14 @@
+#include <cj50.h>
+
+int main(int argc, char** argv) {
+    assert(argc == 2);
+    cstr path = argv[1];
+    if_let_Ok(m, open_MappedFile(path, 10000)) {
+        print(deref(&m));
+        drop(m);
+    } else_Err(e) {
+        fprintln(stderr, &e);
+        drop(e);
+        exit(1);
+    } end_let_Ok;
+}
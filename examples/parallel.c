@@ -0,0 +1,72 @@
+#include <cj50.h>
+#include <cj50/instantiations/Mutex_int.h>
+
+void scale(Vec2(float) *p, void *ctx) {
+    float *factor = ctx;
+    *p = mul(*p, *factor);
+}
+
+Vec2(float) swap_xy(const Vec2(float) *p, UNUSED void *ctx) {
+    return vec2_float(p->y, p->x);
+}
+
+double plus(double a, double b, UNUSED void *ctx) {
+    return a + b;
+}
+
+void add_x_to_sum(const Vec2(float) *p, void *ctx) {
+    Mutex(int) *sum = ctx;
+    MutexGuard(int) g = lock_Mutex_int(sum);
+    *deref_mut_MutexGuard_int(&g) += p->x;
+    drop_MutexGuard_int(g);
+}
+
+Result(Unit, SystemError) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, SystemError);
+
+    ThreadPool pool = TRY(new_ThreadPool(4), cleanup1);
+
+    size_t n = 100000;
+    Vec(Vec2(float)) points = new_Vec_Vec2_float();
+    for (size_t i = 0; i < n; i++) {
+        push(&points, vec2_float(i % 100, 1));
+    }
+
+    float factor = 2;
+    parallel_for(&pool, mutslice_of_Vec_Vec2_float(&points, range(0, n)),
+                 scale, &factor);
+    DBG(&points.ptr[99]);
+
+    Vec(Vec2(float)) swapped = parallel_map(&pool, deref(&points),
+                                            swap_xy, NULL);
+    DBG(&swapped.ptr[99]);
+
+    Mutex(int) sum = new_Mutex_int(0);
+    parallel_for(&pool, slice_of_Vec_Vec2_float(&swapped, range(0, 1000)),
+                 add_x_to_sum, &sum);
+    MutexGuard(int) g = lock_Mutex_int(&sum);
+    DBG(*deref_MutexGuard_int(&g));
+    drop_MutexGuard_int(g);
+    drop_Mutex_int(sum);
+
+    Vec(double) nums = new_Vec_double();
+    for (size_t i = 0; i < n; i++) {
+        push(&nums, i);
+    }
+    double total = parallel_reduce(&pool, deref(&nums), 0., plus, NULL);
+    DBG(total);
+
+    double empty_total = parallel_reduce(
+        &pool, slice_of_Vec_double(&nums, range(0, 0)), 0., plus, NULL);
+    DBG(empty_total);
+
+    drop(nums);
+    drop(swapped);
+    drop(points);
+    drop(pool);
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -1,6 +1,7 @@
 #include <cj50.h>
 
 int main(int argc, cstr* argv) {
+    seed_random_from_env("CJ50_SEED"); // implied if using MAIN macro
     if (argc != 2) {
         DIE("usage: random range");
     }
@@ -46,4 +47,15 @@ int main(int argc, cstr* argv) {
         assert(r < 1.);
     }
 
+    print("And a Vec of ints from a split off generator:\n");
+    Rng rng = split_Rng(thread_Rng());
+    Vec(int) v = new_Vec_int();
+    fill_random_Vec_int(&v, 10, range, &rng);
+    for (size_t i = 0; i < v.len; i++) {
+        print(v.ptr[i]);
+        print("\n");
+        assert(v.ptr[i] >= 0);
+        assert(v.ptr[i] < range);
+    }
+    drop(v);
 }
@@ -0,0 +1,31 @@
+#include <cj50.h>
+
+Result(Unit, UnicodeError) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, UnicodeError);
+
+    // Using a tiny buffer here to show that lines and UTF-8 sequences
+    // may span multiple refills; `new_BufReader(0)` would be the
+    // normal choice.
+    AUTO in = new_BufReader_with_capacity(0, 5);
+    Vec(ucodepoint) line = new_Vec_ucodepoint();
+    size_t lineno = 0;
+    while (true) {
+        size_t n = TRY(read_line(&in, &line, false, 1000), cleanup1);
+        if (n == 0) {
+            break;
+        }
+        lineno++;
+        printf("%zu (%zu): ", lineno, n);
+        for (size_t i = 0; i < line.len; i++) {
+            print(line.ptr[i]);
+        }
+        clear(&line);
+    }
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    drop(line);
+    drop(in);
+    END_Result();
+}
+
+MAIN(run);
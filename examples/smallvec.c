@@ -0,0 +1,109 @@
+#include <cj50.h>
+#include <cj50/instantiations/SmallVec_int_8.h>
+
+// The positions of the given character in a line of text; most lines
+// contain only a few of them, so the positions usually fit into the
+// `SmallVec` without allocating.
+SmallVec(int, 8) positions_of(const char *line, char c) {
+    SmallVec(int, 8) v = new_SmallVec_int_8();
+    for (int i = 0; line[i]; i++) {
+        if (line[i] == c) {
+            push_SmallVec_int_8(&v, i);
+        }
+    }
+    return v;
+}
+
+// Compare against a `Vec(int)` receiving the same operations.
+void check_against_Vec() {
+    SmallVec(int, 8) v = new_SmallVec_int_8();
+    Vec(int) model = new_Vec_int();
+    u64 x = 1;
+    size_t spills = 0;
+    for (int round = 0; round < 100000; round++) {
+        x = x * 6364136223846793005 + 1442695040888963407;
+        switch ((x >> 33) % 8) {
+        case 0:
+        case 1:
+        case 2:
+            push_SmallVec_int_8(&v, round);
+            push(&model, round);
+            break;
+        case 3:
+        case 4: {
+            Option(int) a = pop_SmallVec_int_8(&v);
+            Option(int) b = pop(&model);
+            assert(a.is_some == b.is_some);
+            assert(!a.is_some || (a.value == b.value));
+            break;
+        }
+        case 5: {
+            int items[3] = { round, -round, round };
+            extend_from_slice_SmallVec_int_8(&v, new_slice_int(items, 3));
+            extend_from_slice_Vec_int(&model, new_slice_int(items, 3));
+            break;
+        }
+        case 6:
+            if ((x >> 40) % 64 == 0) {
+                // Start over from an inline vector
+                spills += is_spilled_SmallVec_int_8(&v);
+                drop_SmallVec_int_8(v);
+                v = new_SmallVec_int_8();
+                clear_Vec_int(&model);
+            }
+            break;
+        case 7: {
+            size_t i = (x >> 40) % 16;
+            if_let_Some(p, get_SmallVec_int_8(&v, i)) {
+                assert(*p == model.ptr[i]);
+            } else_None {
+                assert(i >= model.len);
+            }
+            break;
+        }
+        }
+        slice(int) s = deref_SmallVec_int_8(&v);
+        slice(int) m = deref_Vec_int(&model);
+        assert(equal_slice_int(&s, &m));
+    }
+    printf("SmallVec matches Vec (%zu spilled)\n", spills);
+    drop_SmallVec_int_8(v);
+    drop(model);
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    const char *lines[] = {
+        "a,b,c",
+        "no commas here",
+        ",,,,,,,,,,",
+    };
+    for (size_t i = 0; i < 3; i++) {
+        SmallVec(int, 8) v = positions_of(lines[i], ',');
+        print_debug_SmallVec_int_8(&v);
+        printf(" (%zu, spilled: %s)\n", len_SmallVec_int_8(&v),
+               is_spilled_SmallVec_int_8(&v) ? "yes" : "no");
+        drop_SmallVec_int_8(v);
+    }
+
+    SmallVec(int, 8) v = new_SmallVec_int_8();
+    for (int i = 1; i <= 5; i++) {
+        push_SmallVec_int_8(&v, (6 - i) * (6 - i));
+    }
+    mutslice(int) m = deref_mut_SmallVec_int_8(&v);
+    sort(m);
+    print_debug_SmallVec_int_8(&v);
+    printf("\n");
+    DBG(*at_SmallVec_int_8(&v, 0));
+    DBG(capacity_SmallVec_int_8(&v));
+    drop_SmallVec_int_8(v);
+
+    check_against_Vec();
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,249 @@
+#include <cj50.h>
+
+// An item sorted by `key` only, to check that `sort_stable` keeps
+// items with equal keys in their original order (`pos`).
+typedef struct Item {
+    int key;
+    int pos;
+} Item;
+
+static void drop_Item(UNUSED Item self) {}
+
+static bool equal_Item(const Item *a, const Item *b) {
+    return (a->key == b->key) && (a->pos == b->pos);
+}
+
+static int cmp_Item(const Item *a, const Item *b) {
+    return cmp_int(&a->key, &b->key);
+}
+
+static int print_debug_Item(const Item *self) {
+    return printf("(Item) { .key = %i, .pos = %i }", self->key, self->pos);
+}
+
+GENERATE_Option(Item);
+GENERATE_ref(Item);
+GENERATE_Option(ref(Item));
+
+#define T Item
+#include <cj50/gen/template/Vec.h>
+#include <cj50/gen/template/sort.h>
+#undef T
+
+
+static u64 rng_state = 1;
+
+static u64 rng() {
+    rng_state = rng_state * 6364136223846793005 + 1442695040888963407;
+    return rng_state >> 16;
+}
+
+// Input patterns that are hard or special for sorting algorithms.
+enum { RANDOM, SORTED, REVERSED, EQUAL, FEW, SAWTOOTH, NUM_PATTERNS };
+
+static int pattern_value(int pattern, int i, int len) {
+    switch (pattern) {
+    case RANDOM: return (int)rng();
+    case SORTED: return i - len / 2;
+    case REVERSED: return len - i;
+    case EQUAL: return 7;
+    case FEW: return rng() % 4 - 2;
+    default: return i % 17;
+    }
+}
+
+static int qsort_cmp_int(const void *a, const void *b) {
+    return cmp_int(a, b);
+}
+
+static int qsort_cmp_double(const void *a, const void *b) {
+    return cmp_double(a, b);
+}
+
+// Compare `sort`, `sort_stable` and radix sort against `qsort`.
+void check_numbers() {
+    const int lens[] = { 0, 1, 2, 3, 19, 20, 21, 100, 255, 256, 1000, 5000 };
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        int len = lens[l];
+        for (int pattern = 0; pattern < NUM_PATTERNS; pattern++) {
+            Vec(int) a = new_Vec_int();
+            Vec(double) d = new_Vec_double();
+            Vec(u64) u = new_Vec_u64();
+            for (int i = 0; i < len; i++) {
+                int x = pattern_value(pattern, i, len);
+                push(&a, x);
+                push(&d, x * 0.25);
+                push_Vec_u64(&u, (u64)x * 0x100000001);
+            }
+            int *expected = xmallocarray(len + 1, sizeof(int));
+            if (len) {
+                memcpy(expected, a.ptr, len * sizeof(int));
+                qsort(expected, len, sizeof(int), qsort_cmp_int);
+            }
+
+            Vec(int) b = new_Vec_int();
+            extend_from_slice(&b, deref_Vec_int(&a));
+            Vec(int) c = new_Vec_int();
+            extend_from_slice(&c, deref_Vec_int(&a));
+            sort(&a);
+            sort_stable(&b);
+            radix_sort_mutslice_int(new_mutslice_int(c.ptr, c.len));
+            for (int i = 0; i < len; i++) {
+                assert(a.ptr[i] == expected[i]);
+                assert(b.ptr[i] == expected[i]);
+                assert(c.ptr[i] == expected[i]);
+            }
+
+            if (len) {
+                qsort(d.ptr, len, sizeof(double), qsort_cmp_double);
+            }
+            Vec(double) e = new_Vec_double();
+            extend_from_slice(&e, deref_Vec_double(&d));
+            sort(&e);
+            assert(equal(&d, &e));
+
+            sort(&u);
+            assert(is_sorted_slice_u64(new_slice_u64(u.ptr, u.len)));
+
+            free(expected);
+            drop(e);
+            drop(d);
+            drop_Vec_u64(u);
+            drop(c);
+            drop(b);
+            drop(a);
+        }
+    }
+    printf("numbers: all patterns sorted correctly\n");
+}
+
+void check_stable() {
+    Vec(Item) items = new_Vec_Item();
+    for (int i = 0; i < 3000; i++) {
+        push_Vec_Item(&items, (Item) { .key = rng() % 50, .pos = i });
+    }
+    sort_stable_Vec_Item(&items);
+    for (size_t i = 1; i < items.len; i++) {
+        const Item *a = &items.ptr[i - 1], *b = &items.ptr[i];
+        assert((a->key < b->key) || ((a->key == b->key) && (a->pos < b->pos)));
+    }
+    // Without radix sort, `sort` goes through pdqsort
+    sort_Vec_Item(&items);
+    assert(is_sorted_slice_Item(new_slice_Item(items.ptr, items.len)));
+    drop_Vec_Item(items);
+    printf("stable: equal keys kept in order\n");
+}
+
+void check_floats() {
+    Vec(float) v = new_Vec_float();
+    for (int i = 0; i < 1000; i++) {
+        push(&v, ((float)(rng() % 2001) - 1000) / 8);
+    }
+    push(&v, -INFINITY);
+    push(&v, INFINITY);
+    push(&v, -0.0f);
+    sort(&v);
+    assert(v.ptr[0] == -INFINITY);
+    assert(v.ptr[v.len - 1] == INFINITY);
+    assert(is_sorted_slice_float(new_slice_float(v.ptr, v.len)));
+    drop(v);
+    printf("floats: sorted correctly\n");
+}
+
+// NaNs and signed zeros, which `sort` must place the same way for
+// short inputs (pdqsort via `cmp_T`) as for long ones (radix sort):
+// negative NaNs first, then the numbers with -0.0 before 0.0, then
+// positive NaNs.
+#define DEF_CHECK_FLOAT_SPECIALS(T, U)                                  \
+    bool check_specials_##T(int len) {                                  \
+        Vec(T) v = new_Vec_##T();                                       \
+        for (int i = 0; i < len; i++) {                                 \
+            switch (i % 6) {                                            \
+            case 1: push(&v, (T)NAN); break;                            \
+            case 3: push(&v, (T)-NAN); break;                           \
+            case 4: push(&v, (T)(i % 4 ? 0.0 : -0.0)); break;           \
+            default: push(&v, (T)(len - i));                            \
+            }                                                           \
+        }                                                               \
+        Vec(T) r = new_Vec_##T();                                       \
+        extend_from_slice(&r, deref_Vec_##T(&v));                       \
+        sort(&v);                                                       \
+        radix_sort_mutslice_##T(new_mutslice_##T(r.ptr, r.len));        \
+        bool ok = is_sorted_slice_##T(new_slice_##T(v.ptr, v.len))      \
+            && ((len == 0) || (memcmp(v.ptr, r.ptr, len * sizeof(T)) == 0)); \
+        /* check the order explicitly, not only via cmp_T */            \
+        int phase = 0; /* -NaN, numbers, NaN */                         \
+        for (int i = 0; i < len; i++) {                                 \
+            T x = v.ptr[i];                                             \
+            U bits;                                                     \
+            memcpy(&bits, &x, sizeof(bits));                            \
+            bool neg = bits >> (sizeof(U) * 8 - 1);                     \
+            int p = isnan(x) ? (neg ? 0 : 2) : 1;                       \
+            ok = ok && (p >= phase);                                    \
+            phase = p;                                                  \
+            if ((i > 0) && (p == 1) && !isnan(v.ptr[i - 1])) {          \
+                ok = ok && (v.ptr[i - 1] <= x)                          \
+                    && !(signbit(x) && !signbit(v.ptr[i - 1]) && x == 0); \
+            }                                                           \
+        }                                                               \
+        drop(r);                                                        \
+        drop(v);                                                        \
+        return ok;                                                      \
+    }
+
+DEF_CHECK_FLOAT_SPECIALS(float, u32)
+DEF_CHECK_FLOAT_SPECIALS(double, u64)
+
+void check_float_specials() {
+    // On both sides of _SORT_RADIX_MIN_LEN
+    const int lens[] = { 0, 1, 3, 7, 20, 255, 256, 300, 1000 };
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        assert(check_specials_float(lens[l]));
+        assert(check_specials_double(lens[l]));
+    }
+
+    float small[] = { 3, NAN, 1 };
+    sort(new_mutslice_float(small, 3));
+    printf("{3, NaN, 1} sorted: {%g, %g, %g}\n", small[0], small[1], small[2]);
+
+    // 300, NaN, 298, NaN, ...
+    Vec(float) v = new_Vec_float();
+    for (int i = 0; i < 300; i++) {
+        push(&v, i % 2 ? NAN : 300 - i);
+    }
+    sort(&v);
+    printf("300 with NaNs sorted: {%g, %g, ..., %g, %g, ..., %g}\n",
+           v.ptr[0], v.ptr[1], v.ptr[149], v.ptr[150], v.ptr[299]);
+    drop(v);
+    printf("floats: NaN and -0.0 placed consistently\n");
+}
+
+Result(Unit, String) run(slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+    Vec(int) nums = new_Vec_int();
+    for (size_t i = 1; i < argv.len; i++) {
+        push(&nums, unwrap(parse_int(argv.ptr[i])));
+    }
+    sort(&nums);
+    print_debug(&nums);
+    print_move_cstr("\n");
+    const int xs[] = { 5, 4, -9, 99 };
+    for (size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); i++) {
+        int x = xs[i];
+        Result(size_t, size_t) r = binary_search(&nums, &x);
+        printf("binary_search %i: ", x);
+        print_debug_Result_size_t__size_t(&r);
+        print_move_cstr("\n");
+    }
+    drop(nums);
+
+    check_numbers();
+    check_stable();
+    check_floats();
+    check_float_specials();
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
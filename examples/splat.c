@@ -0,0 +1,81 @@
+#include <cj50.h>
+
+// Check `splat_points_Pixels_float` (which uses vector instructions
+// for points inside the image, and a clipped path near the edges)
+// against the plain formula.
+
+#define WIDTH 10
+#define HEIGHT 6
+
+// The light of all `points` as computed pixel by pixel, including
+// the border: `ref[y + 1][x + 1]` is pixel (x, y).
+void reference_splat(Vec3(float) ref[HEIGHT + 2][WIDTH + 2],
+                     slice(Vec2(float)) points, Vec3(float) color) {
+    for (size_t i = 0; i < points.len; i++) {
+        Vec2(float) p = points.ptr[i];
+        // NaN, or so far away that none of the 3x3 pixels around it
+        // is inside the image or border
+        if (! ((p.x >= -2.5f) && (p.x < WIDTH + 1.5f) &&
+               (p.y >= -2.5f) && (p.y < HEIGHT + 1.5f))) {
+            continue;
+        }
+        int px = floorf(p.x + 0.5f);
+        int py = floorf(p.y + 0.5f);
+        for (int y = py - 1; y <= py + 1; y++) {
+            for (int x = px - 1; x <= px + 1; x++) {
+                if ((x < -1) || (x > WIDTH) || (y < -1) || (y > HEIGHT)) {
+                    continue;
+                }
+                float attenuation = 1.f / MAX(
+                    0.32f, square(x - p.x) + square(y - p.y));
+                Vec3(float) *v = &ref[y + 1][x + 1];
+                *v = add_Vec3_float(*v, mul_Vec3_float_float(color, attenuation));
+            }
+        }
+    }
+}
+
+int main() {
+    DEF_SLICE(Vec2(float), points, {
+            // inside
+            { 3.2f, 2.7f }, { 5.f, 1.f }, { 3.4f, 2.6f }, { 8.49f, 4.51f },
+            // inside, next to the edges (3x3 reaching into the border)
+            { 0.1f, 0.4f }, { -0.5f, -0.5f }, { 9.4f, 5.49f },
+            // outside, partially visible (clipped)
+            { -0.51f, 2.f }, { -1.7f, 3.3f }, { 10.2f, 5.6f },
+            { 4.f, -2.4f }, { 11.4f, 7.4f }, { -2.5f, -2.5f },
+            // skipped
+            { NAN, 2.f }, { 3.f, NAN }, { NAN, NAN }, { INFINITY, 1.f },
+            { 1000.f, 2.f }, { 4.f, -1e9f }, { -2.51f, 3.f }, { 2.f, 7.5f }
+        });
+    Vec3(float) color = vec3_float(1.f, 0.5f, 0.25f);
+
+    Pixels_float pixels = new_Pixels_float(vec2_int(WIDTH, HEIGHT));
+    splat_points_Pixels_float(&pixels, points, color);
+
+    Vec3(float) ref[HEIGHT + 2][WIDTH + 2];
+    memset(ref, 0, sizeof(ref));
+    reference_splat(ref, points, color);
+
+    int mismatches = 0;
+    int lit = 0;
+    for (int y = -1; y <= HEIGHT; y++) {
+        for (int x = -1; x <= WIDTH; x++) {
+            Vec3(float) got = pixels.pixels[x + y * pixels.stride];
+            Vec3(float) expected = ref[y + 1][x + 1];
+            // Bit-identical, as the same operations are done in the
+            // same order
+            if (memcmp(&got, &expected, sizeof(got)) != 0) {
+                printf("mismatch at (%i, %i): (%g, %g, %g) vs (%g, %g, %g)\n",
+                       x, y, got.x, got.y, got.z,
+                       expected.x, expected.y, expected.z);
+                mismatches++;
+            }
+            lit += expected.x > 0.f;
+        }
+    }
+    printf("%i of %i pixels (with border) lit, %i mismatches\n",
+           lit, (WIDTH + 2) * (HEIGHT + 2), mismatches);
+    drop_Pixels_float(pixels);
+    return mismatches != 0;
+}
@@ -0,0 +1,83 @@
+#include <cj50.h>
+
+// Check that `s` has the same contents as the first `len` bytes of
+// `expected`, via several of the accessor functions.
+void check(String *s, const char *expected, size_t len) {
+    assert(len_String(s) == len);
+    strslice str = deref_String(s);
+    assert(str.slice.len == len);
+    assert(memcmp(str.slice.ptr, expected, len) == 0);
+    assert(capacity_String(s) >= len);
+    assert(hash_String(s) == hash_bytes(expected, len));
+}
+
+// Build strings of all lengths up to beyond the inline capacity via
+// push_String, and compare against a C array.
+void check_lengths() {
+    char expected[101];
+    String s = new_String();
+    for (size_t i = 0; i < 100; i++) {
+        expected[i] = 'a' + i % 26;
+        push_String(&s, expected[i]);
+        check(&s, expected, i + 1);
+        String t = new_String_from_slice_char(new_slice_char(expected, i + 1));
+        check(&t, expected, i + 1);
+        assert(equal_String(&s, &t));
+        if_let_Some(c, cstr_String(&t)) {
+            assert(strlen(c) == i + 1);
+        } else_None {
+            abort();
+        }
+        drop(t);
+        expected[i + 1] = '\0';
+        String u = new_String_from_CStr(cStr_from_cstr_unsafe(xstrdup(expected)));
+        check(&u, expected, i + 1);
+        drop(u);
+    }
+    clear_String(&s);
+    check(&s, expected, 0);
+    drop(s);
+    printf("all lengths fine\n");
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    String a = String("short");
+    String b = String("just long enough to not fit");
+    printf("%zu of %zu bytes: ", len_String(&a), capacity_String(&a));
+    println(&a);
+    printf("%zu bytes: ", len_String(&b));
+    println(&b);
+
+    push_ucodepoint_String(&a, uchar("→"));
+    append_String_String(&a, &b);
+    print_debug(&a);
+    printf(" (%zu bytes), ", len_String(&a));
+    print_debug(&b);
+    printf(" (emptied)\n");
+    drop(b);
+
+    String n = new_String_from(-1234567);
+    append_move_String_String(&n, String(" is a number"));
+    println(&n);
+    drop(n);
+
+    if_let_Some(part, get_slice_of_String(&a, range(5, 8))) {
+        print_debug_strslice(&part);
+        printf("\n");
+    } else_None {
+        abort();
+    }
+    // Not at a character boundary
+    assert(!get_slice_of_String(&a, range(5, 6)).is_some);
+    drop(a);
+
+    check_lengths();
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
@@ -0,0 +1,83 @@
+#include <cj50.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+// What the worker found out about itself.
+typedef struct WorkerInfo {
+    size_t pinned_cpu;
+    char name[16];
+    int niceness;
+    size_t num_allowed_cpus;
+    double cpu_time;
+    u64 result;
+} WorkerInfo;
+
+void* work(void *arg) {
+    WorkerInfo *info = arg;
+    prctl(PR_GET_NAME, info->name, 0, 0, 0);
+    info->niceness = getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+    CpuSet allowed = new_CpuSet();
+    syscall(SYS_sched_getaffinity, 0, sizeof(allowed.bits), allowed.bits);
+    info->num_allowed_cpus = 0;
+    for (size_t i = 0; i < CPUSET_MAX_CPUS; i++) {
+        if (contains_CpuSet(&allowed, i)) {
+            info->num_allowed_cpus++;
+            assert(i == info->pinned_cpu);
+        }
+    }
+    // Burn some CPU time
+    u64 x = 1;
+    for (u64 i = 0; i < 10000000; i++) {
+        x = x * 6364136223846793005ULL + i;
+    }
+    info->result = x;
+    info->cpu_time = current_thread_cpu_time();
+    return NULL;
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    unsigned cpu = 0;
+    syscall(SYS_getcpu, &cpu, NULL, NULL);
+
+    ThreadOptions options = new_ThreadOptions();
+    options.stack_size = 1024 * 1024;
+    add_CpuSet(&options.affinity, cpu);
+    // Raising the nice value (lowering the priority) is always
+    // allowed, lowering it is not.
+    int niceness = MIN(getpriority(PRIO_PROCESS, 0) + 1, 19);
+    options.niceness = some_int(niceness);
+
+    WorkerInfo info = { .pinned_cpu = cpu };
+    Thread t = unwrap_Result_Thread__SystemError(
+        spawn_thread_with_options(work, &info,
+                                  String("worker-with-a-long-name"),
+                                  &options));
+    double t_cpu = unwrap_Result_double__SystemError(thread_cpu_time(&t));
+    assert(t_cpu >= 0.);
+    unwrap_Result_ref_void__SystemError(join_Thread(t));
+
+    printf("name: %s\n", info.name);
+    printf("niceness as requested: %s\n",
+           info.niceness == niceness ? "yes" : "no");
+    printf("allowed CPUs: %zu\n", info.num_allowed_cpus);
+    printf("used CPU time: %s\n", info.cpu_time > 0. ? "yes" : "no");
+
+    // A stack this small is refused
+    options = new_ThreadOptions();
+    options.stack_size = 1;
+    Result(Thread, SystemError) r =
+        spawn_thread_with_options(work, &info, String("tiny"), &options);
+    assert(!r.is_ok);
+    print_debug_SystemError(&r.err);
+    printf("\n");
+    drop_Result_Thread__SystemError(r);
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
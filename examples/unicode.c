@@ -30,6 +30,10 @@ Result(Unit, UnicodeError) run(slice(cstr) argv) {
     AUTO v2 = TRY(new_Vec_utf8char_from_cstr(str), cleanup2);
     DBG(&v2);
 
+    AUTO s = new_slice_char(str, strlen(str));
+    size_t n = TRY(ucodepoint_count_slice_char(s), cleanup3);
+    DBG(n);
+
     while_let_Some(c, pop(&v2)) {
         println(c);
     }
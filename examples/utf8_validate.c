@@ -0,0 +1,114 @@
+#include <cj50.h>
+#include <cj50/instantiations/Result_Unit__UnicodeError.h>
+
+// Invalid byte sequences, each of which must be reported at the
+// position where it starts.
+typedef struct BadCase {
+    cstr name;
+    const char *bytes;
+    size_t len;
+    bool at_end; // only invalid at the end of the buffer
+} BadCase;
+
+#define BAD(name, bytes, at_end) { name, bytes, sizeof(bytes) - 1, at_end }
+
+const BadCase bad_cases[] = {
+    BAD("overlong 2-byte", "\xC0\x80", false),
+    BAD("overlong 3-byte", "\xE0\x80\xAF", false),
+    BAD("overlong 4-byte", "\xF0\x8F\xBF\xBF", false),
+    BAD("surrogate U+D800", "\xED\xA0\x80", false),
+    BAD("surrogate U+DFFF", "\xED\xBF\xBF", false),
+    BAD("above U+10FFFF", "\xF4\x90\x80\x80", false),
+    BAD("invalid start byte F5", "\xF5\x80\x80\x80", false),
+    BAD("stray continuation byte", "\x80", false),
+    BAD("stray continuation bytes", "\xBF\xBF", false),
+    BAD("truncated 2-byte", "\xC3", true),
+    BAD("truncated 3-byte", "\xE2\x82", true),
+    BAD("truncated 4-byte", "\xF0\x9F\x98", true),
+};
+
+// Valid text put before the invalid sequences: the lengths make the
+// sequences start at, straddle, or follow 16 and 32 byte boundaries,
+// and the non-ASCII prefixes keep the SIMD paths from skipping
+// blocks as plain ASCII.
+const char *prefixes[] = {
+    "",
+    "ok ",
+    "0123456789abcde",                          // 15 bytes
+    "0123456789abcdef0123456789abcd",           // 30 bytes
+    "0123456789abcdef0123456789abcdef01234567", // 40 bytes
+    "Grüße, → € 😀 Grüße, → € 😀 Grüße,",       // 52 bytes
+    "Grüße, → € 😀 Grüße, → € 😀 Grüße, → € 😀 Grüße, → € 😀", // 87 bytes
+};
+
+// Check `buf` with every implementation available on this machine,
+// they must all agree.
+size_t valid_up_to_all(const char *buf, size_t len) {
+    const u8 *s = (const u8 *)buf;
+    size_t pos = _utf8_valid_up_to_portable(s, len);
+#if CJ50_UTF8_VALIDATE_X86
+    assert(_utf8_valid_up_to_sse2(s, len) == pos);
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        assert(_utf8_valid_up_to_avx2(s, len) == pos);
+    }
+#endif
+    assert(utf8_valid_up_to(buf, len) == pos);
+    return pos;
+}
+
+int main() {
+    char buf[200];
+    for (size_t c = 0; c < sizeof(bad_cases) / sizeof(bad_cases[0]); c++) {
+        const BadCase *bad = &bad_cases[c];
+        printf("%s:\n", bad->name);
+        bool all_ok = true;
+        UnicodeError first_err;
+        for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+            size_t prefixlen = strlen(prefixes[p]);
+            // Valid text after the invalid sequence, long enough to
+            // fill further SIMD blocks
+            cstr suffix = bad->at_end ? "" : " and more text after that, é!";
+            size_t len = 0;
+            memcpy(&buf[len], prefixes[p], prefixlen);
+            len += prefixlen;
+            memcpy(&buf[len], bad->bytes, bad->len);
+            len += bad->len;
+            memcpy(&buf[len], suffix, strlen(suffix));
+            len += strlen(suffix);
+
+            size_t pos = valid_up_to_all(buf, len);
+            if (pos != prefixlen) {
+                printf("  FAIL: after %zu bytes: valid up to %zu\n",
+                       prefixlen, pos);
+                all_ok = false;
+                continue;
+            }
+            AUTO r = validate_utf8_slice_char(new_slice_char(buf, len));
+            assert(! r.is_ok);
+            if (p == 0) {
+                first_err = r.err;
+                printf("  ");
+                fprintln_UnicodeError(stdout, &r.err);
+            } else if (! equal_UnicodeError(&r.err, &first_err)) {
+                printf("  FAIL: after %zu bytes: different error\n",
+                       prefixlen);
+                all_ok = false;
+            }
+        }
+        if (all_ok) {
+            printf("  reported at the start of the sequence after all prefixes\n");
+        }
+    }
+
+    // Valid input, including the largest codepoint and the ones just
+    // around the surrogates
+    const char valid[] =
+        "0123456789abcdef0123456789abcd\xED\x9F\xBF\xEE\x80\x80"
+        "\xF4\x8F\xBF\xBF Grüße, → € 😀";
+    size_t len = sizeof(valid) - 1;
+    AUTO r = validate_utf8_slice_char(new_slice_char(valid, len));
+    printf("valid input: %s\n",
+           (valid_up_to_all(valid, len) == len) && r.is_ok ? "ok" : "FAIL");
+    drop_Result_Unit__UnicodeError(r);
+}
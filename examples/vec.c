@@ -22,5 +22,26 @@ int main(int argc, char** argv) {
         }
         drop(vec);
         DBG(vec3);
+
+        Vec(CStr) vec4 = new_Vec_CStr();
+        for (int i = 0; i < argc; i++) {
+            push(&vec4, CStr_from_cstr_unsafe(xstrdup(argv[i])));
+        }
+        truncate_Vec_CStr(&vec4, 2);
+        DBG(vec4);
     }
+
+    Vec(int) nums = new_Vec_int();
+    DEF_SLICE(int, some_nums, { 1, 2, 3 });
+    extend_from_slice(&nums, some_nums);
+    DEF_SLICE(int, more_nums, { 4, 5 });
+    extend_from_slice(&nums, more_nums);
+    DBG(&nums);
+    reserve(&nums, 100);
+    DBG(nums.cap >= 105);
+    shrink_to_fit_Vec_int(&nums);
+    DBG(nums.cap == nums.len);
+    truncate_Vec_int(&nums, 2);
+    DBG(&nums);
+    drop(nums);
 }
@@ -0,0 +1,126 @@
+#include <cj50.h>
+#include <cj50/instantiations/VecDeque_int.h>
+
+#define T Vec2(int)
+#include <cj50/gen/template/VecDeque.h>
+#undef T
+
+// The number of steps from the top left to the bottom right corner
+// of the maze, via breadth first search, or -1 if unreachable.
+int shortest_path(slice(cstr) maze) {
+    int height = maze.len;
+    int width = strlen(maze.ptr[0]);
+    Vec(int) dist = new_Vec_int();
+    for (int i = 0; i < width * height; i++) {
+        push(&dist, -1);
+    }
+    VecDeque(Vec2(int)) queue = new_VecDeque_Vec2_int();
+    push_back_VecDeque_Vec2_int(&queue, vec2_int(0, 0));
+    dist.ptr[0] = 0;
+    while_let_Some(p, pop_front_VecDeque_Vec2_int(&queue)) {
+        const Vec2(int) dirs[] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        for (int d = 0; d < 4; d++) {
+            Vec2(int) q = add(p, dirs[d]);
+            if ((q.x >= 0) && (q.x < width) && (q.y >= 0) && (q.y < height)
+                && (maze.ptr[q.y][q.x] == '.')
+                && (dist.ptr[q.x + q.y * width] < 0)) {
+                dist.ptr[q.x + q.y * width] = dist.ptr[p.x + p.y * width] + 1;
+                push_back_VecDeque_Vec2_int(&queue, q);
+            }
+        }
+    }
+    int result = dist.ptr[width * height - 1];
+    drop_VecDeque_Vec2_int(queue);
+    drop(dist);
+    return result;
+}
+
+// Compare against a plain array, with the queue at an offset in it.
+void check_against_array() {
+    enum { N = 100000 };
+    static int model[2 * N];
+    size_t start = N, end = N;
+    VecDeque(int) q = new_VecDeque_int();
+    u64 x = 1;
+    for (int round = 0; round < N; round++) {
+        x = x * 6364136223846793005 + 1442695040888963407;
+        switch ((x >> 33) % 5) {
+        case 0:
+        case 1:
+            push_back_VecDeque_int(&q, round);
+            model[end++] = round;
+            break;
+        case 2:
+            push_front_VecDeque_int(&q, round);
+            model[--start] = round;
+            break;
+        case 3: {
+            Option(int) v = pop_front_VecDeque_int(&q);
+            assert(v.is_some == (start < end));
+            if (v.is_some) {
+                assert(v.value == model[start++]);
+            }
+            break;
+        }
+        case 4: {
+            Option(int) v = pop_back_VecDeque_int(&q);
+            assert(v.is_some == (start < end));
+            if (v.is_some) {
+                assert(v.value == model[--end]);
+            }
+            break;
+        }
+        }
+    }
+    assert(len_VecDeque_int(&q) == end - start);
+    VecDequeSlices(int) s = as_slices_VecDeque_int(&q);
+    assert(s.front.len + s.back.len == end - start);
+    for (size_t i = 0; i < s.front.len; i++) {
+        assert(s.front.ptr[i] == model[start + i]);
+    }
+    for (size_t i = 0; i < s.back.len; i++) {
+        assert(s.back.ptr[i] == model[start + s.front.len + i]);
+    }
+    printf("%zu elements, as expected\n", end - start);
+    drop_VecDeque_int(q);
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+
+    VecDeque(int) q = with_capacity_VecDeque_int(8);
+    for (int i = 0; i < 6; i++) {
+        push_back_VecDeque_int(&q, i);
+    }
+    for (int i = 0; i < 4; i++) {
+        drop(pop_front_VecDeque_int(&q));
+    }
+    for (int i = 6; i < 10; i++) {
+        push_back_VecDeque_int(&q, i);
+    }
+    push_front_VecDeque_int(&q, 3);
+    print_debug_VecDeque_int(&q);
+    printf("\n");
+    VecDequeSlices(int) s = as_slices_VecDeque_int(&q);
+    DBG(&s.front);
+    DBG(&s.back);
+    DBG(*unwrap_Option_ref_int(back_VecDeque_int(&q)));
+    drop_VecDeque_int(q);
+
+    DEF_SLICE(cstr, maze, {
+            "..#.....",
+            "#.#.###.",
+            "..#...#.",
+            ".####.#.",
+            "......#.",
+        });
+    DBG(shortest_path(maze));
+
+    check_against_array();
+
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);
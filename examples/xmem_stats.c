@@ -0,0 +1,67 @@
+#include <cj50.h>
+#include <cj50/instantiations/HashMap_String__int.h>
+
+// Build a vector by pushing one item at a time.
+Vec(int) squares(int n) {
+    Vec(int) v = new_Vec_int();
+    for (int i = 0; i < n; i++) {
+        push(&v, i * i);
+    }
+    return v;
+}
+
+// The same, but reserving the needed capacity first.
+Vec(int) squares_reserved(int n) {
+    Vec(int) v = with_capacity_Vec_int(n);
+    for (int i = 0; i < n; i++) {
+        push(&v, i * i);
+    }
+    return v;
+}
+
+void print_stats(cstr what, XmemStats before) {
+    XmemStats s = get_xmem_stats();
+    printf("%s: %zu allocs, %zu reallocs, %zu frees, %zu bytes,"
+           " %zu live\n",
+           what, s.allocs - before.allocs, s.reallocs - before.reallocs,
+           s.frees - before.frees, s.bytes - before.bytes, s.live_bytes);
+}
+
+Result(Unit, String) run(UNUSED slice(cstr) argv) {
+    BEGIN_Result(Unit, String);
+    // Normally enabled via the CJ50_XMEM_STATS environment variable,
+    // which also prints a report at exit
+    enable_xmem_stats(false);
+
+    XmemStats s0 = get_xmem_stats();
+    Vec(int) a = squares(1000);
+    print_stats("push 1000", s0);
+
+    XmemStats s1 = get_xmem_stats();
+    Vec(int) b = squares_reserved(1000);
+    print_stats("reserve + push 1000", s1);
+
+    XmemStats s2 = get_xmem_stats();
+    drop(b);
+    drop(a);
+    print_stats("drop both", s2);
+
+    XmemStats s3 = get_xmem_stats();
+    HashMap(String, int) m = new_HashMap_String__int();
+    for (int i = 0; i < 100; i++) {
+        String k = new_String();
+        push_String(&k, 'a' + i % 26);
+        push_String(&k, 'a' + i / 26);
+        drop_Option_int(insert_HashMap_String__int(&m, k, i));
+    }
+    drop_HashMap_String__int(m);
+    print_stats("HashMap with 100 String keys", s3);
+
+    XmemStats s = get_xmem_stats();
+    printf("peak live: %zu bytes\n", s.peak_live_bytes);
+    RETURN_Ok(Unit(), cleanup1);
+cleanup1:
+    END_Result();
+}
+
+MAIN(run);